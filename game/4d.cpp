@@ -134,6 +134,16 @@ f32 sphereAngularDistance(Vec4 v0, Vec4 v1) {
 	return acos(std::clamp(dot(v0, v1), -1.0f, 1.0f));
 }
 
+Vec4 sphereSlerp(Vec4 a, Vec4 b, f32 t) {
+	const auto angle = sphereAngularDistance(a, b);
+	const auto sinAngle = sin(angle);
+	// For close points the weights below divide 2 small numbers. The geodesic is almost a straight line there anyway.
+	if (sinAngle < 0.0001f) {
+		return ((1.0f - t) * a + t * b).normalized();
+	}
+	return (sin((1.0f - t) * angle) / sinAngle) * a + (sin(t * angle) / sinAngle) * b;
+}
+
 std::array<Vec4, 3> orthonormalBasisFor3PlaneContainingTriangle(Vec4 v0, Vec4 v1, Vec4 v2) {
 	std::array<Vec4, 3> basis{ v0, v1, v2 };
 	gramSchmidtOrthonormalize(View<Vec4>(basis.data(), basis.size()));
@@ -16,5 +16,7 @@ f32 parallelogramArea(Vec4 v0, Vec4 v1);
 f32 parallelepipedArea(Vec4 v0, Vec4 v1, Vec4 v2);
 f32 distanceFromPlaneToPoint(Vec4 planePoint, Vec4 planeSpanning0, Vec4 planeSpanning1, Vec4 point);
 f32 sphereAngularDistance(Vec4 v0, Vec4 v1);
+// Moves along the geodesic from a to b by the fraction t of its length. The points have to be on the unit sphere and can't be antipodal.
+Vec4 sphereSlerp(Vec4 a, Vec4 b, f32 t);
 
 std::array<Vec4, 3> orthonormalBasisFor3SpaceContainingTriangle(Vec4 v0, Vec4 v1, Vec4 v2);
\ No newline at end of file
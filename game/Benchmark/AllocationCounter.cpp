@@ -0,0 +1,46 @@
+#include "AllocationCounter.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<i64> allocationCount = 0;
+static std::atomic<i64> allocatedBytes = 0;
+
+// Only the unaligned versions are replaced. The aligned ones aren't used by the measured code.
+void* operator new(std::size_t size) {
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(i64(size), std::memory_order_relaxed);
+	// malloc(0) may return nullptr.
+	if (const auto result = std::malloc(size == 0 ? 1 : size)) {
+		return result;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+	std::free(ptr);
+}
+
+i64 AllocationCounter::count() {
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+i64 AllocationCounter::bytes() {
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope()
+	: startCount(AllocationCounter::count())
+	, startBytes(AllocationCounter::bytes()) {}
+
+i64 AllocationScope::count() const {
+	return AllocationCounter::count() - startCount;
+}
+
+i64 AllocationScope::bytes() const {
+	return AllocationCounter::bytes() - startBytes;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <Types.hpp>
+
+// Counts the calls to the global operator new in the benchmark executable. The counter is global so it also counts the allocations made by other threads.
+struct AllocationCounter {
+	static i64 count();
+	static i64 bytes();
+};
+
+// Allocations made between the construction and reading the counts.
+struct AllocationScope {
+	AllocationScope();
+	i64 count() const;
+	i64 bytes() const;
+
+	i64 startCount;
+	i64 startBytes;
+};
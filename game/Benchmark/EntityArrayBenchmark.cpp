@@ -0,0 +1,122 @@
+#include "EntityArrayBenchmark.hpp"
+#include <game/EntityArray.hpp>
+#include <engine/Math/Vec4.hpp>
+#include <Put.hpp>
+#include <game/Clock.hpp>
+#include <random>
+
+namespace {
+
+struct BenchmarkEntity {
+	Vec4 position = Vec4(0.0f);
+	Vec4 velocity = Vec4(0.0f);
+	f32 value = 0.0f;
+};
+
+struct BenchmarkEntityDefaultInitialize {
+	BenchmarkEntity operator()() {
+		return BenchmarkEntity();
+	}
+};
+
+using Id = EntityArrayId<BenchmarkEntity>;
+
+struct Result {
+	f64 churnMs = 0.0;
+	f64 iterationMs = 0.0;
+	f64 lookupMs = 0.0;
+	// Printed so the loops aren't optimized out and so the containers can be checked to visit the same entities.
+	f64 checksum = 0.0;
+};
+
+}
+
+template<typename Array>
+static Result run(i32 peakCount, i32 aliveCount, i32 churnPerFrame, i32 frameCount, i32 lookupCount) {
+	Array array;
+	std::mt19937 rng(0);
+	std::vector<Id> aliveIds;
+
+	auto destroyRandom = [&](i32 count) {
+		for (i32 i = 0; i < count; i++) {
+			const auto index = std::uniform_int_distribution<i32>(0, i32(aliveIds.size()) - 1)(rng);
+			array.destroy(aliveIds[index]);
+			aliveIds[index] = aliveIds.back();
+			aliveIds.pop_back();
+		}
+	};
+	auto createCount = [&](i32 count) {
+		for (i32 i = 0; i < count; i++) {
+			auto entity = array.create();
+			entity->value = f32(aliveIds.size() % 7);
+			aliveIds.push_back(entity.id);
+		}
+	};
+
+	// Reaching the peak and then dropping to the alive count, which leaves the EntityArray with mostly free indices.
+	createCount(peakCount);
+	array.update();
+	destroyRandom(peakCount - aliveCount);
+	array.update();
+
+	Result result;
+	for (i32 frame = 0; frame < frameCount; frame++) {
+		auto start = Clock::now();
+		destroyRandom(churnPerFrame);
+		createCount(churnPerFrame);
+		array.update();
+		result.churnMs += millisecondsSince(start);
+
+		start = Clock::now();
+		f32 sum = 0.0f;
+		for (auto entity : array) {
+			entity->position += entity->velocity;
+			sum += entity->value;
+		}
+		result.iterationMs += millisecondsSince(start);
+		result.checksum += sum;
+
+		start = Clock::now();
+		f32 lookupSum = 0.0f;
+		for (i32 i = 0; i < lookupCount; i++) {
+			const auto& id = aliveIds[(i * 7919) % aliveIds.size()];
+			const auto entity = array.get(id);
+			if (entity.has_value()) {
+				lookupSum += entity->value;
+			}
+		}
+		result.lookupMs += millisecondsSince(start);
+		result.checksum += lookupSum;
+	}
+	result.churnMs /= f64(frameCount);
+	result.iterationMs /= f64(frameCount);
+	result.lookupMs /= f64(frameCount);
+	return result;
+}
+
+bool entityArrayBenchmark() {
+	const i32 peakCount = 200000;
+	const i32 frameCount = 100;
+	const i32 lookupCount = 100000;
+	const i32 aliveCounts[]{ 200000, 20000, 2000 };
+	for (const auto aliveCount : aliveCounts) {
+		const auto churnPerFrame = aliveCount / 10;
+		const auto sparse = run<EntityArray<BenchmarkEntity, BenchmarkEntityDefaultInitialize>>(peakCount, aliveCount, churnPerFrame, frameCount, lookupCount);
+		const auto dense = run<DenseEntityArray<BenchmarkEntity, BenchmarkEntityDefaultInitialize>>(peakCount, aliveCount, churnPerFrame, frameCount, lookupCount);
+		auto print = [&](const char* name, const Result& result) {
+			put("% of % alive, % churn per frame, %: churn % ms, iteration % ms, % lookups % ms per frame, checksum %",
+				aliveCount,
+				peakCount,
+				churnPerFrame,
+				name,
+				result.churnMs,
+				result.iterationMs,
+				lookupCount,
+				result.lookupMs,
+				result.checksum);
+		};
+		print("EntityArray", sparse);
+		print("DenseEntityArray", dense);
+	}
+	return true;
+}
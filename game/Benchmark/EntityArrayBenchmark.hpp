@@ -0,0 +1,4 @@
+#pragma once
+
+// Compares EntityArray against DenseEntityArray after the number of alive entities drops far below the peak and with many entities created and destroyed each frame. Measures the churn, the iteration and the lookups by id.
+bool entityArrayBenchmark();
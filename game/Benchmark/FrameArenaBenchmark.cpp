@@ -0,0 +1,124 @@
+#include "FrameArenaBenchmark.hpp"
+#include <game/FrameArena.hpp>
+#include <game/Benchmark/AllocationCounter.hpp>
+#include <Put.hpp>
+#include <game/Clock.hpp>
+#include <random>
+#include <algorithm>
+#include <sstream>
+
+namespace {
+
+struct FrameInput {
+	std::vector<i32> visibleCells;
+	std::vector<f32> depths;
+	std::vector<i32> counts;
+};
+
+struct Result {
+	f64 ms = 0.0;
+	i64 heapAllocations = 0;
+	// Printed so the work isn't optimized out and so the versions can be compared.
+	u64 checksum = 0;
+};
+
+}
+
+// What Minesweeper::update did before. Sorts the visible cells by depth, converts the counts to strings and formats the text in the corner of the screen.
+static u64 frameWithStandardContainers(const FrameInput& input) {
+	u64 checksum = 0;
+	std::vector<i32> sorted(input.visibleCells.begin(), input.visibleCells.end());
+	std::ranges::sort(sorted, [&](i32 a, i32 b) { return input.depths[a] > input.depths[b]; });
+	for (const auto& cell : sorted) {
+		if (input.counts[cell] >= 1) {
+			const auto text = std::to_string(input.counts[cell]);
+			checksum = checksum * 31 + text.size() + u64(text[0]);
+		}
+	}
+	std::stringstream s;
+	put(s, "bombs: %\nmarked: %\nrevealed: %/%", 100, 10, sorted.size(), input.counts.size());
+	checksum += s.str().size();
+	return checksum;
+}
+
+static u64 frameWithArena(const FrameInput& input, FrameArena& arena) {
+	u64 checksum = 0;
+	FrameVector<i32> sorted(input.visibleCells.begin(), input.visibleCells.end(), arena);
+	std::ranges::sort(sorted, [&](i32 a, i32 b) { return input.depths[a] > input.depths[b]; });
+	for (const auto& cell : sorted) {
+		if (input.counts[cell] >= 1) {
+			const auto text = intToString(arena, input.counts[cell]);
+			checksum = checksum * 31 + text.size() + u64(text[0]);
+		}
+	}
+	FrameString text(arena);
+	auto append = [&](const char* label, i64 value) {
+		text += label;
+		text += intToString(arena, value);
+	};
+	append("bombs: ", 100);
+	append("\nmarked: ", 10);
+	append("\nrevealed: ", sorted.size());
+	append("/", input.counts.size());
+	checksum += text.size();
+	return checksum;
+}
+
+bool frameArenaBenchmark() {
+	const i32 visibleCellCounts[]{ 720, 3000 };
+	const i32 frameCount = 1000;
+	// The first frames grow the arena.
+	const i32 warmUpFrameCount = 10;
+	bool allMatch = true;
+
+	for (const auto& visibleCellCount : visibleCellCounts) {
+		std::mt19937 rng(0);
+		std::uniform_real_distribution<f32> depth(0.0f, 10.0f);
+		// The numbers drawn in the revealed cells. Zero isn't drawn.
+		std::uniform_int_distribution<i32> count(0, 30);
+		FrameInput input;
+		for (i32 i = 0; i < visibleCellCount; i++) {
+			input.visibleCells.push_back(i);
+			input.depths.push_back(depth(rng));
+			input.counts.push_back(count(rng));
+		}
+
+		auto measure = [&](auto frame) {
+			Result result;
+			for (i32 i = 0; i < frameCount; i++) {
+				const AllocationScope allocations;
+				const auto start = Clock::now();
+				result.checksum += frame();
+				if (i >= warmUpFrameCount) {
+					result.ms += millisecondsSince(start);
+					result.heapAllocations += allocations.count();
+				}
+			}
+			result.ms /= frameCount - warmUpFrameCount;
+			return result;
+		};
+
+		const auto standard = measure([&] {
+			return frameWithStandardContainers(input);
+		});
+		FrameArena arena(1024);
+		const auto arenaResult = measure([&] {
+			arena.reset();
+			return frameWithArena(input, arena);
+		});
+
+		const auto matches = standard.checksum == arenaResult.checksum;
+		allMatch = allMatch && matches;
+		put("% visible cells: standard % ms, % heap allocations per frame; arena % ms, % heap allocations after % frames, % bytes per frame, % arena blocks allocated, %",
+			visibleCellCount,
+			standard.ms,
+			f64(standard.heapAllocations) / (frameCount - warmUpFrameCount),
+			arenaResult.ms,
+			arenaResult.heapAllocations,
+			warmUpFrameCount,
+			arena.lastFrameAllocatedBytes,
+			arena.heapAllocationCount,
+			matches ? "matches" : "MISMATCH");
+	}
+	return allMatch;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Runs the per frame work of Minesweeper::update that used to allocate, using the standard containers and using the frame arena. Checks that the arena version doesn't allocate from the heap once it has grown to the size of a frame.
+bool frameArenaBenchmark();
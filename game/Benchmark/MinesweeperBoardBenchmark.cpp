@@ -0,0 +1,234 @@
+#include "MinesweeperBoardBenchmark.hpp"
+#include <game/MinesweeperBoard.hpp>
+#include <game/TilingCache.hpp>
+#include <Put.hpp>
+#include <game/Clock.hpp>
+#include <random>
+#include <algorithm>
+
+namespace {
+
+// The state of Minesweeper before it used MinesweeperBoard.
+struct VectorsBoard {
+	std::vector<std::vector<CellIndex>> cellToNeighbours;
+	std::vector<bool> isBomb;
+	std::vector<i32> neighbouringBombsCount;
+	std::vector<bool> isRevealed;
+
+	void placeBombs(const std::vector<CellIndex>& bombs) {
+		for (const auto& cell : bombs) {
+			isBomb[cell] = true;
+		}
+		for (CellIndex i = 0; i < i32(isBomb.size()); i++) {
+			auto& count = neighbouringBombsCount[i];
+			count = 0;
+			for (const auto& neighbour : cellToNeighbours[i]) {
+				if (isBomb[neighbour]) {
+					count++;
+				}
+			}
+		}
+	}
+
+	void reveal(CellIndex cell) {
+		std::vector<i32> toVisit;
+		toVisit.push_back(cell);
+		while (toVisit.size() > 0) {
+			const auto c = toVisit.back();
+			toVisit.pop_back();
+			isRevealed[c] = true;
+			if (neighbouringBombsCount[c] == 0) {
+				for (const auto& neighbour : cellToNeighbours[c]) {
+					if (isRevealed[neighbour] || isBomb[neighbour]) {
+						continue;
+					}
+					toVisit.push_back(neighbour);
+				}
+			}
+		}
+	}
+};
+
+// The counters shown in the HUD and used to detect winning have to be the same as counting the cells.
+bool countersMatchRecount(const MinesweeperBoard& board) {
+	i32 bombCount = 0;
+	i32 revealedCount = 0;
+	i32 markedCount = 0;
+	i32 hiddenNonBombCount = 0;
+	for (CellIndex cell = 0; cell < board.cellCount(); cell++) {
+		bombCount += board.isBomb(cell);
+		revealedCount += board.isRevealed(cell);
+		markedCount += board.isMarked(cell);
+		hiddenNonBombCount += !board.isBomb(cell) && !board.isRevealed(cell);
+	}
+	return bombCount == board.bombCount &&
+		revealedCount == board.revealedCount &&
+		markedCount == board.markedCount &&
+		hiddenNonBombCount == board.hiddenNonBombCount;
+}
+
+/*
+Plays 2 games the way Minesweeper does. startGame places the bombs around the first cell and reveals it, which cascades. Then some cells are marked and unmarked, some of them next to a cell revealed afterwards, so a cascade also reveals marked cells. Then a bomb is revealed, which is gameOver revealing everything. initialize clears the board before the second game. The counters are compared against counting the cells after every step.
+*/
+bool countersMatchAfterGames(const CellAdjacency& adjacency) {
+	// The same as Minesweeper::defaultBombCount.
+	const auto bombCount = i32(floor(adjacency.cellCount() * 0.15f));
+	std::mt19937 rng(1);
+	MinesweeperBoard board;
+	board.initialize(adjacency);
+	bool matches = countersMatchRecount(board);
+	for (i32 game = 0; game < 2; game++) {
+		board.clear();
+		matches = matches && countersMatchRecount(board);
+
+		// startGame with FIRST_MOVE_EMPTY_CELL.
+		const auto firstCell = CellIndex(rng() % u32(adjacency.cellCount()));
+		std::vector<CellIndex> possibleBombLocations;
+		for (CellIndex cell = 0; cell < adjacency.cellCount(); cell++) {
+			if (cell != firstCell && !std::ranges::binary_search(adjacency[firstCell], cell)) {
+				possibleBombLocations.push_back(cell);
+			}
+		}
+		std::vector<CellIndex> bombs;
+		std::sample(possibleBombLocations.begin(), possibleBombLocations.end(), std::back_inserter(bombs), bombCount, rng);
+		board.placeBombs(constView(bombs));
+		matches = matches && countersMatchRecount(board);
+		board.reveal(firstCell);
+		matches = matches && countersMatchRecount(board) && board.revealedCount > 1;
+
+		// Marking hidden cells, unmarking every other one and then revealing the hidden cells without bombs next to them.
+		std::vector<CellIndex> hiddenCells;
+		for (CellIndex cell = 0; cell < board.cellCount(); cell++) {
+			if (!board.isRevealed(cell)) {
+				hiddenCells.push_back(cell);
+			}
+		}
+		std::vector<CellIndex> markedCells;
+		std::sample(hiddenCells.begin(), hiddenCells.end(), std::back_inserter(markedCells), std::min(i32(hiddenCells.size()), 20), rng);
+		for (const auto& cell : markedCells) {
+			board.toggleMarked(cell);
+			matches = matches && countersMatchRecount(board);
+		}
+		for (i32 i = 0; i < i32(markedCells.size()); i += 2) {
+			board.toggleMarked(markedCells[i]);
+			matches = matches && countersMatchRecount(board);
+		}
+		for (const auto& cell : markedCells) {
+			for (const auto& neighbour : adjacency[cell]) {
+				// The same checks as Minesweeper::reveal.
+				if (!board.isRevealed(neighbour) && !board.isBomb(neighbour)) {
+					board.reveal(neighbour);
+					matches = matches && countersMatchRecount(board);
+				}
+			}
+		}
+
+		// Minesweeper::reveal on a bomb calls gameOver.
+		if (!bombs.empty()) {
+			board.revealAll();
+			matches = matches && countersMatchRecount(board) && board.hiddenNonBombCount == 0;
+		}
+	}
+	return matches;
+}
+
+}
+
+bool minesweeperRevealBenchmark() {
+	struct Board {
+		const char* name;
+		i32 divisionCount;
+	};
+	// The subdivided hypercube with n divisions has 8 (n + 1)^3 cells.
+	const Board boards[]{
+		{ "subdivided hypercube 2", 2 },
+		{ "subdivided hypercube 10", 10 },
+		{ "subdivided hypercube 22", 22 },
+	};
+	// With no bombs the first reveal cascades through the whole board, which is the worst case. With a few bombs the cascade stops at the cells next to them.
+	const f32 bombDensities[]{ 0.0f, 0.01f };
+	const i32 repetitions = 5;
+	TilingCache cache;
+	bool allMatch = true;
+
+	for (const auto& board : boards) {
+		const auto loaded = cache.get(TilingCache::key("subdiviedHypercube4", board.divisionCount), [&] {
+			return subdiviedHypercube4(board.divisionCount);
+		});
+		const auto& adjacency = loaded.cellsSharingVertex;
+		const auto cellCount = adjacency.cellCount();
+
+		for (const auto& density : bombDensities) {
+			std::mt19937 rng(0);
+			std::vector<CellIndex> cells(cellCount);
+			for (CellIndex i = 0; i < cellCount; i++) {
+				cells[i] = i;
+			}
+			std::vector<CellIndex> bombs;
+			std::sample(cells.begin(), cells.end(), std::back_inserter(bombs), i32(density * cellCount), rng);
+			std::vector<bool> isBomb(cellCount, false);
+			for (const auto& bomb : bombs) {
+				isBomb[bomb] = true;
+			}
+			// The first cell without a bomb or a neighbouring bomb.
+			CellIndex start = 0;
+			while (isBomb[start] || std::ranges::any_of(adjacency[start], [&](CellIndex n) { return isBomb[n]; })) {
+				start++;
+			}
+
+			f64 vectorsMs = 0.0;
+			VectorsBoard vectors;
+			for (i32 i = 0; i < repetitions; i++) {
+				vectors = VectorsBoard();
+				vectors.cellToNeighbours.resize(cellCount);
+				for (CellIndex cell = 0; cell < cellCount; cell++) {
+					vectors.cellToNeighbours[cell].assign(adjacency[cell].begin(), adjacency[cell].end());
+				}
+				vectors.isBomb.resize(cellCount, false);
+				vectors.neighbouringBombsCount.resize(cellCount, 0);
+				vectors.isRevealed.resize(cellCount, false);
+				vectors.placeBombs(bombs);
+
+				const auto startTime = Clock::now();
+				vectors.reveal(start);
+				vectorsMs += millisecondsSince(startTime);
+			}
+
+			f64 packedMs = 0.0;
+			MinesweeperBoard packed;
+			packed.initialize(adjacency);
+			for (i32 i = 0; i < repetitions; i++) {
+				packed.clear();
+				packed.placeBombs(constView(bombs));
+
+				const auto startTime = Clock::now();
+				packed.reveal(start);
+				packedMs += millisecondsSince(startTime);
+			}
+
+			bool matches = true;
+			i32 revealedCount = 0;
+			for (CellIndex cell = 0; cell < cellCount; cell++) {
+				matches = matches &&
+					vectors.isRevealed[cell] == packed.isRevealed(cell) &&
+					vectors.neighbouringBombsCount[cell] == packed.neighbouringBombCount(cell);
+				revealedCount += vectors.isRevealed[cell];
+			}
+			matches = matches && revealedCount == packed.revealedCount && countersMatchRecount(packed);
+
+			allMatch = allMatch && matches;
+			put("%, % bombs: % cells revealed, vectors % ms, packed % ms, %",
+				board.name,
+				bombs.size(),
+				revealedCount,
+				vectorsMs / repetitions,
+				packedMs / repetitions,
+				matches ? "matches" : "MISMATCH");
+		}
+
+		const auto countersMatch = countersMatchAfterGames(adjacency);
+		allMatch = allMatch && countersMatch;
+		put("%: counters after playing 2 games %", board.name, countersMatch ? "match" : "MISMATCH");
+	}
+	return allMatch;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Reveals cascading through whole boards with up to 100k cells and compares MinesweeperBoard against the separate vectors and the stack based flood fill Minesweeper used before. Also plays games on each board and checks the revealed, marked and hidden counters against counting the cells.
+bool minesweeperRevealBenchmark();
@@ -0,0 +1,530 @@
+#include "PhysicsBenchmarks.hpp"
+#include <engine/Math/Angles.hpp>
+#include <game/4d.hpp>
+#include <game/Math.hpp>
+#include <thread>
+#include <algorithm>
+#include <Put.hpp>
+#include <game/Clock.hpp>
+
+Vec4 randomPointOnSphere(std::mt19937& rng) {
+	// The normal distribution is rotationally symmetric so normalizing gives a uniform distribution on the sphere.
+	std::normal_distribution<f32> normal(0.0f, 1.0f);
+	return Vec4(normal(rng), normal(rng), normal(rng), normal(rng)).normalized();
+}
+
+static f32 sphereRadiusFillingVolumeFraction(i32 count, f32 volumeFraction) {
+	// The volume of the unit 3-sphere is 2 pi^2. For small radii the volume of a ball on the sphere is approximately the euclidean one.
+	const auto sphereVolume = 2.0f * PI<f32> * PI<f32>;
+	const auto ballVolume = volumeFraction * sphereVolume / f32(count);
+	return cbrt(ballVolume / (4.0f / 3.0f * PI<f32>));
+}
+
+void addSeparatedRandomSpheres(World& world, i32 count, f32 volumeFraction, std::mt19937& rng) {
+	const auto radius = sphereRadiusFillingVolumeFraction(count, volumeFraction);
+	// The spheres overlap if the angle between their centers is less than 2 radius.
+	const auto maxCosAngle = cos(2.0f * radius);
+	std::vector<Vec4> positions;
+	while (i32(positions.size()) < count) {
+		const auto position = randomPointOnSphere(rng);
+		const auto overlaps = std::ranges::any_of(positions, [&](Vec4 other) {
+			return dot(position, other) > maxCosAngle;
+		});
+		if (!overlaps) {
+			positions.push_back(position);
+		}
+	}
+	for (const auto& position : positions) {
+		world.createSphere(position, radius, 1.0f);
+	}
+}
+
+void addTilingWalls(World& world, const Tiling& tiling) {
+	for (i32 faceI = 0; faceI < tiling.faceCount(); faceI++) {
+		const auto face = tiling.verticesOfFace(faceI);
+		const auto& v0 = tiling.vertices[face[0]];
+		for (i32 i = 1; i < i32(face.size()) - 1; i++) {
+			const auto& v1 = tiling.vertices[face[i]];
+			const auto& v2 = tiling.vertices[face[i + 1]];
+			const auto planeNormal = crossProduct(v0, v1, v2).normalized();
+			// The normal of the plane containing the edge and the plane normal, pointing towards the remaining vertex.
+			auto inwardEdgeNormal = [&](Vec4 a, Vec4 b, Vec4 opposite) {
+				auto normal = crossProduct(a, b, planeNormal).normalized();
+				if (dot(normal, opposite) < 0.0f) {
+					normal = -normal;
+				}
+				return normal;
+			};
+			world.createWall(v0, v1, v2,
+				inwardEdgeNormal(v2, v0, v1),
+				inwardEdgeNormal(v0, v1, v2),
+				inwardEdgeNormal(v1, v2, v0),
+				planeNormal);
+		}
+	}
+}
+
+bool broadPhaseBenchmark() {
+	const i32 bodyCounts[]{ 100, 1000, 10000 };
+	for (const auto bodyCount : bodyCounts) {
+		for (const auto allPairs : { true, false }) {
+			std::mt19937 rng(0);
+			World world(4);
+			world.useAllPairsBroadPhase = allPairs;
+			// Overlapping random positions blow up the scene and the time is then spent on the continuous collision of the fast bodies. The random velocities make the separated spheres collide.
+			addSeparatedRandomSpheres(world, bodyCount, 0.2f, rng);
+			std::uniform_real_distribution<f32> speed(0.0f, 0.5f);
+			for (auto body : world.bodies) {
+				const auto direction = projectVectorToSphereTangentSpace(body->position, randomPointOnSphere(rng)).normalized();
+				body->velocity = direction * speed(rng);
+			}
+			// The first step also makes the created bodies visible to the broad phase.
+			world.step(1.0f / 60.0f);
+
+			// The all pairs version is too slow to run many steps with 10k bodies.
+			const auto stepCount = allPairs && bodyCount >= 10000 ? 1 : 10;
+			const auto start = Clock::now();
+			for (i32 i = 0; i < stepCount; i++) {
+				world.step(1.0f / 60.0f);
+			}
+			const auto msPerStep = millisecondsSince(start) / f64(stepCount);
+
+			const auto candidatePairs = allPairs
+				? i64(bodyCount) * i64(bodyCount - 1) / 2
+				: i64(world.broadPhasePairs.size());
+			put("% bodies, %: % candidate pairs, % contacts, % ms per step",
+				bodyCount,
+				allPairs ? "all pairs" : "grid",
+				candidatePairs,
+				world.contactConstraints.size(),
+				msPerStep);
+		}
+	}
+	return true;
+}
+
+// The integration loops from World::step before the integration used BodyStates.
+static void integrateArrayOfStructures(std::vector<Body>& bodies, Vec4 gravity, f32 resistance, f32 dt) {
+	for (auto& b : bodies) {
+		b.velocity += dt * (gravity + b.invMass * b.force);
+		b.velocity *= resistance;
+		b.velocity = projectVectorToSphereTangentSpace(b.position, b.velocity);
+	}
+	for (auto& b : bodies) {
+		b.velocity = projectVectorToSphereTangentSpace(b.position, b.velocity);
+		const auto movement = movementForwardOnSphere(b.position, b.velocity * dt);
+		b.position = moveForwardOnSphere(b.position, b.velocity * dt);
+		b.velocity = movement * b.velocity;
+		b.force = Vec4(0.0f);
+	}
+}
+
+bool integrationBenchmark() {
+	const i32 bodyCount = 100000;
+	const i32 stepCount = 100;
+	const auto dt = 1.0f / 60.0f;
+	const auto gravity = Vec4(0.0f, -0.1f, 0.0f, 0.0f);
+	const auto resistance = 0.97f;
+
+	std::mt19937 rng(0);
+	std::vector<Body> bodies(bodyCount);
+	for (auto& body : bodies) {
+		body.set(0.01f, 1.0f);
+		body.position = randomPointOnSphere(rng);
+		body.velocity = projectVectorToSphereTangentSpace(body.position, randomPointOnSphere(rng));
+	}
+	std::vector<Body*> pointers;
+	for (auto& body : bodies) {
+		pointers.push_back(&body);
+	}
+	const auto referenceBodies = bodies;
+
+	{
+		auto aos = referenceBodies;
+		const auto start = Clock::now();
+		for (i32 i = 0; i < stepCount; i++) {
+			integrateArrayOfStructures(aos, gravity, resistance, dt);
+		}
+		put("array of structures: % ms per step", millisecondsSince(start) / f64(stepCount));
+	}
+
+	BodyStates states;
+	{
+		const auto start = Clock::now();
+		for (i32 i = 0; i < stepCount; i++) {
+			// Same work as World::step does each step.
+			states.clear();
+			for (const auto& body : bodies) {
+				states.add(body);
+			}
+			integrateForces(states, gravity, resistance, dt);
+			// The solver runs on the bodies in between.
+			states.scatterVelocities(constView(pointers));
+			states.gatherVelocities(constView(pointers));
+			projectVelocitiesToSphereTangentSpace(states);
+			moveForwardOnSphere(states, dt);
+			states.scatterPositionsAndVelocities(constView(pointers));
+		}
+		put("structure of arrays with gather and scatter: % ms per step", millisecondsSince(start) / f64(stepCount));
+	}
+
+	{
+		const auto start = Clock::now();
+		for (i32 i = 0; i < stepCount; i++) {
+			integrateForces(states, gravity, resistance, dt);
+			projectVelocitiesToSphereTangentSpace(states);
+			moveForwardOnSphere(states, dt);
+		}
+		put("structure of arrays kernels only: % ms per step", millisecondsSince(start) / f64(stepCount));
+	}
+
+	// One step of each version from the same state should give the same positions up to rounding.
+	auto aos = referenceBodies;
+	integrateArrayOfStructures(aos, gravity, resistance, dt);
+	states.clear();
+	for (const auto& body : referenceBodies) {
+		states.add(body);
+	}
+	integrateForces(states, gravity, resistance, dt);
+	projectVelocitiesToSphereTangentSpace(states);
+	moveForwardOnSphere(states, dt);
+	f32 maxPositionError = 0.0f;
+	for (i32 i = 0; i < bodyCount; i++) {
+		const auto p = Vec4(states.positionX[i], states.positionY[i], states.positionZ[i], states.positionW[i]);
+		maxPositionError = std::max(maxPositionError, (p - aos[i].position).length());
+	}
+	const auto tolerance = 0.00001f;
+	const auto matches = maxPositionError <= tolerance;
+	put("max position difference after one step: % %", maxPositionError, matches ? "matches" : "MISMATCH");
+	return matches;
+}
+
+bool solverBenchmark() {
+	const Tiling tiling(make120cell());
+	const i32 bodyCount = 4000;
+	const auto dt = 1.0f / 60.0f;
+	const i32 settleStepCount = 120;
+	const i32 stepCount = 60;
+
+	const auto maxThreadCount = std::max(1, i32(std::thread::hardware_concurrency()));
+	std::vector<i32> threadCounts;
+	for (i32 threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2) {
+		threadCounts.push_back(threadCount);
+	}
+
+	f64 sequentialMs = 0.0;
+	bool allMatch = true;
+	for (const auto useGraphColoring : { false, true }) {
+		u64 firstStateHash = 0;
+		for (const auto threadCount : threadCounts) {
+			std::mt19937 rng(0);
+			World world(8);
+			world.gravity = Vec4(0.0f, 0.0f, 0.0f, -1.0f);
+			world.solverThreadCount = threadCount;
+			world.useGraphColoring = useGraphColoring;
+			// Otherwise the piles would fall asleep and there would be nothing to solve.
+			world.allowSleeping = false;
+			addTilingWalls(world, tiling);
+			// Randomly placed spheres overlap deeply and the solver can't separate them without making them fast enough to blow up the scene.
+			addSeparatedRandomSpheres(world, bodyCount, 0.3f, rng);
+			// Letting the bodies fall into piles so the islands get large.
+			for (i32 i = 0; i < settleStepCount; i++) {
+				world.step(dt);
+			}
+
+			f64 solveMs = 0.0;
+			const auto start = Clock::now();
+			for (i32 i = 0; i < stepCount; i++) {
+				world.step(dt);
+			}
+			const auto stepMs = millisecondsSince(start) / f64(stepCount);
+			if (!useGraphColoring && threadCount == 1) {
+				sequentialMs = stepMs;
+			}
+
+			// Without coloring the result should be the same for all thread counts. With coloring it should be the same for all thread counts, but different from the runs without coloring.
+			const auto stateHash = world.stateHash();
+			if (threadCount == threadCounts.front()) {
+				firstStateHash = stateHash;
+			}
+			const auto matches = stateHash == firstStateHash;
+			allMatch = allMatch && matches;
+			put("% threads, coloring %: % ms per step, speedup %, % constraints, % islands, % colored islands, state hash %, %",
+				threadCount,
+				useGraphColoring ? "on" : "off",
+				stepMs,
+				sequentialMs / stepMs,
+				world.contactConstraints.size(),
+				world.islands.islands.size(),
+				world.islands.coloredIslands.size(),
+				stateHash,
+				matches ? "matches" : "MISMATCH");
+		}
+	}
+	return allMatch;
+}
+
+bool sleepingBenchmark() {
+	const Tiling tiling(make120cell());
+	const auto dt = 1.0f / 60.0f;
+	const i32 settleStepCount = 600;
+	const i32 stepCount = 60;
+	for (const auto allowSleeping : { false, true }) {
+		std::mt19937 rng(0);
+		World world(8);
+		world.gravity = Vec4(0.0f, 0.0f, 0.0f, -1.0f);
+		world.allowSleeping = allowSleeping;
+		addTilingWalls(world, tiling);
+		// The same start as the solver benchmark. The overlapping random positions blow up the scene before it can settle.
+		addSeparatedRandomSpheres(world, 4000, 0.3f, rng);
+		for (i32 i = 0; i < settleStepCount; i++) {
+			world.step(dt);
+		}
+
+		const auto start = Clock::now();
+		for (i32 i = 0; i < stepCount; i++) {
+			world.step(dt);
+		}
+		i64 sleepingBodyCount = 0;
+		for (const auto& [_, islandBodies] : world.sleepingIslands) {
+			sleepingBodyCount += i64(islandBodies.size());
+		}
+		put("sleeping %: % ms per step, % sleeping bodies, % contacts",
+			allowSleeping ? "on" : "off",
+			millisecondsSince(start) / f64(stepCount),
+			sleepingBodyCount,
+			world.contactConstraints.size());
+	}
+	return true;
+}
+
+static Vec4 cellCenter(const Tiling& tiling, CellIndex cell) {
+	Vec4 sum(0.0f);
+	for (const auto& face : tiling.facesOfCell(cell)) {
+		for (const auto& vertex : tiling.verticesOfFace(face)) {
+			sum += tiling.vertices[vertex];
+		}
+	}
+	return sum.normalized();
+}
+
+static bool isInsideCell(const Tiling& tiling, CellIndex cell, Vec4 point) {
+	for (const auto& normal : tiling.faceNormalsOfCell(cell)) {
+		if (dot(normal, point) > 0.0f) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool continuousCollisionBenchmark() {
+	const Tiling tiling(make120cell());
+	const f32 speed = 15.0f;
+	const f32 radius = 0.03f;
+	const f32 simulatedTime = 4.0f;
+
+	struct Configuration {
+		const char* name;
+		f32 dt;
+		bool useContinuousCollision;
+	};
+	const Configuration configurations[]{
+		{ "dt 1/30 without ccd", 1.0f / 30.0f, false },
+		{ "dt 1/30 with ccd", 1.0f / 30.0f, true },
+		{ "dt 1/120 without ccd", 1.0f / 120.0f, false },
+	};
+	for (const auto& configuration : configurations) {
+		std::mt19937 rng(0);
+		World world(8);
+		world.resistance = 1.0f;
+		world.useContinuousCollision = configuration.useContinuousCollision;
+		addTilingWalls(world, tiling);
+		// One fast sphere in the center of each cell.
+		for (CellIndex cell = 0; cell < tiling.cellCount(); cell++) {
+			const auto center = cellCenter(tiling, cell);
+			world.createSphere(center, radius, 1.0f);
+		}
+		for (auto body : world.bodies) {
+			if (body->invMass == 0.0f) {
+				continue;
+			}
+			const auto direction = projectVectorToSphereTangentSpace(body->position, randomPointOnSphere(rng)).normalized();
+			body->velocity = direction * speed;
+		}
+
+		const auto stepCount = i32(simulatedTime / configuration.dt);
+		const auto start = Clock::now();
+		for (i32 i = 0; i < stepCount; i++) {
+			world.step(configuration.dt);
+		}
+		const auto totalMs = millisecondsSince(start);
+
+		// The spheres were created in the order of the cells.
+		i32 escapedCount = 0;
+		i32 cellIndex = 0;
+		for (auto body : world.bodies) {
+			if (body->invMass == 0.0f) {
+				continue;
+			}
+			if (!isInsideCell(tiling, cellIndex, body->position)) {
+				escapedCount++;
+			}
+			cellIndex++;
+		}
+		put("%: % of % spheres tunneled out of their cells, % steps, % ms total",
+			configuration.name,
+			escapedCount,
+			tiling.cellCount(),
+			stepCount,
+			totalMs);
+	}
+	return true;
+}
+
+bool wallMeshBenchmark() {
+	const Tiling tiling(make120cell());
+	const auto dt = 1.0f / 60.0f;
+	const i32 settleStepCount = 120;
+	const i32 stepCount = 60;
+	for (const auto useWallMesh : { false, true }) {
+		std::mt19937 rng(0);
+		World world(8);
+		world.gravity = Vec4(0.0f, 0.0f, 0.0f, -1.0f);
+		world.allowSleeping = false;
+		if (useWallMesh) {
+			world.createWallMesh(tiling);
+		} else {
+			addTilingWalls(world, tiling);
+		}
+		addSeparatedRandomSpheres(world, 4000, 0.3f, rng);
+		for (i32 i = 0; i < settleStepCount; i++) {
+			world.step(dt);
+		}
+
+		World::StepTimings total;
+		const auto start = Clock::now();
+		for (i32 i = 0; i < stepCount; i++) {
+			world.step(dt);
+			total.broadPhase += world.lastStepTimings.broadPhase;
+		}
+		i64 contactPointCount = 0;
+		for (const auto& constraint : world.contactConstraints.constraints) {
+			contactPointCount += constraint.numContacts;
+		}
+		put("%: % ms per step, broad phase % ms per step, % bodies, % constraints, % contact points",
+			useWallMesh ? "wall mesh" : "wall bodies",
+			millisecondsSince(start) / f64(stepCount),
+			total.broadPhase / f64(stepCount),
+			world.bodies.aliveCount(),
+			world.contactConstraints.size(),
+			contactPointCount);
+	}
+	return true;
+}
+
+// The angle between 2 points on the unit sphere. More precise than acos(dot(a, b)) for small angles.
+static f32 angleBetween(Vec4 a, Vec4 b) {
+	return 2.0f * asin(std::min(1.0f, (a - b).length() / 2.0f));
+}
+
+bool fixedTimestepBenchmark() {
+	const auto fixedDt = 1.0f / 60.0f;
+	const i32 stepCount = 240;
+	// A frame much longer than maxStepsPerUpdate steps, like the one after loading a board.
+	const auto slowFrameDt = 0.5f;
+
+	u64 firstStateHash = 0;
+	bool allMatch = true;
+	for (const auto frameDt : { 1.0f / 144.0f, 1.0f / 30.0f }) {
+		std::mt19937 rng(0);
+		World world(8);
+		world.gravity = Vec4(0.3f, 0.0f, 0.0f, -1.0f);
+		world.fixedDt = fixedDt;
+		world.allowSleeping = false;
+		// The overlapping random positions blow up the scene and the velocities become NaN.
+		addSeparatedRandomSpheres(world, 500, 0.2f, rng);
+
+		// Checked after every update.
+		i32 frameCount = 0;
+		i32 takenStepCount = 0;
+		i32 maxStepsInFrame = 0;
+		f32 minAlpha = 1.0f;
+		f32 maxAlpha = 0.0f;
+		f32 maxDistanceFromSphere = 0.0f;
+		// How far the interpolated position is from the point alpha of the way along the geodesic from the saved to the current position. The geodesic distances sum to the distance between the endpoints only if it's on the arc between them.
+		f32 maxInterpolationError = 0.0f;
+		auto checkFrame = [&](i32 stepsInFrame) {
+			frameCount++;
+			takenStepCount += stepsInFrame;
+			maxStepsInFrame = std::max(maxStepsInFrame, stepsInFrame);
+			const auto alpha = world.interpolationAlpha();
+			minAlpha = std::min(minAlpha, alpha);
+			maxAlpha = std::max(maxAlpha, alpha);
+			for (auto body : world.bodies) {
+				const auto index = body.id.index();
+				if (index >= i32(world.previousPositionBodies.size()) || world.previousPositionBodies[index] != body.id) {
+					continue;
+				}
+				const auto previous = world.previousPositions[index];
+				const auto current = body->position;
+				const auto interpolated = world.interpolatedPosition(body.id);
+				maxDistanceFromSphere = std::max(maxDistanceFromSphere, std::abs(interpolated.length() - 1.0f));
+				const auto fromPrevious = angleBetween(previous, interpolated);
+				const auto toCurrent = angleBetween(interpolated, current);
+				const auto total = angleBetween(previous, current);
+				maxInterpolationError = std::max(maxInterpolationError, std::abs(fromPrevious + toCurrent - total));
+				maxInterpolationError = std::max(maxInterpolationError, std::abs(fromPrevious - alpha * total));
+			}
+		};
+
+		while (takenStepCount < stepCount) {
+			checkFrame(world.update(frameDt));
+		}
+		// The simulation only depends on the number of steps taken, so it has to end up in the same state for every frame time.
+		const auto stateHash = world.stateHash();
+		if (firstStateHash == 0) {
+			firstStateHash = stateHash;
+		}
+		const auto normalFrameCount = frameCount;
+		const auto normalStepCount = takenStepCount;
+		const auto normalMaxStepsInFrame = maxStepsInFrame;
+		const auto expectedStepCount = i32(round(f64(frameCount) * f64(frameDt) / f64(fixedDt)));
+
+		const auto droppedBefore = world.droppedStepCount;
+		const auto accumulatedBefore = world.accumulatedTime;
+		const auto stepsInSlowFrame = world.update(slowFrameDt);
+		checkFrame(stepsInSlowFrame);
+		const auto droppedInSlowFrame = world.droppedStepCount - droppedBefore;
+		// Every whole step in the accumulator above maxStepsPerUpdate is dropped. Allowing a difference of 1 for the rounding of the accumulated time.
+		const auto expectedDropped = i32((f64(accumulatedBefore) + f64(slowFrameDt)) / f64(fixedDt)) - world.maxStepsPerUpdate;
+
+		const auto matches =
+			std::abs(normalStepCount - expectedStepCount) <= 1 &&
+			stateHash == firstStateHash &&
+			droppedBefore == 0 &&
+			stepsInSlowFrame == world.maxStepsPerUpdate &&
+			std::abs(droppedInSlowFrame - expectedDropped) <= 1 &&
+			normalMaxStepsInFrame <= i32(ceil(frameDt / fixedDt)) &&
+			minAlpha >= 0.0f && maxAlpha < 1.0f &&
+			maxDistanceFromSphere < 0.0001f &&
+			maxInterpolationError < 0.0005f;
+		allMatch = allMatch && matches;
+		put("frame dt %: % frames, % steps (expected %), at most % per frame, state hash %, slow frame % steps and % dropped (expected %), alpha in [%, %], max distance from the sphere %, max interpolation error %, %",
+			frameDt,
+			normalFrameCount,
+			normalStepCount,
+			expectedStepCount,
+			normalMaxStepsInFrame,
+			stateHash,
+			stepsInSlowFrame,
+			droppedInSlowFrame,
+			expectedDropped,
+			minAlpha,
+			maxAlpha,
+			maxDistanceFromSphere,
+			maxInterpolationError,
+			matches ? "matches" : "MISMATCH");
+	}
+	put("%", allMatch ? "matches" : "MISMATCH");
+	return allMatch;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <game/Physics/World.hpp>
+#include <game/Tiling.hpp>
+#include <random>
+
+Vec4 randomPointOnSphere(std::mt19937& rng);
+// Adds spheres with random positions. The radius is chosen so that the spheres fill the given fraction of the volume of the 3-sphere. Each sphere is placed at the first random position not overlapping the already placed spheres. Takes O(count^2) time and gets very slow for volume fractions approaching 0.38, above which the spheres placed this way usually leave no space.
+void addSeparatedRandomSpheres(World& world, i32 count, f32 volumeFraction, std::mt19937& rng);
+// Creates walls on every face of the tiling. The faces are triangulated with a fan from the first vertex.
+void addTilingWalls(World& world, const Tiling& tiling);
+
+// Compares the candidate pair counts and step times of the grid broad phase against the all pairs loop.
+bool broadPhaseBenchmark();
+
+// Compares the structure of arrays integration kernels against the per body loop World::step used before on 100k bodies.
+bool integrationBenchmark();
+
+// Thousands of spheres falling into the cells of the 120-cell. Compares the solve time for different thread counts with and without graph coloring and checks that the state doesn't depend on the thread count.
+bool solverBenchmark();
+
+// Step time of the settled solver scene with and without sleeping.
+bool sleepingBenchmark();
+
+// Fast spheres bouncing inside the cells of the 120-cell. Compares how many tunnel through the walls with a large step with and without continuous collision detection and with smaller steps.
+bool continuousCollisionBenchmark();
+
+// The solver scene with the walls created as a body for each triangle and as a single wall mesh. Compares the step times and the number of contacts.
+bool wallMeshBenchmark();
+
+// Runs World::update with frame times shorter and longer than the fixed step and then a single very long frame. Checks the number of steps taken and dropped, that the state only depends on the number of steps and that the interpolated positions are on the geodesic between the saved and the current positions.
+bool fixedTimestepBenchmark();
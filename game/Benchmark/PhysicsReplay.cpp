@@ -0,0 +1,131 @@
+#include "PhysicsReplay.hpp"
+#include <game/Benchmark/PhysicsBenchmarks.hpp>
+#include <game/4d.hpp>
+#include <Put.hpp>
+#include <fstream>
+#include <string>
+
+void randomSpheresScene(World& world) {
+	std::mt19937 rng(0);
+	addSeparatedRandomSpheres(world, 2000, 0.3f, rng);
+	std::uniform_real_distribution<f32> speed(0.0f, 0.5f);
+	// The created bodies are active immediately so they can be iterated before the first step.
+	for (auto body : world.bodies) {
+		const auto direction = projectVectorToSphereTangentSpace(body->position, randomPointOnSphere(rng)).normalized();
+		body->velocity = direction * speed(rng);
+	}
+}
+
+void tilingWallsScene(World& world) {
+	static const Tiling tiling(make120cell());
+	std::mt19937 rng(0);
+	world.gravity = Vec4(0.0f, 0.0f, 0.0f, -1.0f);
+	addTilingWalls(world, tiling);
+	addSeparatedRandomSpheres(world, 2000, 0.3f, rng);
+}
+
+static std::string hashToString(u64 hash) {
+	static const char digits[] = "0123456789abcdef";
+	std::string result(16, '0');
+	for (i32 i = 15; i >= 0; i--) {
+		result[i] = digits[hash & 0xF];
+		hash >>= 4;
+	}
+	return result;
+}
+
+PhysicsReplayResult runPhysicsReplay(const PhysicsScene& scene, const PhysicsConfiguration& configuration, i32 stepCount, std::string_view hashesPath) {
+	const auto previousAccumulateImpulses = World::accumulateImpulses;
+	const auto previousWarmStarting = World::warmStarting;
+	const auto previousPositionCorrection = World::positionCorrection;
+	World::accumulateImpulses = configuration.accumulateImpulses;
+	World::warmStarting = configuration.warmStarting;
+	World::positionCorrection = configuration.positionCorrection;
+
+	PhysicsReplayResult result;
+
+	std::vector<std::string> referenceHashes;
+	{
+		std::ifstream reference{ std::string(hashesPath) };
+		result.hadReference = reference.is_open();
+		std::string line;
+		while (std::getline(reference, line)) {
+			referenceHashes.push_back(line);
+		}
+	}
+
+	World world(8);
+	scene.create(world);
+
+	std::vector<std::string> hashes;
+	for (i32 i = 0; i < stepCount; i++) {
+		world.step(1.0f / 60.0f);
+		const auto& timings = world.lastStepTimings;
+		result.totalTimings.broadPhase += timings.broadPhase;
+		result.totalTimings.preStep += timings.preStep;
+		result.totalTimings.iterations += timings.iterations;
+		result.totalTimings.integration += timings.integration;
+
+		hashes.push_back(hashToString(world.stateHash()));
+		if (result.hadReference && result.firstMismatchedStep == -1) {
+			if (i >= i32(referenceHashes.size()) || referenceHashes[i] != hashes.back()) {
+				result.firstMismatchedStep = i;
+			}
+		}
+	}
+	result.stepCount = stepCount;
+	result.finalHash = world.stateHash();
+
+	if (!result.hadReference) {
+		std::ofstream output{ std::string(hashesPath) };
+		for (const auto& hash : hashes) {
+			output << hash << '\n';
+		}
+	}
+
+	World::accumulateImpulses = previousAccumulateImpulses;
+	World::warmStarting = previousWarmStarting;
+	World::positionCorrection = previousPositionCorrection;
+	return result;
+}
+
+bool physicsReplayBenchmark() {
+	const PhysicsScene scenes[]{
+		{ "randomSpheres", randomSpheresScene },
+		{ "tilingWalls", tilingWallsScene },
+	};
+	const PhysicsConfiguration configurations[]{
+		{ "default", true, true, true },
+		{ "noAccumulateImpulses", false, true, true },
+		{ "noWarmStarting", true, false, true },
+		{ "noPositionCorrection", true, true, false },
+	};
+	const i32 stepCount = 300;
+	bool allMatch = true;
+
+	for (const auto& scene : scenes) {
+		for (const auto& configuration : configurations) {
+			const auto path = std::string("physicsReplay_") + scene.name + "_" + configuration.name + ".txt";
+			const auto result = runPhysicsReplay(scene, configuration, stepCount, path);
+			const auto perStep = [&](f64 total) { return total / f64(result.stepCount); };
+			const auto& t = result.totalTimings;
+			put("%, %: broad phase % ms, preStep % ms, iterations % ms, integration % ms per step, final hash %",
+				scene.name,
+				configuration.name,
+				perStep(t.broadPhase),
+				perStep(t.preStep),
+				perStep(t.iterations),
+				perStep(t.integration),
+				hashToString(result.finalHash));
+			if (!result.hadReference) {
+				put("  recorded reference hashes into %", path);
+			} else if (result.firstMismatchedStep == -1) {
+				put("  matches %", path);
+			} else {
+				allMatch = false;
+				put("  MISMATCH with % at step %", path, result.firstMismatchedStep);
+			}
+		}
+	}
+	return allMatch;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <game/Physics/World.hpp>
+#include <string_view>
+
+/*
+Runs canonical scenes for a fixed number of steps and records the per phase timings and the state hash after each step.
+
+The hashes are written into physicsReplay_<scene>_<configuration>.txt in the working directory. If the file already exists the new hashes are compared against it instead and the first differing step is reported. So to check for determinism regressions run the benchmark once before and once after the change. To record new reference hashes delete the files.
+*/
+struct PhysicsScene {
+	const char* name;
+	void (*create)(World& world);
+};
+void randomSpheresScene(World& world);
+// Spheres falling into the cells of the 120-cell.
+void tilingWallsScene(World& world);
+
+struct PhysicsConfiguration {
+	const char* name;
+	bool accumulateImpulses;
+	bool warmStarting;
+	bool positionCorrection;
+};
+
+struct PhysicsReplayResult {
+	World::StepTimings totalTimings;
+	i32 stepCount = 0;
+	u64 finalHash = 0;
+	// -1 if the hashes matched or there was no reference file.
+	i32 firstMismatchedStep = -1;
+	bool hadReference = false;
+};
+PhysicsReplayResult runPhysicsReplay(const PhysicsScene& scene, const PhysicsConfiguration& configuration, i32 stepCount, std::string_view hashesPath);
+
+bool physicsReplayBenchmark();
@@ -0,0 +1,651 @@
+#include "StereographicBenchmark.hpp"
+#include <game/StereographicBatch.hpp>
+#include <game/Stereographic.hpp>
+#include <game/StereographicArc.hpp>
+#include <game/LineGenerator.hpp>
+#include <game/MeshUtils.hpp>
+#include <game/Tiling.hpp>
+#include <game/Polytopes.hpp>
+#include <engine/Math/Circle.hpp>
+#include <engine/Math/Interpolation.hpp>
+#include <engine/Math/Angles.hpp>
+#include <game/Benchmark/PhysicsBenchmarks.hpp>
+#include <engine/Math/GramSchmidt.hpp>
+#include <Put.hpp>
+#include <game/Clock.hpp>
+#include <random>
+#include <algorithm>
+#include <array>
+
+static Mat4 randomRotation(std::mt19937& rng) {
+	std::array<Vec4, 4> basis;
+	for (auto& v : basis) {
+		v = randomPointOnSphere(rng);
+	}
+	gramSchmidtOrthonormalize(View<Vec4>(basis.data(), basis.size()));
+	return Mat4(basis[0], basis[1], basis[2], basis[3]);
+}
+
+namespace {
+
+struct Accuracy {
+	// Relative to the length of the scalar result, or absolute if it's shorter than 1.
+	f32 maxProjectedError = 0.0f;
+	f32 maxTransformedError = 0.0f;
+	bool infinitiesMatch = true;
+
+	bool matches() const {
+		return infinitiesMatch && maxProjectedError < 0.0001f && maxTransformedError < 0.00001f;
+	}
+};
+
+}
+
+static f32 relativeError(Vec3 batch, Vec3 scalar) {
+	return (batch - scalar).length() / std::max(1.0f, scalar.length());
+}
+
+static void checkProjection(const Mat4& transform, const std::vector<Vec4>& points, Accuracy& accuracy) {
+	const auto count = i64(points.size());
+	std::vector<Vec4> transformed(count);
+	std::vector<Vec3> projected(count);
+	std::vector<u64> atInfinity(stereographicInfinityMaskWordCount(count));
+	stereographicProjection(transform, constView(points), view(transformed), view(projected), view(atInfinity));
+
+	std::vector<Vec3> projectedOnly(count);
+	std::vector<u64> atInfinityOnly(stereographicInfinityMaskWordCount(count));
+	stereographicProjection(transform, constView(points), view(projectedOnly), view(atInfinityOnly));
+	accuracy.infinitiesMatch = accuracy.infinitiesMatch && atInfinity == atInfinityOnly;
+
+	for (i64 i = 0; i < count; i++) {
+		const auto p = transform * points[i];
+		const auto scalar = stereographicProjection(p);
+		const auto scalarAtInfinity = isPointAtInfinity(scalar);
+		if (scalarAtInfinity != isPointAtInfinity(constView(atInfinity), i) ||
+			scalarAtInfinity != isPointAtInfinity(projected[i]) ||
+			scalarAtInfinity != isPointAtInfinity(projectedOnly[i])) {
+			accuracy.infinitiesMatch = false;
+		}
+		accuracy.maxTransformedError = std::max(accuracy.maxTransformedError, (transformed[i] - p).length());
+		if (!scalarAtInfinity) {
+			accuracy.maxProjectedError = std::max({
+				accuracy.maxProjectedError,
+				relativeError(projected[i], scalar),
+				relativeError(projectedOnly[i], scalar)
+			});
+		}
+	}
+}
+
+static void checkInverseProjection(const std::vector<Vec3>& points, Accuracy& accuracy) {
+	std::vector<Vec4> result(points.size());
+	inverseStereographicProjection(constView(points), view(result));
+	for (i64 i = 0; i < i64(points.size()); i++) {
+		const auto scalar = inverseStereographicProjection(points[i]);
+		accuracy.maxTransformedError = std::max(accuracy.maxTransformedError, (result[i] - scalar).length());
+	}
+}
+
+bool stereographicProjectionBenchmark() {
+	std::mt19937 rng(0);
+	bool allMatch = true;
+
+	{
+		Accuracy accuracy;
+		// Random points, with counts that aren't multiples of the SIMD width so the scalar remainder is checked too.
+		for (const auto& count : { 1, 3, 7, 13, 1000, 1023 }) {
+			std::vector<Vec4> points;
+			for (i32 i = 0; i < count; i++) {
+				points.push_back(randomPointOnSphere(rng));
+			}
+			checkProjection(randomRotation(rng), points, accuracy);
+		}
+		// The points at and near the pole of the projection, mixed with ordinary points.
+		std::vector<Vec4> points;
+		for (i32 i = 0; i < 100; i++) {
+			if (i % 3 == 0) {
+				points.push_back(Vec4(0.0f, 0.0f, 0.0f, 1.0f));
+			} else if (i % 3 == 1) {
+				points.push_back(Vec4(0.001f, 0.0f, 0.0f, 1.0f).normalized());
+			} else {
+				points.push_back(randomPointOnSphere(rng));
+			}
+		}
+		checkProjection(Mat4::identity, points, accuracy);
+
+		std::vector<Vec3> projected;
+		for (i32 i = 0; i < 1003; i++) {
+			if (i % 10 == 0) {
+				projected.push_back(Vec3(INFINITY, INFINITY, INFINITY));
+			} else {
+				projected.push_back(stereographicProjection(randomPointOnSphere(rng)));
+			}
+		}
+		Accuracy inverseAccuracy;
+		checkInverseProjection(projected, inverseAccuracy);
+
+		put("projection: max error %, transformed max error %, infinities %",
+			accuracy.maxProjectedError,
+			accuracy.maxTransformedError,
+			accuracy.infinitiesMatch ? "match" : "DON'T MATCH");
+		put("inverse projection: max error %", inverseAccuracy.maxTransformedError);
+		allMatch = accuracy.matches() && inverseAccuracy.matches();
+		put("%", allMatch ? "matches" : "MISMATCH");
+	}
+
+	const i32 pointCounts[]{ 1000, 10000, 100000 };
+	for (const auto& count : pointCounts) {
+		std::vector<Vec4> points;
+		for (i32 i = 0; i < count; i++) {
+			points.push_back(randomPointOnSphere(rng));
+		}
+		const auto transform = randomRotation(rng);
+		std::vector<Vec3> projected(count);
+		std::vector<u64> atInfinity(stereographicInfinityMaskWordCount(count));
+		std::vector<Vec4> inverse(count);
+		// Enough repetitions that each measurement takes a few milliseconds.
+		const auto repetitionCount = 10'000'000 / count;
+
+		auto start = Clock::now();
+		for (i32 repetition = 0; repetition < repetitionCount; repetition++) {
+			for (i32 i = 0; i < count; i++) {
+				projected[i] = stereographicProjection(transform * points[i]);
+				if (isPointAtInfinity(projected[i])) {
+					atInfinity[i / 64] |= u64(1) << (i % 64);
+				}
+			}
+		}
+		const auto scalarMs = millisecondsSince(start) / repetitionCount;
+
+		start = Clock::now();
+		for (i32 repetition = 0; repetition < repetitionCount; repetition++) {
+			stereographicProjection(transform, constView(points), view(projected), view(atInfinity));
+		}
+		const auto batchMs = millisecondsSince(start) / repetitionCount;
+
+		start = Clock::now();
+		for (i32 repetition = 0; repetition < repetitionCount; repetition++) {
+			for (i32 i = 0; i < count; i++) {
+				inverse[i] = inverseStereographicProjection(projected[i]);
+			}
+		}
+		const auto scalarInverseMs = millisecondsSince(start) / repetitionCount;
+
+		start = Clock::now();
+		for (i32 repetition = 0; repetition < repetitionCount; repetition++) {
+			inverseStereographicProjection(constView(projected), view(inverse));
+		}
+		const auto batchInverseMs = millisecondsSince(start) / repetitionCount;
+
+		put("% points: projection scalar % ms, batch % ms (% times faster), inverse scalar % ms, batch % ms (% times faster)",
+			count,
+			scalarMs,
+			batchMs,
+			scalarMs / batchMs,
+			scalarInverseMs,
+			batchInverseMs,
+			scalarInverseMs / batchInverseMs);
+	}
+	return allMatch;
+}
+
+// The circle fitting Minesweeper::update did for each edge before StereographicSegment::fromProjectedEndpoints.
+static StereographicSegment projectEdgeByFitting(Vec4 e0, Vec4 e1, Vec3 p0, Vec3 p1) {
+	auto velocityOutOfAToB = [](Vec4 a, Vec4 b) {
+		const auto velocity4 = (b - dot(b, a.normalized()) * a.normalized()).normalized();
+		const auto velocity3 = stereographicProjectionJacobian(a, velocity4);
+		return velocity3;
+	};
+
+	if (isPointAtInfinity(p0) && isPointAtInfinity(p1)) {
+		return StereographicSegment::fromLine(p0, p1);
+	} else if (isPointAtInfinity(p0) || isPointAtInfinity(p1)) {
+		auto atInfinity = p0;
+		auto finite = p1;
+		auto atInfinity4 = e0;
+		auto finite4 = e1;
+		if (isPointAtInfinity(finite)) {
+			std::swap(atInfinity, finite);
+			std::swap(atInfinity4, finite4);
+		}
+		const auto directionFromFiniteToInfinity = velocityOutOfAToB(finite4, atInfinity4).normalized();
+		return StereographicSegment::fromLine(finite, finite + directionFromFiniteToInfinity * 1000.0f);
+	}
+	auto p2 = antipodalPoint(p0);
+	if (isPointAtInfinity(p2)) {
+		p2 = antipodalPoint(p1);
+		if (isPointAtInfinity(p2)) {
+			return StereographicSegment::fromLine(p0, p1);
+		}
+	}
+	const auto velocityOutOfP0ToP1 = velocityOutOfAToB(e0, e1);
+
+	const auto coordinateSystemOrigin = p0;
+	Vec3 v0 = p2 - coordinateSystemOrigin;
+	Vec3 v1 = p1 - coordinateSystemOrigin;
+	const auto b0 = v0.normalized();
+	const auto b1 = (v1 - dot(v1, b0) * b0).normalized();
+	auto coordinatesInBasis = [&b0, &b1](Vec3 v) -> Vec2 {
+		return Vec2(dot(v, b0), dot(v, b1));
+	};
+	auto fromCoordinatesInBasis = [&b0, &b1, &coordinateSystemOrigin](Vec2 v) -> Vec3 {
+		return v.x * b0 + v.y * b1 + coordinateSystemOrigin;
+	};
+	const auto circle = Circle::thoughPoints(Vec2(0.0f), coordinatesInBasis(v0), coordinatesInBasis(v1));
+	const auto center = fromCoordinatesInBasis(circle.center);
+
+	auto circularDistance = [](Vec3 a, Vec3 b) {
+		return acos(std::clamp(dot(a.normalized(), b.normalized()), -1.0f, 1.0f));
+	};
+	f32 d = circularDistance(p0 - center, p1 - center);
+	const auto p = (p0 - center);
+	const auto v = velocityOutOfP0ToP1.normalized() * p.length();
+	{
+		const auto calculatedEndpoint0 = center + p * cos(d) + v * sin(d);
+		const auto calculatedEndpoint1 = center + p * cos(TAU<f32> - d) + v * sin(TAU<f32> - d);
+		if (calculatedEndpoint0.distanceTo(p1) > calculatedEndpoint1.distanceTo(p1)) {
+			d = TAU<f32> - d;
+		}
+	}
+	return StereographicSegment::fromCircular(p, v, center, d);
+}
+
+// LineGenerator::addCircularArc and circleArcPointCountRequiredToAchiveError before the cross section was precomputed.
+static void addCircularArcWithoutPrecomputedCrossSection(LineGenerator& lines, Vec3 aRelativeToCenter, Vec3 velocityOutOfA, Vec3 circleCenter, f32 arclength, f32 tubeRadius, i32 pointCount) {
+	velocityOutOfA = velocityOutOfA.normalized() * aRelativeToCenter.length();
+
+	std::vector<Vec2> circlePoints;
+	const i32 circlePointCount = 10;
+	for (i32 i = 0; i < circlePointCount; i++) {
+		const auto a = (f32(i) / f32(circlePointCount)) * TAU<f32>;
+		circlePoints.push_back(Vec2::oriented(a));
+	}
+
+	const auto offset = lines.vertexCount();
+	const auto curveBinormal = cross(aRelativeToCenter, velocityOutOfA).normalized();
+	for (i32 curveI = 0; curveI < pointCount; curveI++) {
+		const auto curveAngle = lerp(0.0f, arclength, f32(curveI) / f32(pointCount - 1));
+		auto curveNormal = cos(curveAngle) * aRelativeToCenter + sin(curveAngle) * velocityOutOfA;
+		const auto curvePosition = circleCenter + curveNormal;
+		curveNormal = curveNormal.normalized();
+		for (const auto& circlePoint : circlePoints) {
+			const auto surfaceNormal = tubeRadius * (circlePoint.x * curveNormal + circlePoint.y * curveBinormal);
+			lines.positions.push_back(curvePosition + surfaceNormal);
+			lines.normals.push_back(surfaceNormal);
+		}
+	}
+	for (i32 circleI = 0; circleI < pointCount - 1; circleI++) {
+		i32 previousCirclePointI = circlePointCount - 1;
+		for (i32 circlePointI = 0; circlePointI < circlePointCount; circlePointI++) {
+			indicesAddQuad(
+				lines.indices,
+				offset + circleI * circlePointCount + previousCirclePointI,
+				offset + (circleI + 1) * circlePointCount + previousCirclePointI,
+				offset + (circleI + 1) * circlePointCount + circlePointI,
+				offset + circleI * circlePointCount + circlePointI
+			);
+			previousCirclePointI = circlePointI;
+		}
+	}
+}
+
+static std::optional<i32> circleArcPointCountUsingPow(f32 desiredMaxDeviation, f32 radius, f32 arcAngleLength, i32 maxAllowedPointCount) {
+	const auto k = acos(2.0f * pow(desiredMaxDeviation / radius - 1.0f, 2.0f) - 1.0f);
+	const auto divisionCount = std::min(i32(std::ceil(arcAngleLength / k)), 20);
+	if (divisionCount < 0) {
+		return std::nullopt;
+	}
+	return std::clamp(divisionCount + 1, 2, maxAllowedPointCount);
+}
+
+bool edgeArcsBenchmark() {
+	// The boards with the most curved edges. Every edge is visible on them, so all of them are drawn like in Minesweeper when TilingVisibility::everythingVisible().
+	struct Board {
+		const char* name;
+		FlatPolytope4 (*make)();
+	};
+	const Board boards[]{
+		{ "600-cell", makeFlat600cell },
+		{ "rectified 600-cell", makeFlatRectified600cell },
+	};
+	// The values used by Minesweeper.
+	const auto desiredDeviation = 0.1f;
+	const auto maxAllowedPointCount = 5;
+	const auto segmentWidth = 0.005f;
+	const i32 frameCount = 200;
+	bool allMatch = true;
+
+	for (const auto& board : boards) {
+		const Tiling tiling(board.make());
+		const auto edgeCount = i64(tiling.edges.size());
+		std::vector<Vec4> endpoints;
+		for (const auto& edge : tiling.edges) {
+			endpoints.push_back(tiling.vertices[edge.vertices[0]]);
+			endpoints.push_back(tiling.vertices[edge.vertices[1]]);
+		}
+		std::mt19937 rng(0);
+		std::vector<Mat4> views;
+		for (i32 i = 0; i < frameCount; i++) {
+			views.push_back(randomRotation(rng));
+		}
+		std::vector<Vec4> transformed(endpoints.size());
+		std::vector<Vec3> projected(endpoints.size());
+		std::vector<u64> atInfinity(stereographicInfinityMaskWordCount(endpoints.size()));
+		auto project = [&](const Mat4& view4) {
+			stereographicProjection(view4, constView(endpoints), view(transformed), view(projected), view(atInfinity));
+		};
+		auto isDrawn = [&](i64 edge) {
+			return !isPointAtInfinity(constView(atInfinity), 2 * edge) || !isPointAtInfinity(constView(atInfinity), 2 * edge + 1);
+		};
+
+		// The errors are distances relative to the distance from the camera, which is roughly the angle they take up on the screen.
+		f32 maxFittingError = 0.0f;
+		f32 maxClosedFormError = 0.0f;
+		f32 maxLineDifference = 0.0f;
+		i32 typeMismatchCount = 0;
+		i32 wrongDirectionCount = 0;
+		i32 circularCount = 0;
+		for (const auto& view4 : views) {
+			project(view4);
+			for (i64 i = 0; i < edgeCount; i++) {
+				if (!isDrawn(i)) {
+					continue;
+				}
+				const auto e0 = transformed[2 * i], e1 = transformed[2 * i + 1];
+				const auto p0 = projected[2 * i], p1 = projected[2 * i + 1];
+				const auto reference = projectEdgeByFitting(e0, e1, p0, p1);
+				const auto closedForm = StereographicSegment::fromProjectedEndpoints(e0, e1, p0, p1);
+				if (reference.type != closedForm.type) {
+					typeMismatchCount++;
+					continue;
+				}
+				if (reference.type == StereographicSegment::Type::LINE) {
+					for (i32 j = 0; j < 2; j++) {
+						maxLineDifference = std::max(maxLineDifference, (reference.line.e[j] - closedForm.line.e[j]).length() / std::max(1.0f, reference.line.e[j].length()));
+					}
+					continue;
+				}
+				// Minesweeper draws the almost straight arcs as lines.
+				if (reference.circular.angle < 0.01f || closedForm.circular.angle < 0.01f) {
+					continue;
+				}
+				circularCount++;
+				// The endpoints and the midpoint of the edge have to be on the circle and the midpoint has to be inside the arc.
+				const Vec4 edgePoints[]{ e0, e1, (e0 + e1).normalized() };
+				auto error = [&edgePoints](const CircularSegment& arc) {
+					const auto radius = arc.start.length();
+					f32 result = 0.0f;
+					for (const auto& point : edgePoints) {
+						const auto p = stereographicProjection(point);
+						result = std::max(result, std::abs((p - arc.center).length() - radius) / std::max(1.0f, p.length()));
+					}
+					return result;
+				};
+				maxFittingError = std::max(maxFittingError, error(reference.circular));
+				maxClosedFormError = std::max(maxClosedFormError, error(closedForm.circular));
+				const auto& arc = closedForm.circular;
+				const auto midpoint = stereographicProjection(edgePoints[2]) - arc.center;
+				auto midpointAngle = atan2(dot(midpoint, arc.initialVelocity), dot(midpoint, arc.start));
+				if (midpointAngle < 0.0f) {
+					midpointAngle += TAU<f32>;
+				}
+				if (midpointAngle > arc.angle) {
+					wrongDirectionCount++;
+				}
+			}
+		}
+		put("%: % edges, % circular arcs compared, max error fitting %, closed form %, max line difference %, % type mismatches, % arcs going the wrong way",
+			board.name,
+			edgeCount,
+			circularCount,
+			maxFittingError,
+			maxClosedFormError,
+			maxLineDifference,
+			typeMismatchCount,
+			wrongDirectionCount);
+		const auto matches =
+			typeMismatchCount == 0 &&
+			wrongDirectionCount == 0 &&
+			maxLineDifference < 0.001f &&
+			maxClosedFormError <= std::max(2.0f * maxFittingError, 0.001f);
+		allMatch = allMatch && matches;
+		put("%", matches ? "matches" : "MISMATCH");
+
+		std::vector<StereographicSegment> segments;
+		auto computeSegments = [&](const Mat4& view4, auto projectEdge) {
+			segments.clear();
+			project(view4);
+			for (i64 i = 0; i < edgeCount; i++) {
+				if (isDrawn(i)) {
+					segments.push_back(projectEdge(transformed[2 * i], transformed[2 * i + 1], projected[2 * i], projected[2 * i + 1]));
+				}
+			}
+		};
+		// Only the curved edges are generated here, because the straight ones are drawn as instances by GameRenderer the same way in both versions.
+		LineGenerator lines;
+		auto generateTubes = [&](auto pointCount, auto addCircularArc) {
+			for (const auto& segment : segments) {
+				if (segment.type != StereographicSegment::Type::CIRCULAR) {
+					continue;
+				}
+				const auto& arc = segment.circular;
+				if (arc.angle < 0.01f || std::abs(arc.angle - TAU<f32>) < 0.01f) {
+					continue;
+				}
+				const auto count = pointCount(desiredDeviation, arc.start.length(), arc.angle, maxAllowedPointCount);
+				if (count.has_value() && *count > 2) {
+					addCircularArc(lines, arc.start, arc.initialVelocity, arc.center, arc.angle, segmentWidth, *count);
+				}
+			}
+		};
+		auto addCircularArc = [](LineGenerator& lines, Vec3 start, Vec3 velocity, Vec3 center, f32 angle, f32 width, i32 count) {
+			lines.addCircularArc(start, velocity, center, angle, width, count);
+		};
+
+		f64 fittingMs = 0.0, fittingTubesMs = 0.0;
+		for (const auto& view4 : views) {
+			auto start = Clock::now();
+			computeSegments(view4, projectEdgeByFitting);
+			fittingMs += millisecondsSince(start);
+			start = Clock::now();
+			generateTubes(circleArcPointCountUsingPow, addCircularArcWithoutPrecomputedCrossSection);
+			fittingTubesMs += millisecondsSince(start);
+			lines.reset();
+		}
+		fittingMs /= frameCount;
+		fittingTubesMs /= frameCount;
+
+		f64 closedFormMs = 0.0, closedFormTubesMs = 0.0;
+		i64 vertexCount = 0;
+		for (const auto& view4 : views) {
+			auto start = Clock::now();
+			computeSegments(view4, StereographicSegment::fromProjectedEndpoints);
+			closedFormMs += millisecondsSince(start);
+			start = Clock::now();
+			generateTubes(circleArcPointCountRequiredToAchiveError, addCircularArc);
+			closedFormTubesMs += millisecondsSince(start);
+			vertexCount += lines.vertexCount();
+			lines.reset();
+		}
+		closedFormMs /= frameCount;
+		closedFormTubesMs /= frameCount;
+
+		const auto fittingTotalMs = fittingMs + fittingTubesMs;
+		const auto closedFormTotalMs = closedFormMs + closedFormTubesMs;
+		put("%: % tube vertices per frame; arcs: fitting % ms, closed form % ms (% times faster); tubes: before % ms, now % ms; total: before % ms, now % ms (% times faster)",
+			board.name,
+			vertexCount / frameCount,
+			fittingMs,
+			closedFormMs,
+			fittingMs / closedFormMs,
+			fittingTubesMs,
+			closedFormTubesMs,
+			fittingTotalMs,
+			closedFormTotalMs,
+			fittingTotalMs / closedFormTotalMs);
+	}
+	return allMatch;
+}
+
+bool edgeArcsInstancingBenchmark() {
+	struct Board {
+		const char* name;
+		FlatPolytope4 (*make)();
+	};
+	const Board boards[]{
+		{ "600-cell", makeFlat600cell },
+		{ "rectified 600-cell", makeFlatRectified600cell },
+	};
+	const auto segmentWidth = 0.005f;
+	const i32 frameCount = 200;
+	// The samples along the arc used to check isStereographicArcInstanceable.
+	const i32 sampleCount = 64;
+	bool allMatch = true;
+
+	for (const auto& board : boards) {
+		const Tiling tiling(board.make());
+		const auto edgeCount = i64(tiling.edges.size());
+		std::vector<Vec4> endpoints;
+		for (const auto& edge : tiling.edges) {
+			endpoints.push_back(tiling.vertices[edge.vertices[0]]);
+			endpoints.push_back(tiling.vertices[edge.vertices[1]]);
+		}
+		std::mt19937 rng(1);
+		std::vector<Mat4> views;
+		for (i32 i = 0; i < frameCount; i++) {
+			views.push_back(randomRotation(rng));
+		}
+		auto pointAtInfinity = [](const Mat4& view4) {
+			return view4.inversed() * Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		};
+
+		// The classification is compared against the largest w of points sampled along the arc, which can only be smaller than the exact maximum.
+		i32 instancedCount = 0;
+		i32 instancedTooCloseCount = 0;
+		i32 fallbackFarCount = 0;
+		// Distances between the vertices of the shader and LineGenerator::addCircularArc relative to the distance from the camera.
+		f32 maxArcError = 0.0f;
+		f32 maxLineError = 0.0f;
+		i32 comparedArcCount = 0;
+		LineGenerator lines;
+		for (const auto& view4 : views) {
+			const auto infinity = pointAtInfinity(view4);
+			for (i64 i = 0; i < edgeCount; i++) {
+				const auto e0 = endpoints[2 * i], e1 = endpoints[2 * i + 1];
+				const auto instanceable = isStereographicArcInstanceable(e0, e1, infinity);
+				const auto e0Transformed = view4 * e0, e1Transformed = view4 * e1;
+				f32 maxW = -1.0f;
+				for (i32 j = 0; j <= sampleCount; j++) {
+					const auto t = f32(j) / f32(sampleCount);
+					maxW = std::max(maxW, lerp(e0Transformed, e1Transformed, t).normalized().w);
+				}
+				if (!instanceable) {
+					if (maxW < 0.99f) {
+						fallbackFarCount++;
+					}
+					continue;
+				}
+				instancedCount++;
+				if (maxW > 0.996f) {
+					instancedTooCloseCount++;
+				}
+
+				const auto p0 = stereographicProjection(e0Transformed), p1 = stereographicProjection(e1Transformed);
+				const auto segment = StereographicSegment::fromProjectedEndpoints(e0Transformed, e1Transformed, p0, p1);
+				if (segment.type == StereographicSegment::Type::LINE || segment.circular.angle < 0.01f) {
+					// Only compare the center line, the orientation of the cross section of a line doesn't matter.
+					for (i32 j = 0; j < STEREOGRAPHIC_ARC_RING_COUNT; j++) {
+						const auto t = f32(j) / f32(STEREOGRAPHIC_ARC_RING_COUNT - 1);
+						const auto expected = lerp(p0, p1, t);
+						const auto vertex = stereographicArcVertex(view4, e0, e1, 0.0f, t, Vec2(1.0f, 0.0f));
+						maxLineError = std::max(maxLineError, (vertex.position - expected).length() / std::max(1.0f, expected.length()));
+					}
+					continue;
+				}
+				comparedArcCount++;
+				const auto& arc = segment.circular;
+				lines.addCircularArc(arc.start, arc.initialVelocity, arc.center, arc.angle, segmentWidth, STEREOGRAPHIC_ARC_RING_COUNT);
+				i32 vertexI = 0;
+				for (i32 ringI = 0; ringI < STEREOGRAPHIC_ARC_RING_COUNT; ringI++) {
+					const auto t = f32(ringI) / f32(STEREOGRAPHIC_ARC_RING_COUNT - 1);
+					for (i32 j = 0; j < STEREOGRAPHIC_ARC_CROSS_SECTION_POINT_COUNT; j++) {
+						const auto crossSection = Vec2::oriented(f32(j) / f32(STEREOGRAPHIC_ARC_CROSS_SECTION_POINT_COUNT) * TAU<f32>);
+						const auto vertex = stereographicArcVertex(view4, e0, e1, segmentWidth, t, crossSection);
+						const auto& expected = lines.positions[vertexI];
+						maxArcError = std::max(maxArcError, (vertex.position - expected).length() / std::max(1.0f, expected.length()));
+						vertexI++;
+					}
+				}
+				lines.reset();
+			}
+		}
+		put("%: % of % edges instanced, % instanced too close to infinity, % far from infinity not instanced, % arcs compared, max error arcs %, lines %",
+			board.name,
+			f64(instancedCount) / frameCount,
+			edgeCount,
+			instancedTooCloseCount,
+			fallbackFarCount,
+			comparedArcCount,
+			maxArcError,
+			maxLineError);
+		// The width is 0.005 so an error of 0.0001 is 2% of it.
+		const auto matches =
+			instancedTooCloseCount == 0 &&
+			fallbackFarCount == 0 &&
+			maxArcError < 0.0001f &&
+			maxLineError < 0.0001f;
+		allMatch = allMatch && matches;
+		put("%", matches ? "matches" : "MISMATCH");
+
+		// What is left for the CPU to do each frame when the arcs are instanced compared to projecting every edge and generating the tubes.
+		// The same as StereographicArcInstance, which is generated only for the game target.
+		struct Instance {
+			Vec4 e0;
+			Vec4 e1;
+			f32 width;
+			Vec3 color;
+		};
+		std::vector<Instance> instances;
+		auto start = Clock::now();
+		for (const auto& view4 : views) {
+			const auto infinity = pointAtInfinity(view4);
+			instances.clear();
+			for (i64 i = 0; i < edgeCount; i++) {
+				const auto e0 = endpoints[2 * i], e1 = endpoints[2 * i + 1];
+				if (isStereographicArcInstanceable(e0, e1, infinity)) {
+					instances.push_back(Instance{ .e0 = e0, .e1 = e1, .width = segmentWidth, .color = Vec3(1.0f) });
+				}
+			}
+		}
+		const auto instancingMs = millisecondsSince(start) / frameCount;
+
+		std::vector<Vec4> transformed(endpoints.size());
+		std::vector<Vec3> projected(endpoints.size());
+		std::vector<u64> atInfinity(stereographicInfinityMaskWordCount(endpoints.size()));
+		start = Clock::now();
+		for (const auto& view4 : views) {
+			stereographicProjection(view4, constView(endpoints), view(transformed), view(projected), view(atInfinity));
+			for (i64 i = 0; i < edgeCount; i++) {
+				if (isPointAtInfinity(constView(atInfinity), 2 * i) && isPointAtInfinity(constView(atInfinity), 2 * i + 1)) {
+					continue;
+				}
+				const auto segment = StereographicSegment::fromProjectedEndpoints(transformed[2 * i], transformed[2 * i + 1], projected[2 * i], projected[2 * i + 1]);
+				if (segment.type != StereographicSegment::Type::CIRCULAR) {
+					continue;
+				}
+				const auto& arc = segment.circular;
+				if (arc.angle < 0.01f || std::abs(arc.angle - TAU<f32>) < 0.01f) {
+					continue;
+				}
+				const auto count = circleArcPointCountRequiredToAchiveError(0.1f, arc.start.length(), arc.angle, 5);
+				if (count.has_value() && *count > 2) {
+					lines.addCircularArc(arc.start, arc.initialVelocity, arc.center, arc.angle, segmentWidth, *count);
+				}
+			}
+			lines.reset();
+		}
+		const auto cpuMs = millisecondsSince(start) / frameCount;
+		put("%: generating the tubes on the CPU % ms, instancing % ms (% times faster)", board.name, cpuMs, instancingMs, cpuMs / instancingMs);
+	}
+	return allMatch;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Compares the batch stereographic projection kernels against calling the scalar functions for each point and checks that the results and the infinity masks agree.
+bool stereographicProjectionBenchmark();
+// Compares StereographicSegment::fromProjectedEndpoints against fitting a circle though the projected endpoints and the antipodal point like Minesweeper did before, and measures computing the arcs and generating the tubes of the curved edges each frame.
+bool edgeArcsBenchmark();
+// Checks that the CPU copy of the instanced arc vertex shader from StereographicArc.hpp matches the tubes generated by LineGenerator and that only the arcs close to infinity fall back to the CPU, and measures the work left for the CPU when the arcs are instanced.
+bool edgeArcsInstancingBenchmark();
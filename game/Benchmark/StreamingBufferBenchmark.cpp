@@ -0,0 +1,161 @@
+#include "StreamingBufferBenchmark.hpp"
+#include <game/StreamingBuffer.hpp>
+#include <Put.hpp>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+// Has the same interface as Vbo and Ibo, but only records what the driver would have to do.
+struct MockBuffer {
+	void allocateData(const void* data, usize byteSize);
+	void setData(intptr_t offset, const void* data, usize byteSize);
+
+	usize size = 0;
+	// Calls to allocateData with a different size than the current storage.
+	i32 resizeCount = 0;
+	i32 uploadCount = 0;
+	usize bytesWritten = 0;
+	bool outOfBounds = false;
+};
+
+void MockBuffer::allocateData(const void* data, usize byteSize) {
+	if (byteSize != size) {
+		resizeCount++;
+	}
+	size = byteSize;
+	if (data != nullptr) {
+		uploadCount++;
+		bytesWritten += byteSize;
+	}
+}
+
+void MockBuffer::setData(intptr_t offset, const void* data, usize byteSize) {
+	if (offset < 0 || usize(offset) + byteSize > size) {
+		outOfBounds = true;
+	}
+	uploadCount++;
+	bytesWritten += byteSize;
+}
+
+// The sizes of the instances and vertices GameRenderer uploads. ColoredInstance is a Vec3 and a Mat4, Text3Instance is a Mat4, 2 Vec2s and a Vec3 and Vertex3Pn is 2 Vec3s.
+const usize coloredInstanceSize = 76;
+const usize text3InstanceSize = 92;
+const usize vertexSize = 24;
+const usize indexSize = 4;
+
+struct Frame {
+	i32 hemisphereCount;
+	i32 cyllinderCount;
+	i32 textCount;
+	i32 vertexCount;
+	i32 indexCount;
+};
+
+// What drawInstances does. Writes the instances into the start of the buffer in batches that fit.
+void drawInstancesInBatches(MockBuffer& buffer, const u8* instances, usize count, usize instanceSize) {
+	const auto maxPerDraw = buffer.size / instanceSize;
+	for (usize drawn = 0; drawn < count; drawn += maxPerDraw) {
+		const auto toDraw = std::min(maxPerDraw, count - drawn);
+		buffer.setData(0, instances + drawn * instanceSize, toDraw * instanceSize);
+	}
+}
+
+}
+
+bool streamingBufferBenchmark() {
+	// Something like moving the camera around one of the bigger boards. The number of cells and edges in view changes every frame.
+	const i32 frameCount = 1000;
+	std::mt19937 rng(0);
+	std::uniform_int_distribution<i32> cells(200, 600);
+	std::uniform_int_distribution<i32> lines(0, 300);
+	std::vector<Frame> frames;
+	for (i32 i = 0; i < frameCount; i++) {
+		const auto cellCount = cells(rng);
+		const auto lineCount = lines(rng);
+		const auto arcCount = lines(rng);
+		// Every arc has up to 5 rings of 10 vertices.
+		frames.push_back(Frame{
+			.hemisphereCount = 2 * cellCount + 2 * lineCount,
+			.cyllinderCount = lineCount,
+			.textCount = cellCount / 2,
+			.vertexCount = arcCount * 50,
+			.indexCount = arcCount * 4 * 10 * 6,
+		});
+	}
+	// The contents don't matter, only the pointers are passed.
+	std::vector<u8> data(1024 * 1024);
+
+	// Before
+	MockBuffer instancesBefore{ .size = 1024 * 20 };
+	MockBuffer verticesBefore;
+	MockBuffer indicesBefore;
+	for (const auto& frame : frames) {
+		drawInstancesInBatches(instancesBefore, data.data(), frame.hemisphereCount, coloredInstanceSize);
+		drawInstancesInBatches(instancesBefore, data.data(), frame.cyllinderCount, coloredInstanceSize);
+		if (frame.vertexCount > 0) {
+			verticesBefore.allocateData(data.data(), frame.vertexCount * vertexSize);
+			indicesBefore.allocateData(data.data(), frame.indexCount * indexSize);
+			drawInstancesInBatches(instancesBefore, data.data(), 1, coloredInstanceSize);
+		}
+		drawInstancesInBatches(instancesBefore, data.data(), frame.textCount, text3InstanceSize);
+	}
+
+	// Now
+	StreamingBuffer<MockBuffer> instances{ .buffer = MockBuffer{ .size = 1024 * 20 }, .capacity = 1024 * 20 };
+	StreamingBuffer<MockBuffer> vertices;
+	StreamingBuffer<MockBuffer> indices;
+	bool countersMatch = true;
+	i32 uploadCount = 0;
+	i32 growCount = 0;
+	usize maxBytesPerFrame = 0;
+	for (const auto& frame : frames) {
+		instances.write(data.data(), frame.hemisphereCount * coloredInstanceSize);
+		instances.write(data.data(), frame.cyllinderCount * coloredInstanceSize);
+		if (frame.vertexCount > 0) {
+			vertices.write(data.data(), frame.vertexCount * vertexSize);
+			indices.write(data.data(), frame.indexCount * indexSize);
+			instances.write(data.data(), coloredInstanceSize);
+		}
+		instances.write(data.data(), frame.textCount * text3InstanceSize);
+
+		const auto expectedBytes =
+			(frame.hemisphereCount + frame.cyllinderCount + (frame.vertexCount > 0 ? 1 : 0)) * coloredInstanceSize +
+			frame.textCount * text3InstanceSize +
+			frame.vertexCount * vertexSize +
+			frame.indexCount * indexSize;
+		// What GameRenderer::frameUpdate does.
+		const auto bytesUploaded = instances.bytesUploaded + vertices.bytesUploaded + indices.bytesUploaded;
+		if (bytesUploaded != expectedBytes) {
+			countersMatch = false;
+		}
+		maxBytesPerFrame = std::max(maxBytesPerFrame, bytesUploaded);
+		for (auto buffer : { &instances, &vertices, &indices }) {
+			uploadCount += buffer->writeCount;
+			growCount += buffer->growCount;
+			buffer->resetCounters();
+		}
+	}
+	const auto bytesWritten = instances.buffer.bytesWritten + vertices.buffer.bytesWritten + indices.buffer.bytesWritten;
+	const auto bytesWrittenBefore = instancesBefore.bytesWritten + verticesBefore.bytesWritten + indicesBefore.bytesWritten;
+	const auto outOfBounds = instances.buffer.outOfBounds || vertices.buffer.outOfBounds || indices.buffer.outOfBounds;
+
+	put("% frames, up to % bytes uploaded per frame, % bytes in total before, % now",
+		frameCount,
+		maxBytesPerFrame,
+		bytesWrittenBefore,
+		bytesWritten);
+	put("uploads: before % (% per frame), now % (% per frame)",
+		instancesBefore.uploadCount + verticesBefore.uploadCount + indicesBefore.uploadCount,
+		f64(instancesBefore.uploadCount + verticesBefore.uploadCount + indicesBefore.uploadCount) / frameCount,
+		uploadCount,
+		f64(uploadCount) / frameCount);
+	// The orphaning allocateData calls with the same size are not counted, because the driver can reuse the storage.
+	put("storage size changes: before %, now %",
+		verticesBefore.resizeCount + indicesBefore.resizeCount,
+		instances.buffer.resizeCount + vertices.buffer.resizeCount + indices.buffer.resizeCount);
+	const auto matches = countersMatch && !outOfBounds && bytesWritten == bytesWrittenBefore;
+	put("%", matches ? "matches" : "MISMATCH");
+	return matches;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// Replays the uploads of a sequence of frames of GameRenderer into mock buffers, the way it did before with drawInstances and allocateData and with StreamingBuffer. Checks that the per frame byte counters match the data written and compares the number of uploads and storage reallocations.
+bool streamingBufferBenchmark();
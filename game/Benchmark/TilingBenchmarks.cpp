@@ -0,0 +1,547 @@
+#include "TilingBenchmarks.hpp"
+#include <game/Tiling.hpp>
+#include <game/Benchmark/AllocationCounter.hpp>
+#include <game/TilingFile.hpp>
+#include <game/TilingCache.hpp>
+#include <game/TilingVisibility.hpp>
+#include <game/CellPicking.hpp>
+#include <game/Stereographic.hpp>
+#include <game/Benchmark/PhysicsBenchmarks.hpp>
+#include <engine/Math/GramSchmidt.hpp>
+#include <filesystem>
+#include <Put.hpp>
+#include <game/Clock.hpp>
+#include <algorithm>
+#include <string>
+#include <sstream>
+#include <array>
+#include <limits>
+
+// Tiling::cellsNeighbouringToCell before it used the vertex to cells index.
+static std::vector<std::vector<i32>> cellsNeighbouringToCellAllPairs(const Tiling& tiling) {
+	std::vector<std::vector<i32>> r;
+	r.resize(tiling.cellCount());
+	for (i32 cellI = 0; cellI < tiling.cellCount(); cellI++) {
+		for (i32 cellJ = cellI + 1; cellJ < tiling.cellCount(); cellJ++) {
+			const auto vI = tiling.verticesOfCell(cellI);
+			const auto vJ = tiling.verticesOfCell(cellJ);
+			const auto haveCommonVertex = std::ranges::any_of(vI, [&](i32 v) { return std::binary_search(vJ.begin(), vJ.end(), v); });
+			if (haveCommonVertex) {
+				r[cellI].push_back(cellJ);
+				r[cellJ].push_back(cellI);
+			}
+		}
+	}
+	return r;
+}
+
+bool tilingAdjacencyBenchmark() {
+	struct Board {
+		const char* name;
+		Polytope (*make)();
+	};
+	const Board boards[]{
+		{ "120-cell", make120cell },
+		{ "600-cell", make600cell },
+		{ "rectified 600-cell", makeRectified600cell },
+		{ "snub 24-cell", makeSnub24cell },
+		{ "subdivided hypercube 4", [] { return subdiviedHypercube4(4); } },
+		{ "subdivided hypercube 8", [] { return subdiviedHypercube4(8); } },
+	};
+	bool allMatch = true;
+	for (const auto& board : boards) {
+		const Tiling tiling(board.make());
+
+		auto start = Clock::now();
+		const auto adjacency = tiling.cellsSharingVertex();
+		const auto vertexMs = millisecondsSince(start);
+
+		start = Clock::now();
+		const auto faceAdjacency = tiling.cellsSharingFace();
+		const auto faceMs = millisecondsSince(start);
+
+		// Quadratic so it's skipped for the large tilings.
+		const auto runAllPairs = tiling.cellCount() <= 5000;
+		f64 allPairsMs = 0.0;
+		bool matches = true;
+		if (runAllPairs) {
+			start = Clock::now();
+			const auto reference = cellsNeighbouringToCellAllPairs(tiling);
+			allPairsMs = millisecondsSince(start);
+			for (i32 i = 0; i < tiling.cellCount(); i++) {
+				const auto neighbours = adjacency[i];
+				if (!std::ranges::equal(neighbours, reference[i])) {
+					matches = false;
+				}
+			}
+		}
+
+		allMatch = allMatch && matches;
+		put("%: % cells, vertex adjacency % ms (% neighbours), face adjacency % ms (% neighbours), all pairs % ms, %",
+			board.name,
+			tiling.cellCount(),
+			vertexMs,
+			adjacency.neighbours.size(),
+			faceMs,
+			faceAdjacency.neighbours.size(),
+			runAllPairs ? allPairsMs : -1.0,
+			!runAllPairs ? "not compared" : matches ? "matches" : "MISMATCH");
+	}
+	return allMatch;
+}
+
+bool boardLoadingBenchmark() {
+	// The same boards as Minesweeper::Board.
+	struct Board {
+		const char* name;
+		const char* fileName;
+		Polytope (*make)();
+		FlatPolytope4 (*makeFlat)();
+	};
+	const Board boards[]{
+		{ "snub 24-cell", "snub24cell.tiling", makeSnub24cell, makeFlatSnub24cell },
+		{ "120-cell", "120cell.tiling", make120cell, makeFlat120cell },
+		{ "subdivided hypercube", "subdiviedHypercube.tiling", makeSubdiviedHypercube2, makeFlatSubdiviedHypercube2 },
+		{ "600-cell", "600cell.tiling", make600cell, makeFlat600cell },
+		{ "rectified 600-cell", "rectified600cell.tiling", makeRectified600cell, makeFlatRectified600cell },
+	};
+	const i32 repetitions = 20;
+
+	struct Measurement {
+		f64 ms = 0.0;
+		i64 allocationCount = 0;
+		i64 allocatedBytes = 0;
+	};
+	// The load function has to create the tiling and the cell adjacency like Minesweeper::loadBoard.
+	auto measure = [&](auto load) {
+		Measurement result;
+		for (i32 i = 0; i < repetitions; i++) {
+			const AllocationScope allocations;
+			const auto start = Clock::now();
+			load();
+			result.ms += millisecondsSince(start);
+			result.allocationCount = allocations.count();
+			result.allocatedBytes = allocations.bytes();
+		}
+		result.ms /= repetitions;
+		return result;
+	};
+	auto measurementToString = [](const Measurement& m) {
+		std::stringstream result;
+		put(result, "% ms, % allocations, % bytes", m.ms, m.allocationCount, m.allocatedBytes);
+		return result.str();
+	};
+
+	for (const auto& board : boards) {
+		const auto polytope = measure([&] {
+			const Tiling tiling(board.make());
+			return tiling.cellsSharingVertex();
+		});
+		const auto flat = measure([&] {
+			const Tiling tiling(board.makeFlat());
+			return tiling.cellsSharingVertex();
+		});
+		const auto path = std::string(TILING_FILES_DIRECTORY) + board.fileName;
+		bool loadedFile = true;
+		const auto file = measure([&] {
+			loadedFile = loadTilingFile(path.c_str()).has_value() && loadedFile;
+		});
+		put("%: polytope %; flat %; file %",
+			board.name,
+			measurementToString(polytope),
+			measurementToString(flat),
+			loadedFile ? measurementToString(file) : "failed to load " + path);
+	}
+	return true;
+}
+
+// removedDuplicates before it used weldedVertexIndices.
+static std::vector<i32> weldedVertexIndicesQuadratic(const std::vector<Polytope::PointN>& vertices, f32 maxSquaredDistance) {
+	std::vector<i32> oldToNew;
+	std::vector<i32> keptVertices;
+	for (i32 vertexI = 0; vertexI < i32(vertices.size()); vertexI++) {
+		const auto& vertex = vertices[vertexI];
+		bool alreadyAdded = false;
+		for (i32 keptI = 0; keptI < i32(keptVertices.size()); keptI++) {
+			const auto& kept = vertices[keptVertices[keptI]];
+			f32 squaredDistance = 0.0f;
+			for (i32 i = 0; i < i32(vertex.size()); i++) {
+				squaredDistance += (vertex[i] - kept[i]) * (vertex[i] - kept[i]);
+			}
+			if (squaredDistance < maxSquaredDistance) {
+				oldToNew.push_back(keptI);
+				alreadyAdded = true;
+				break;
+			}
+		}
+		if (!alreadyAdded) {
+			oldToNew.push_back(i32(keptVertices.size()));
+			keptVertices.push_back(vertexI);
+		}
+	}
+	return oldToNew;
+}
+
+bool vertexWeldingBenchmark() {
+	bool allMatch = true;
+	for (i32 divisionCount = 2; divisionCount <= 8; divisionCount++) {
+		const auto polytope = subdiviedHypercube4WithDuplicates(divisionCount);
+
+		auto start = Clock::now();
+		const auto hashed = weldedVertexIndices(polytope.vertices, 0.01f);
+		const auto hashedMs = millisecondsSince(start);
+
+		start = Clock::now();
+		const auto quadratic = weldedVertexIndicesQuadratic(polytope.vertices, 0.01f);
+		const auto quadraticMs = millisecondsSince(start);
+
+		start = Clock::now();
+		const auto welded = subdiviedHypercube4(divisionCount);
+		const auto totalMs = millisecondsSince(start);
+
+		const auto matches = hashed == quadratic;
+		allMatch = allMatch && matches;
+		put("divisions %: % vertices welded into %, hashed % ms, quadratic % ms, %, whole subdiviedHypercube4 % ms",
+			divisionCount,
+			polytope.vertices.size(),
+			welded.vertices.size(),
+			hashedMs,
+			quadraticMs,
+			matches ? "matches" : "MISMATCH",
+			totalMs);
+	}
+	return allMatch;
+}
+
+bool tilingCacheBenchmark() {
+	struct Generator {
+		const char* name;
+		u64 key;
+		Polytope (*generate)();
+	};
+	const Generator generators[]{
+		{ "5-cell", TilingCache::key("make5cell"), make5cell },
+		{ "24-cell", TilingCache::key("make24cell"), make24cell },
+		{ "600-cell", TilingCache::key("generate600cell"), generate600cell },
+		{ "120-cell", TilingCache::key("generate120cell"), generate120cell },
+		{ "subdivided hypercube 8", TilingCache::key("subdiviedHypercube4", i32(8)), [] { return subdiviedHypercube4(8); } },
+	};
+	TilingCache cache("./benchmarkTilingCache/");
+	std::error_code error;
+	std::filesystem::remove_all(cache.directory, error);
+	bool allMatch = true;
+
+	for (const auto& generator : generators) {
+		auto start = Clock::now();
+		const auto cold = cache.get(generator.key, generator.generate);
+		const auto coldMs = millisecondsSince(start);
+
+		start = Clock::now();
+		const auto warm = cache.get(generator.key, generator.generate);
+		const auto warmMs = millisecondsSince(start);
+
+		const auto matches =
+			cold.tiling.cellCount() == warm.tiling.cellCount() &&
+			cold.tiling.cellFaceNormals == warm.tiling.cellFaceNormals &&
+			cold.cellsSharingVertex.neighbours == warm.cellsSharingVertex.neighbours;
+		allMatch = allMatch && matches;
+		put("%: % cells, cold % ms, warm % ms, %",
+			generator.name,
+			warm.tiling.cellCount(),
+			coldMs,
+			warmMs,
+			matches ? "matches" : "MISMATCH");
+	}
+	put("% hits, % misses", cache.hitCount, cache.missCount);
+	std::filesystem::remove_all(cache.directory, error);
+	return allMatch;
+}
+
+bool convexHullBenchmark() {
+	struct Generator {
+		const char* name;
+		Polytope (*generate)();
+	};
+	const Generator generators[]{
+		{ "24-cell", make24cell },
+		{ "snub 24-cell", generateSnub24cell },
+		{ "600-cell", generate600cell },
+		{ "120-cell", generate120cell },
+		{ "rectified 600-cell", generateRectified600cell },
+	};
+	for (const auto& generator : generators) {
+		const auto start = Clock::now();
+		const auto polytope = generator.generate();
+		const auto ms = millisecondsSince(start);
+		put("%: % cells, % faces, % edges, % ms",
+			generator.name,
+			polytope.cellsOfDimension(3).size(),
+			polytope.cellsOfDimension(2).size(),
+			polytope.cellsOfDimension(1).size(),
+			ms);
+	}
+	return true;
+}
+
+// The elements with bounding caps overlapping the cap. The same condition as the clustered query, but tests every element.
+static void overlappingBruteForce(const std::vector<SphereCap>& caps, const SphereCap& view, std::vector<i32>& result) {
+	result.clear();
+	for (i32 i = 0; i < i32(caps.size()); i++) {
+		if (capsOverlap(view, caps[i])) {
+			result.push_back(i);
+		}
+	}
+}
+
+// The cell whose face hyperplanes the point is furthest inside of. A point on a face is inside of both cells sharing it, so this always returns one of them.
+static CellIndex cellContaining(const Tiling& tiling, Vec4 point) {
+	CellIndex result = 0;
+	f32 resultMaxDot = std::numeric_limits<f32>::infinity();
+	for (CellIndex cell = 0; cell < tiling.cellCount(); cell++) {
+		f32 maxDot = -std::numeric_limits<f32>::infinity();
+		for (const auto& normal : tiling.faceNormalsOfCell(cell)) {
+			maxDot = std::max(maxDot, dot(normal, point));
+		}
+		if (maxDot < resultMaxDot) {
+			result = cell;
+			resultMaxDot = maxDot;
+		}
+	}
+	return result;
+}
+
+bool largeBoardBenchmark() {
+	// The subdivided hypercube with n divisions has 8 (n + 1)^3 cells.
+	const i32 divisionCounts[]{ 2, 5, 10, 15, 22 };
+	const i32 frameCount = 200;
+	TilingCache cache;
+	bool allMatch = true;
+
+	for (const auto& divisionCount : divisionCounts) {
+		auto start = Clock::now();
+		const auto loaded = cache.get(TilingCache::key("subdiviedHypercube4", divisionCount), [&] {
+			return subdiviedHypercube4(divisionCount);
+		});
+		const auto loadMs = millisecondsSince(start);
+		const auto& tiling = loaded.tiling;
+
+		// The boundary of the 4 dimensional cube with n + 1 segments on each edge.
+		const auto segmentCount = i64(divisionCount + 1);
+		const auto expectedVertexCount = pow(segmentCount + 1, 4) - pow(segmentCount - 1, 4);
+		const auto expectedCellCount = 8 * segmentCount * segmentCount * segmentCount;
+		const auto weldedCorrectly =
+			i64(tiling.vertices.size()) == i64(expectedVertexCount) &&
+			i64(tiling.cellCount()) == expectedCellCount;
+
+		start = Clock::now();
+		TilingVisibility visibility;
+		visibility.build(tiling, MAX_VISIBLE_CELL_COUNT);
+		const auto buildMs = millisecondsSince(start);
+
+		// Moving the camera the same way for both versions. The columns of the inverse view matrix like in cellPickingBenchmark.
+		std::mt19937 rng(0);
+		std::vector<std::array<Vec4, 4>> cameras;
+		for (i32 i = 0; i < frameCount; i++) {
+			std::array<Vec4, 4> basis;
+			for (auto& v : basis) {
+				v = randomPointOnSphere(rng);
+			}
+			gramSchmidtOrthonormalize(View<Vec4>(basis.data(), basis.size()));
+			cameras.push_back(basis);
+		}
+
+		const auto cellCaps = cellBoundingCaps(tiling);
+		const auto edgeCaps = edgeBoundingCaps(tiling);
+		std::vector<i32> bruteForceCells, bruteForceEdges;
+		i64 visibleCellSum = 0;
+		bool matches = true;
+		i32 cameraCellNotVisibleCount = 0;
+		f64 queryMs = 0.0;
+		f64 bruteForceMs = 0.0;
+		for (const auto& basis : cameras) {
+			// The point Minesweeper passes to the query. It's the one projected to the origin, where the camera is, and not pos4(), which is projected to infinity.
+			const auto cameraPosition = -basis[3];
+			const auto cameraView = Vec4(dot(basis[0], cameraPosition), dot(basis[1], cameraPosition), dot(basis[2], cameraPosition), dot(basis[3], cameraPosition));
+			matches = matches && stereographicProjection(cameraView).length() < 0.0001f;
+
+			start = Clock::now();
+			visibility.query(cameraPosition);
+			queryMs += millisecondsSince(start);
+			visibleCellSum += visibility.visibleCells.size();
+
+			// The cell the camera is in has to be drawn.
+			const auto cameraCell = cellContaining(tiling, cameraPosition);
+			if (std::ranges::find(visibility.visibleCells, cameraCell) == visibility.visibleCells.end()) {
+				cameraCellNotVisibleCount++;
+			}
+
+			if (visibility.everythingVisible()) {
+				continue;
+			}
+			start = Clock::now();
+			const SphereCap view{ .center = cameraPosition, .angularRadius = visibility.drawDistance };
+			overlappingBruteForce(cellCaps, view, bruteForceCells);
+			overlappingBruteForce(edgeCaps, view, bruteForceEdges);
+			bruteForceMs += millisecondsSince(start);
+
+			auto cells = visibility.visibleCells;
+			auto edges = visibility.visibleEdges;
+			std::ranges::sort(cells);
+			std::ranges::sort(edges);
+			matches = matches && cells == bruteForceCells && edges == bruteForceEdges;
+		}
+
+		matches = matches && cameraCellNotVisibleCount == 0;
+		allMatch = allMatch && matches && weldedCorrectly;
+		put("% cells, % edges: load % ms, % (%), build % ms, draw distance %, % visible cells, camera cell not visible in % frames, query % ms, brute force % ms per frame, %",
+			tiling.cellCount(),
+			tiling.edges.size(),
+			loadMs,
+			weldedCorrectly ? "welded correctly" : "WRONG VERTEX COUNT",
+			cache.hitCount > 0 ? "cached" : "generated",
+			buildMs,
+			visibility.drawDistance,
+			visibleCellSum / frameCount,
+			cameraCellNotVisibleCount,
+			queryMs / frameCount,
+			bruteForceMs / frameCount,
+			matches ? "matches" : "MISMATCH");
+		cache.hitCount = 0;
+	}
+	return allMatch;
+}
+
+namespace {
+
+struct PickingHit {
+	CellIndex cell;
+	f32 t;
+
+	bool operator==(const PickingHit&) const = default;
+};
+
+}
+
+// The same test as the picking in Minesweeper::update. The view space camera is at the origin looking along the z axis.
+static void closestPickingHit(std::optional<PickingHit>& closest, const Vec3& center, f32 sphereRadius, CellIndex cell) {
+	const auto t = raySphereIntersection(Ray3(Vec3(0.0f), Vec3(0.0f, 0.0f, 1.0f)), center, sphereRadius);
+	if (t.has_value() && (!closest.has_value() || *t < closest->t)) {
+		closest = PickingHit{ .cell = cell, .t = *t };
+	}
+}
+
+bool cellPickingBenchmark() {
+	const i32 divisionCounts[]{ 2, 5, 10, 15, 22 };
+	const i32 frameCount = 500;
+	TilingCache cache;
+	bool allMatch = true;
+
+	for (const auto& divisionCount : divisionCounts) {
+		const auto loaded = cache.get(TilingCache::key("subdiviedHypercube4", divisionCount), [&] {
+			return subdiviedHypercube4(divisionCount);
+		});
+		const auto& tiling = loaded.tiling;
+
+		TilingVisibility visibility;
+		visibility.build(tiling, MAX_VISIBLE_CELL_COUNT);
+		auto start = Clock::now();
+		CellPicking picking;
+		picking.build(tiling, visibility);
+		const auto buildMs = millisecondsSince(start);
+
+		// The sphere radius used by Minesweeper.
+		f32 diameter = 0.0f;
+		const auto vertices = tiling.verticesOfCell(0);
+		for (i32 i = 0; i < vertices.size(); i++) {
+			for (i32 j = i + 1; j < vertices.size(); j++) {
+				diameter = std::max(diameter, (tiling.vertices[vertices[i]] - tiling.vertices[vertices[j]]).length());
+			}
+		}
+		const auto sphereRadius = 0.1f * (diameter / 0.756f) / 2.5f;
+		const auto maxAngularDistance = CellPicking::maxAngularDistanceForSphereRadius(sphereRadius);
+
+		// The columns of the inverse view matrix. The view matrix is the transpose.
+		std::mt19937 rng(0);
+		std::vector<std::array<Vec4, 4>> cameras;
+		for (i32 i = 0; i < frameCount; i++) {
+			std::array<Vec4, 4> basis;
+			for (auto& v : basis) {
+				v = randomPointOnSphere(rng);
+			}
+			gramSchmidtOrthonormalize(View<Vec4>(basis.data(), basis.size()));
+			cameras.push_back(basis);
+		}
+		auto project = [&](const std::array<Vec4, 4>& basis, Vec4 p) {
+			return stereographicProjection(Vec4(dot(basis[0], p), dot(basis[1], p), dot(basis[2], p), dot(basis[3], p)));
+		};
+
+		std::vector<Vec3> projectedCenters(tiling.cellCount());
+		std::vector<CellIndex> candidates;
+		i32 hitCount = 0;
+		i64 candidateSum = 0;
+		bool matches = true;
+		f64 allCellsMs = 0.0;
+		f64 visibleCellsMs = 0.0;
+		f64 pickingMs = 0.0;
+		for (const auto& basis : cameras) {
+			const auto camera = -basis[3];
+			const auto forward = basis[2];
+
+			// What Minesweeper did before it only looked at the visible cells.
+			start = Clock::now();
+			std::optional<PickingHit> allCellsHit;
+			for (CellIndex cell = 0; cell < tiling.cellCount(); cell++) {
+				closestPickingHit(allCellsHit, project(basis, tiling.cellCentroids[cell]), sphereRadius, cell);
+			}
+			allCellsMs += millisecondsSince(start);
+
+			// The projection of the visible cells is needed for drawing anyway so it isn't timed.
+			visibility.query(camera);
+			for (const auto& cell : visibility.visibleCells) {
+				projectedCenters[cell] = project(basis, tiling.cellCentroids[cell]);
+			}
+
+			start = Clock::now();
+			std::optional<PickingHit> visibleCellsHit;
+			for (const auto& cell : visibility.visibleCells) {
+				closestPickingHit(visibleCellsHit, projectedCenters[cell], sphereRadius, cell);
+			}
+			visibleCellsMs += millisecondsSince(start);
+
+			start = Clock::now();
+			candidates.clear();
+			picking.query(camera, forward, maxAngularDistance, candidates);
+			std::optional<PickingHit> pickingHit;
+			for (const auto& cell : candidates) {
+				closestPickingHit(pickingHit, projectedCenters[cell], sphereRadius, cell);
+			}
+			pickingMs += millisecondsSince(start);
+			candidateSum += candidates.size();
+
+			// Every hit cell has to be a candidate, not only the closest one.
+			std::ranges::sort(candidates);
+			for (const auto& cell : visibility.visibleCells) {
+				const auto t = raySphereIntersection(Ray3(Vec3(0.0f), Vec3(0.0f, 0.0f, 1.0f)), projectedCenters[cell], sphereRadius);
+				if (t.has_value() && !std::ranges::binary_search(candidates, cell)) {
+					matches = false;
+				}
+			}
+			matches = matches && pickingHit == visibleCellsHit;
+			if (pickingHit.has_value()) {
+				hitCount++;
+			}
+		}
+
+		allMatch = allMatch && matches;
+		put("% cells: build % ms, % frames with a hit, % candidates, all cells % ms, visible cells % ms, tree % ms per pick, %",
+			tiling.cellCount(),
+			buildMs,
+			hitCount,
+			f64(candidateSum) / frameCount,
+			allCellsMs / frameCount,
+			visibleCellsMs / frameCount,
+			pickingMs / frameCount,
+			matches ? "matches" : "MISMATCH");
+	}
+	return allMatch;
+}
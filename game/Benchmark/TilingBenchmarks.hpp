@@ -0,0 +1,16 @@
+#pragma once
+
+// Compares the cell adjacency built from the vertex to cells index against the old loop over every pair of cells for the boards and for subdivided hypercubes.
+bool tilingAdjacencyBenchmark();
+// Loads each Minesweeper board through the Polytope representation and through FlatPolytope4 and compares the time and the number of allocations.
+bool boardLoadingBenchmark();
+// Compares the hashed vertex welding against checking every kept vertex on the subdivided hypercubes.
+bool vertexWeldingBenchmark();
+// Generates the tilings created using the convex hull with an empty cache and then loads them from the cache.
+bool tilingCacheBenchmark();
+// Times generating the polytopes using the convex hull.
+bool convexHullBenchmark();
+// Generates subdivided hypercubes with up to 100k cells and compares finding the cells near the camera using the clusters against checking every cell. Also checks that the cell containing the camera is always found.
+bool largeBoardBenchmark();
+// Compares finding the cell under the cursor using CellPicking against testing every cell and every visible cell on subdivided hypercubes with up to 100k cells.
+bool cellPickingBenchmark();
@@ -0,0 +1,64 @@
+#include <game/Benchmark/PhysicsBenchmarks.hpp>
+#include <game/Benchmark/PhysicsReplay.hpp>
+#include <game/Benchmark/EntityArrayBenchmark.hpp>
+#include <game/Benchmark/TilingBenchmarks.hpp>
+#include <game/Benchmark/FrameArenaBenchmark.hpp>
+#include <game/Benchmark/MinesweeperBoardBenchmark.hpp>
+#include <game/Benchmark/StereographicBenchmark.hpp>
+#include <game/Benchmark/StreamingBufferBenchmark.hpp>
+#include <string_view>
+#include <Put.hpp>
+
+struct Benchmark {
+	const char* name;
+	// Returns false if any of the checks failed. The benchmarks that only measure always return true.
+	bool (*run)();
+};
+
+static const Benchmark benchmarks[]{
+	{ "broadPhase", broadPhaseBenchmark },
+	{ "integration", integrationBenchmark },
+	{ "solver", solverBenchmark },
+	{ "sleeping", sleepingBenchmark },
+	{ "physicsReplay", physicsReplayBenchmark },
+	{ "continuousCollision", continuousCollisionBenchmark },
+	{ "wallMesh", wallMeshBenchmark },
+	{ "fixedTimestep", fixedTimestepBenchmark },
+	{ "entityArray", entityArrayBenchmark },
+	{ "tilingAdjacency", tilingAdjacencyBenchmark },
+	{ "boardLoading", boardLoadingBenchmark },
+	{ "vertexWelding", vertexWeldingBenchmark },
+	{ "tilingCache", tilingCacheBenchmark },
+	{ "convexHull", convexHullBenchmark },
+	{ "largeBoard", largeBoardBenchmark },
+	{ "frameArena", frameArenaBenchmark },
+	{ "minesweeperReveal", minesweeperRevealBenchmark },
+	{ "cellPicking", cellPickingBenchmark },
+	{ "stereographicProjection", stereographicProjectionBenchmark },
+	{ "edgeArcs", edgeArcsBenchmark },
+	{ "edgeArcsInstancing", edgeArcsInstancingBenchmark },
+	{ "streamingBuffer", streamingBufferBenchmark },
+};
+
+// Runs without creating a window or a graphics context.
+// Usage: benchmark [name...]. Without arguments runs every benchmark. Returns 1 if any of the checks failed, so it can be used in scripts.
+int main(int argc, char** argv) {
+	bool allPassed = true;
+	for (const auto& benchmark : benchmarks) {
+		bool selected = argc <= 1;
+		for (i32 i = 1; i < argc; i++) {
+			if (std::string_view(argv[i]) == benchmark.name) {
+				selected = true;
+			}
+		}
+		if (!selected) {
+			continue;
+		}
+		put("%:", benchmark.name);
+		if (!benchmark.run()) {
+			put("% FAILED", benchmark.name);
+			allPassed = false;
+		}
+	}
+	return allPassed ? 0 : 1;
+}
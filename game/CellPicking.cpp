@@ -0,0 +1,139 @@
+#include "CellPicking.hpp"
+#include <game/4d.hpp>
+#include <engine/Math/Angles.hpp>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+// Added to the radii of the nodes and to the compared squared distances so that the rounding errors don't make the tests reject cells that should be candidates.
+static constexpr f32 ANGLE_SLACK = 0.001f;
+static constexpr f32 DISTANCE_SQUARED_SLACK = 0.00001f;
+
+void CellPicking::build(const Tiling& tiling, const TilingVisibility& visibility) {
+	const auto cellCaps = cellBoundingCaps(tiling);
+	nodes.clear();
+	elementCells.resize(tiling.cellCount());
+	std::iota(elementCells.begin(), elementCells.end(), 0);
+	if (tiling.cellCount() > 0) {
+		buildNode(cellCaps, visibility.drawDistance, 0, tiling.cellCount());
+	}
+
+	elementCenters.clear();
+	elementMinVisibleCosines.clear();
+	for (const auto& cell : elementCells) {
+		elementCenters.push_back(cellCaps[cell].center);
+		elementMinVisibleCosines.push_back(minVisibleCosine(visibility.drawDistance, cellCaps[cell].angularRadius));
+	}
+}
+
+void CellPicking::buildNode(const std::vector<SphereCap>& cellCaps, f32 drawDistance, i32 begin, i32 end) {
+	const auto nodeI = i32(nodes.size());
+	nodes.push_back(Node{});
+
+	Vec4 center(0.0f);
+	for (i32 i = begin; i < end; i++) {
+		center += cellCaps[elementCells[i]].center;
+	}
+	// The root node contains the whole sphere so the sum can be close to zero. Any center works then.
+	center = center.length() < 0.0001f ? cellCaps[elementCells[begin]].center : center.normalized();
+
+	f32 centersRadius = 0.0f;
+	f32 cellsRadius = 0.0f;
+	for (i32 i = begin; i < end; i++) {
+		const auto& cap = cellCaps[elementCells[i]];
+		const auto distance = sphereAngularDistance(center, cap.center);
+		centersRadius = std::max(centersRadius, distance);
+		cellsRadius = std::max(cellsRadius, distance + cap.angularRadius);
+	}
+	centersRadius = std::min(centersRadius + ANGLE_SLACK, PI<f32>);
+
+	{
+		auto& node = nodes[nodeI];
+		node.center = center;
+		node.radiusCos = cos(centersRadius);
+		node.radiusSin = sin(centersRadius);
+		node.minVisibleCosine = minVisibleCosine(drawDistance, cellsRadius + ANGLE_SLACK);
+		node.elementsBegin = begin;
+		node.elementsEnd = end;
+	}
+
+	if (end - begin > MAX_LEAF_SIZE) {
+		Vec4 min(std::numeric_limits<f32>::infinity());
+		Vec4 max(-std::numeric_limits<f32>::infinity());
+		for (i32 i = begin; i < end; i++) {
+			const auto& c = cellCaps[elementCells[i]].center;
+			for (i32 axis = 0; axis < 4; axis++) {
+				min.data()[axis] = std::min(min.data()[axis], c.data()[axis]);
+				max.data()[axis] = std::max(max.data()[axis], c.data()[axis]);
+			}
+		}
+		i32 splitAxis = 0;
+		for (i32 axis = 1; axis < 4; axis++) {
+			if (max.data()[axis] - min.data()[axis] > max.data()[splitAxis] - min.data()[splitAxis]) {
+				splitAxis = axis;
+			}
+		}
+
+		const auto middle = begin + (end - begin) / 2;
+		std::nth_element(elementCells.begin() + begin, elementCells.begin() + middle, elementCells.begin() + end, [&](CellIndex a, CellIndex b) {
+			return cellCaps[a].center.data()[splitAxis] < cellCaps[b].center.data()[splitAxis];
+		});
+		buildNode(cellCaps, drawDistance, begin, middle);
+		buildNode(cellCaps, drawDistance, middle, end);
+		nodes[nodeI].elementsBegin = 0;
+		nodes[nodeI].elementsEnd = 0;
+	}
+	nodes[nodeI].skip = i32(nodes.size());
+}
+
+void CellPicking::query(Vec4 camera, Vec4 forward, f32 maxAngularDistance, std::vector<CellIndex>& candidates) const {
+	const auto maxSin = sin(maxAngularDistance);
+	const auto maxCos = cos(maxAngularDistance);
+	// For unit vectors this is the squared sine of the angle between the vector and the great circle.
+	auto distanceSquaredFromCircle = [&](Vec4 p) {
+		const auto a = dot(p, camera);
+		const auto b = dot(p, forward);
+		return dot(p, p) - a * a - b * b;
+	};
+	const auto maxElementDistanceSquared = maxSin * maxSin + DISTANCE_SQUARED_SLACK;
+
+	i32 nodeI = 0;
+	while (nodeI < i32(nodes.size())) {
+		const auto& node = nodes[nodeI];
+		if (dot(camera, node.center) < node.minVisibleCosine) {
+			nodeI = node.skip;
+			continue;
+		}
+		// The sine and cosine of maxAngularDistance + the node radius.
+		const auto sumSin = maxSin * node.radiusCos + maxCos * node.radiusSin;
+		const auto sumCos = maxCos * node.radiusCos - maxSin * node.radiusSin;
+		// If the sum is at least pi / 2 every point is close enough.
+		if (sumCos > 0.0f && distanceSquaredFromCircle(node.center) > sumSin * sumSin + DISTANCE_SQUARED_SLACK) {
+			nodeI = node.skip;
+			continue;
+		}
+		if (node.elementsBegin == node.elementsEnd) {
+			nodeI++;
+			continue;
+		}
+
+		for (i32 i = node.elementsBegin; i < node.elementsEnd; i++) {
+			if (dot(camera, elementCenters[i]) < elementMinVisibleCosines[i]) {
+				continue;
+			}
+			if (distanceSquaredFromCircle(elementCenters[i]) > maxElementDistanceSquared) {
+				continue;
+			}
+			candidates.push_back(elementCells[i]);
+		}
+		nodeI = node.skip;
+	}
+}
+
+f32 CellPicking::maxAngularDistanceForSphereRadius(f32 sphereRadius) {
+	const auto maxSin = 2.0f * sphereRadius;
+	if (maxSin >= 1.0f) {
+		return PI<f32> / 2.0f;
+	}
+	return asin(maxSin);
+}
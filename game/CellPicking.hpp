@@ -0,0 +1,50 @@
+#pragma once
+
+#include <game/TilingVisibility.hpp>
+
+/*
+Finds the cells that the camera ray might hit without projecting every cell.
+
+The ray goes from the camera forward along the z axis. The camera is at the origin of the projected space, which is the preimage of the origin, the antipode of the point projected to infinity. The inverse stereographic projection maps lines through the origin to great circles through the camera, so the ray is half of the great circle going through the camera in the forward direction.
+
+A cell is hit if its projected center is at most r away from the ray. If in view space the center is (x, y, z, w) then the projected center is (x, y, z) / (1 - w) and its distance from the z axis is sqrt(x^2 + y^2) / (1 - w). 1 - w is at most 2 so the hit cells satisfy sqrt(x^2 + y^2) <= 2r. sqrt(x^2 + y^2) is the sine of the angle between the center and the great circle, which doesn't depend on the camera transformation except through the great circle, so the cells can be put into a tree built once per board in world space.
+
+The tree is a bounding volume hierarchy of caps around the cell centers. The nodes are split at the median along the axis with the largest extent and are stored in depth first order with the index of the node after the subtree, so the traversal doesn't need a stack. Each node also stores the cosine of the largest angle to the camera at which a cell in the node is visible, which prunes the subtrees outside of the draw distance of TilingVisibility.
+
+The query only returns candidates, which then have to be tested exactly. The candidates contain every visible cell hit by the ray, and the visibility test of the cells is the same one TilingVisibility does, so testing the candidates gives the same result as testing all the visible cells.
+*/
+struct CellPicking {
+	// The draw distance of the visibility has to be computed already.
+	void build(const Tiling& tiling, const TilingVisibility& visibility);
+	/*
+	Appends the cells visible from the camera whose centers are at most maxAngularDistance from the great circle through the camera in the direction forward. The camera and forward have to be orthonormal.
+	*/
+	void query(Vec4 camera, Vec4 forward, f32 maxAngularDistance, std::vector<CellIndex>& candidates) const;
+
+	// The maximum angular distance from the great circle of the ray at which a cell with the sphere of the given radius around the projected center can be hit.
+	static f32 maxAngularDistanceForSphereRadius(f32 sphereRadius);
+
+	struct Node {
+		Vec4 center;
+		// The cosine and the sine of the angular radius of the cap around the cell centers of the node.
+		f32 radiusCos;
+		f32 radiusSin;
+		// The same as minVisibleCosine for the cap containing the bounding caps of the cells.
+		f32 minVisibleCosine;
+		// The index of the first node after the subtree of this node.
+		i32 skip;
+		// For leaves the range in elementCells. Empty for the inner nodes, whose children are the next node and the node after its subtree.
+		i32 elementsBegin;
+		i32 elementsEnd;
+	};
+	std::vector<Node> nodes;
+	std::vector<CellIndex> elementCells;
+	// Indexed the same way as elementCells.
+	std::vector<Vec4> elementCenters;
+	std::vector<f32> elementMinVisibleCosines;
+
+	static constexpr i32 MAX_LEAF_SIZE = 16;
+
+private:
+	void buildNode(const std::vector<SphereCap>& cellCaps, f32 drawDistance, i32 begin, i32 end);
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <Types.hpp>
+#include <chrono>
+
+// The clock used to time the benchmarks and the phases of the physics step.
+using Clock = std::chrono::high_resolution_clock;
+
+inline f64 millisecondsSince(Clock::time_point start) {
+	return std::chrono::duration<f64, std::milli>(Clock::now() - start).count();
+}
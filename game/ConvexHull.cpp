@@ -5,6 +5,8 @@
 #include <libqhullcpp/QhullRidge.h>
 #include <unordered_map>
 #include <unordered_set>
+#include <algorithm>
+#include <array>
 
 // https://stackoverflow.com/questions/19530731/qhull-library-c-interface
 Polytope convexHull(const std::vector<Vec4>& points) {
@@ -34,151 +36,147 @@ Polytope convexHull(const std::vector<Vec4>& points) {
 			pointsData.data(),
 			command.c_str()
 		);
-		std::vector<std::vector<i32>> facesVertices;
-		std::vector<std::vector<i32>> facesCellsTheyBelongTo;
-
 		// The ids are not ordered
 		//for (const auto& vertex : hull.vertexList()) {
 		//	std::cout << vertex.id() << '\n';
 		//}
 		std::unordered_map<i32, i32> vertexIdToVertexIndex;
-		{
-			i32 i = 0;
-			for (const auto& vertex : hull.vertexList()) {
-				vertexIdToVertexIndex[vertex.id()] = i;
-				i++;
+		std::vector<Polytope::PointN> vertices;
+		for (const auto& vertex : hull.vertexList()) {
+			vertexIdToVertexIndex[vertex.id()] = i32(vertices.size());
+			Polytope::PointN v;
+			for (i32 i = 0; i < 4; i++) {
+				v.push_back(f32(vertex.point()[i]));
 			}
+			vertices.push_back(std::move(v));
 		}
 
-		const auto cellCount = hull.facetCount();
-		const auto& cells = hull.facetList();
-		i32 cellAI = 0;
-		for (auto cellA = cells.begin(); cellA != cells.end(); ++cellA) {
-			i32 cellBI = cellAI + 1;
-			auto cellB = cellA;
-			++cellB;
-			for (; cellB != cells.end(); ++cellB) {
-				std::vector<i32> sharedVertices;
-				for (const auto& vertexA : cellA->vertices()) {
-					for (const auto& vertexB : cellB->vertices()) {
-						if (vertexA == vertexB) {
-							sharedVertices.push_back(vertexIdToVertexIndex[vertexA.id()]);
-						}
-					}
-				}
-				if (sharedVertices.size() >= 3) {
-					facesVertices.push_back(std::move(sharedVertices));
-					facesCellsTheyBelongTo.push_back({});
-					facesCellsTheyBelongTo.back().push_back(cellAI);
-					facesCellsTheyBelongTo.back().push_back(cellBI);
-				}
-				cellBI++;
+		std::vector<std::vector<i32>> cellsVertices;
+		cellsVertices.reserve(hull.facetCount());
+		for (const auto& cell : hull.facetList()) {
+			auto& cellVertices = cellsVertices.emplace_back();
+			for (const auto& vertex : cell.vertices()) {
+				cellVertices.push_back(vertexIdToVertexIndex[vertex.id()]);
 			}
-			cellAI++;
 		}
+		return polytopeFromCellsVertices(std::move(vertices), cellsVertices);
+	} catch (orgQhull::QhullError& e) {
+		CHECK_NOT_REACHED();
+		return Polytope();
+	}
+}
 
-		// Quite likely there will be duplicates.
-		std::vector<std::vector<i32>> edgesVertices;
-		std::vector<std::vector<i32>> edgesFacesTheyBelongTo;
-		for (i32 a = 0; a < facesVertices.size(); a++) {
-			const auto& faceAVertices = facesVertices[a];
-			for (i32 b = a + 1; b < facesVertices.size(); b++) {
-				const auto& faceBVertices = facesVertices[b];
-				std::vector<i32> sharedVertices;
+/*
+Calls f(a, b, sharedCount) for each pair of sets a < b that share at least one element, in lexicographic order.
 
-				for (const auto& vertexA : faceAVertices) {
-					for (const auto& vertexB : faceBVertices) {
-						if (vertexA == vertexB) {
-							sharedVertices.push_back(vertexA);
-						}
-					}
-				}
-				if (sharedVertices.size() == 2) {
-					// faces can share no vertices a single vertex or 2 vertices.
-					edgesVertices.push_back(std::move(sharedVertices));
-					edgesFacesTheyBelongTo.push_back({ a, b });
-				}
-			}
+Finding the pairs by comparing every pair of sets is quadratic in the number of sets. Here the sets containing each element are stored in an inverted index, so the sets sharing elements with a set are found by going over the sets of each of its elements. The cost is proportional to the sum of the squares of the number of sets containing each element, which is linear for polytopes with a bounded number of cells around each vertex.
+*/
+template<typename Function>
+static void forEachPairOfSetsSharingElements(const std::vector<std::vector<i32>>& sets, i32 elementCount, Function f) {
+	std::vector<i32> elementSetsOffsets(elementCount + 1, 0);
+	for (const auto& set : sets) {
+		for (const auto& element : set) {
+			elementSetsOffsets[element + 1]++;
 		}
-		// Sort to make checking equality faster.
-		for (auto& edge : edgesVertices) {
-			std::ranges::sort(edge);
+	}
+	for (i32 i = 0; i < elementCount; i++) {
+		elementSetsOffsets[i + 1] += elementSetsOffsets[i];
+	}
+	std::vector<i32> elementSets(elementSetsOffsets.back());
+	std::vector<i32> insertPosition(elementSetsOffsets.begin(), elementSetsOffsets.end() - 1);
+	for (i32 setI = 0; setI < i32(sets.size()); setI++) {
+		for (const auto& element : sets[setI]) {
+			elementSets[insertPosition[element]++] = setI;
 		}
-		struct Hash {
-			usize operator()(const std::vector<i32>& v) const {
-				if (v.size() == 0) {
-					CHECK_NOT_REACHED();
-					return 0;
-				}
-				usize hash = v[0];
-				for (i32 i = 1; i < v.size(); i++) {
-					hash = hashCombine(hash, i);
+	}
+
+	std::vector<i32> sharedCount(sets.size(), 0);
+	std::vector<i32> candidates;
+	for (i32 a = 0; a < i32(sets.size()); a++) {
+		candidates.clear();
+		for (const auto& element : sets[a]) {
+			for (i32 i = elementSetsOffsets[element]; i < elementSetsOffsets[element + 1]; i++) {
+				const auto b = elementSets[i];
+				if (b <= a) {
+					continue;
 				}
-				return hash;
-			}
-		};
-		std::unordered_map<std::vector<i32>, std::unordered_set<i32>, Hash> uniqueEdgesToFacesTheyBelongTo;
-		for (i32 i = 0; i < edgesVertices.size(); i++) {
-			auto& edge = edgesVertices[i];
-			const auto entry = uniqueEdgesToFacesTheyBelongTo.find(edge);
-			const auto& faces = edgesFacesTheyBelongTo[i];
-			if (entry == uniqueEdgesToFacesTheyBelongTo.end()) {
-				std::unordered_set<i32> set;
-				set.insert_range(faces);
-				uniqueEdgesToFacesTheyBelongTo.insert({ std::move(edge), std::move(set) });
-			} else {
-				for (const auto& face : faces) {
-					entry->second.insert(face);
+				if (sharedCount[b] == 0) {
+					candidates.push_back(b);
 				}
+				sharedCount[b]++;
 			}
-			/*auto& edge = edgesVertices[i];
-			uniqueEdgesToFacesTheyBelongTo.try_emplace(std::move(edge), )*/
 		}
+		std::ranges::sort(candidates);
+		for (const auto& b : candidates) {
+			f(a, b, sharedCount[b]);
+			sharedCount[b] = 0;
+		}
+	}
+}
 
-		Polytope result;
+Polytope polytopeFromCellsVertices(std::vector<Polytope::PointN>&& vertices, const std::vector<std::vector<i32>>& cellsVertices) {
+	const auto vertexCount = i32(vertices.size());
 
-		for (const auto& vertex : hull.vertexList()) {
-			Polytope::PointN v;
-			for (i32 i = 0; i < 4; i++) {
-				v.push_back(f32(vertex.point()[i]));
-			}
-			result.vertices.push_back(std::move(v));
+	std::vector<std::vector<i32>> facesVertices;
+	std::vector<std::array<i32, 2>> facesCellsTheyBelongTo;
+	forEachPairOfSetsSharingElements(cellsVertices, vertexCount, [&](i32 cellA, i32 cellB, i32 sharedCount) {
+		if (sharedCount < 3) {
+			return;
 		}
-
-		result.cells.push_back(Polytope::CellsN{});
-		//Polytope::CellsN& edgesVertices = result.cells.back();
-		for (const auto& [edgeVertices, _] : uniqueEdgesToFacesTheyBelongTo) {
-			/*std::vector<i32> v;
-			for (const auto& e : edgeVertices) {
-				v.push_back(e - 1);
+		auto& sharedVertices = facesVertices.emplace_back();
+		const auto& cellBVertices = cellsVertices[cellB];
+		for (const auto& vertex : cellsVertices[cellA]) {
+			if (std::ranges::find(cellBVertices, vertex) != cellBVertices.end()) {
+				sharedVertices.push_back(vertex);
 			}
-			result.cells.back().push_back(std::move(v));*/
-			// Copy, because you can't move out they key of an unodered_map.
-			result.cells.back().push_back(Polytope::CellN(edgeVertices));
 		}
+		facesCellsTheyBelongTo.push_back({ cellA, cellB });
+	});
 
-		result.cells.push_back(Polytope::CellsN{});
-		auto& facesEdges = result.cells.back();
-		facesEdges.resize(facesVertices.size());
-		i32 edgeI = 0;
-		for (const auto& [_, edgeFaces] : uniqueEdgesToFacesTheyBelongTo) {
-			for (const auto& faceI : edgeFaces) {
-				facesEdges[faceI].push_back(edgeI);
+	// Each edge is found once for each pair of faces containing it.
+	std::unordered_map<u64, i32> edgeVerticesToEdgeIndex;
+	std::vector<std::array<i32, 2>> edgesFaces;
+	Polytope result;
+	result.vertices = std::move(vertices);
+	result.cells.resize(3);
+	auto& edgesVertices = result.cells[0];
+	forEachPairOfSetsSharingElements(facesVertices, vertexCount, [&](i32 faceA, i32 faceB, i32 sharedCount) {
+		// Faces can share no vertices, a single vertex or 2 vertices.
+		if (sharedCount != 2) {
+			return;
+		}
+		const auto& faceBVertices = facesVertices[faceB];
+		Polytope::CellN edge;
+		for (const auto& vertex : facesVertices[faceA]) {
+			if (std::ranges::find(faceBVertices, vertex) != faceBVertices.end()) {
+				edge.push_back(vertex);
 			}
-			edgeI++;
 		}
+		std::ranges::sort(edge);
+		const auto key = (u64(u32(edge[0])) << 32) | u64(u32(edge[1]));
+		const auto [it, inserted] = edgeVerticesToEdgeIndex.try_emplace(key, i32(edgesVertices.size()));
+		if (inserted) {
+			edgesVertices.push_back(std::move(edge));
+		}
+		edgesFaces.push_back({ it->second, faceA });
+		edgesFaces.push_back({ it->second, faceB });
+	});
+	std::ranges::sort(edgesFaces);
+	edgesFaces.erase(std::unique(edgesFaces.begin(), edgesFaces.end()), edgesFaces.end());
 
-		result.cells.push_back(Polytope::CellsN{});
-		auto& cellsFaces = result.cells.back();
-		cellsFaces.resize(cells.size());
-		for (i32 faceI = 0; faceI < facesCellsTheyBelongTo.size(); faceI++) {
-			for (const auto& cellI : facesCellsTheyBelongTo[faceI]) {
-				cellsFaces[cellI].push_back(faceI);
-			}
+	auto& facesEdges = result.cells[1];
+	facesEdges.resize(facesVertices.size());
+	// Sorted by edge so the edges of each face are in increasing order.
+	for (const auto& [edgeI, faceI] : edgesFaces) {
+		facesEdges[faceI].push_back(edgeI);
+	}
+
+	auto& cellsFaces = result.cells[2];
+	cellsFaces.resize(cellsVertices.size());
+	for (i32 faceI = 0; faceI < i32(facesCellsTheyBelongTo.size()); faceI++) {
+		for (const auto& cellI : facesCellsTheyBelongTo[faceI]) {
+			cellsFaces[cellI].push_back(faceI);
 		}
-		return result;
-	} catch (orgQhull::QhullError& e) {
-		CHECK_NOT_REACHED();
-		return Polytope();
 	}
+	return result;
 }
@@ -4,3 +4,6 @@
 
 Polytope convexHull(const std::vector<Vec4>& points);
 
+
+// Creates a 4 dimensional polytope from the vertices of its cells. Two cells sharing at least 3 vertices share a face and two faces sharing exactly 2 vertices share an edge. The faces are ordered by the pair of cells they belong to and their vertices are in the order of the first cell. The edges are ordered by their first occurrence and the edges of each face are in increasing order.
+Polytope polytopeFromCellsVertices(std::vector<Polytope::PointN>&& vertices, const std::vector<std::vector<i32>>& cellsVertices);
@@ -92,6 +92,70 @@ public:
 	auto entitiesAddedLastFrame() const -> const std::vector<EntityArrayId<Entity>>& { return entitiesAddedLastFrame_; }
 };
 
+/*
+Alternative to EntityArray, which keeps the alive entities packed in a dense array so iterating only touches the alive entities instead of scanning every index ever used.
+
+The ids are the same as in EntityArray. The id index is an index into the sparse slot arrays, which store the version and the position of the entity in the dense array. The ids stay valid when the entities are moved in the dense array, but pointers and references to the entities don't.
+
+The dense array is split into the active entities followed by the inactive entities so iterating just goes over the active prefix. Destroying, activating and deactivating entities swaps them with the last entity of their part of the array, which changes the iteration order, so it shouldn't be done while iterating. Destruction is delayed till update() the same way as in EntityArray so the destroyed entities are removed in a single batch at the end of the frame. Creating also works the same way. The entity is usable immediately and it's reported by entitiesAddedLastFrame() after the next update().
+
+Unlike EntityArray the destroyed entities aren't pooled. Created entities are always initialized with DefaultInitialize.
+*/
+template<typename Entity, typename DefaultInitialize>
+struct DenseEntityArray {
+	void update();
+	std::optional<Entity&> get(const EntityArrayId<Entity>& id);
+	std::optional<const Entity&> get(const EntityArrayId<Entity>& id) const;
+	std::optional<Entity&> getEvenIfInactive(const EntityArrayId<Entity>& id);
+	std::optional<const Entity&> getEvenIfInactive(const EntityArrayId<Entity>& id) const;
+	bool isAlive(const EntityArrayId<Entity>& id);
+	EntityArrayPair<Entity> create();
+	void destroy(const EntityArrayId<Entity>& id);
+	void deactivate(const EntityArrayId<Entity>& id);
+	void activate(const EntityArrayId<Entity>& id);
+	void reset();
+	i64 aliveCount() const { return i64(entities.size()); };
+	i64 activeCount() const { return i64(activeCount_); };
+
+	struct Iterator {
+		auto operator++()->Iterator&;
+		auto operator!=(const Iterator& other) const -> bool;
+		auto operator->()->Entity*;
+		auto operator->() const -> const Entity*;
+		auto operator*()->EntityArrayPair<Entity>;
+
+		u32 index;
+		DenseEntityArray& array;
+	};
+
+	auto begin() -> Iterator;
+	auto end() -> Iterator;
+
+	static constexpr u32 INVALID_DENSE_INDEX = 0xFFFFFFFF;
+
+	// Dense arrays. The active entities are in the range [0, activeCount_).
+	std::vector<Entity> entities;
+	std::vector<u32> denseSlots;
+	u32 activeCount_ = 0;
+
+	// Sparse arrays indexed by the id index.
+	std::vector<u32> slotVersions;
+	// INVALID_DENSE_INDEX if the slot is free.
+	std::vector<u32> slotDenseIndices;
+	std::vector<u32> freeSlots;
+
+	std::vector<EntityArrayId<Entity>> entitiesToRemove;
+	std::vector<EntityArrayId<Entity>> entitiesAddedLastFrame_;
+	std::vector<EntityArrayId<Entity>> entitiesAddedThisFrame;
+
+	// Returns INVALID_DENSE_INDEX if the entity isn't alive.
+	u32 denseIndex(const EntityArrayId<Entity>& id) const;
+	void swapDense(u32 a, u32 b);
+	void removeDense(u32 denseIndex);
+
+	auto entitiesAddedLastFrame() const -> const std::vector<EntityArrayId<Entity>>& { return entitiesAddedLastFrame_; }
+};
+
 template<typename T>
 i32 EntityArrayId<T>::index() const {
 	return index_;
@@ -307,6 +371,216 @@ auto EntityArray<Entity, DefaultInitialize>::Iterator::operator*() -> EntityArra
 	return EntityArrayPair<Entity>(EntityArrayId<Entity>{ index, array.entityVersions[index] }, array.entities[index]);
 }
 
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::update() {
+	ASSERT(entities.size() == denseSlots.size());
+	ASSERT(slotVersions.size() == slotDenseIndices.size());
+
+	std::swap(entitiesAddedThisFrame, entitiesAddedLastFrame_);
+	entitiesAddedThisFrame.clear();
+
+	for (const auto id : entitiesToRemove) {
+		if (id.index_ >= slotVersions.size()) {
+			CHECK_NOT_REACHED();
+			return;
+		}
+		const auto index = denseIndex(id);
+		if (index == INVALID_DENSE_INDEX) {
+			// Destroyed multiple times.
+			continue;
+		}
+		removeDense(index);
+		slotDenseIndices[id.index_] = INVALID_DENSE_INDEX;
+		slotVersions[id.index_]++;
+		freeSlots.push_back(id.index_);
+	}
+	entitiesToRemove.clear();
+}
+
+template<typename Entity, typename DefaultInitialize>
+u32 DenseEntityArray<Entity, DefaultInitialize>::denseIndex(const EntityArrayId<Entity>& id) const {
+	if (id.index_ >= slotVersions.size()) {
+		ASSERT_NOT_REACHED();
+		return INVALID_DENSE_INDEX;
+	}
+	if (id.version_ != slotVersions[id.index_]) {
+		return INVALID_DENSE_INDEX;
+	}
+	return slotDenseIndices[id.index_];
+}
+
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::swapDense(u32 a, u32 b) {
+	if (a == b) {
+		return;
+	}
+	std::swap(entities[a], entities[b]);
+	std::swap(denseSlots[a], denseSlots[b]);
+	slotDenseIndices[denseSlots[a]] = a;
+	slotDenseIndices[denseSlots[b]] = b;
+}
+
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::removeDense(u32 index) {
+	// First move the entity to the end of the active part so the active part stays contiguous, then to the end of the array.
+	if (index < activeCount_) {
+		swapDense(index, activeCount_ - 1);
+		index = activeCount_ - 1;
+		activeCount_--;
+	}
+	swapDense(index, u32(entities.size()) - 1);
+	entities.pop_back();
+	denseSlots.pop_back();
+}
+
+template<typename Entity, typename DefaultInitialize>
+std::optional<Entity&> DenseEntityArray<Entity, DefaultInitialize>::get(const EntityArrayId<Entity>& id) {
+	const auto index = denseIndex(id);
+	if (index >= activeCount_) {
+		return std::nullopt;
+	}
+	return entities[index];
+}
+
+template<typename Entity, typename DefaultInitialize>
+std::optional<const Entity&> DenseEntityArray<Entity, DefaultInitialize>::get(const EntityArrayId<Entity>& id) const {
+	const auto index = denseIndex(id);
+	if (index >= activeCount_) {
+		return std::nullopt;
+	}
+	return entities[index];
+}
+
+template<typename Entity, typename DefaultInitialize>
+std::optional<Entity&> DenseEntityArray<Entity, DefaultInitialize>::getEvenIfInactive(const EntityArrayId<Entity>& id) {
+	const auto index = denseIndex(id);
+	if (index == INVALID_DENSE_INDEX) {
+		return std::nullopt;
+	}
+	return entities[index];
+}
+
+template<typename Entity, typename DefaultInitialize>
+std::optional<const Entity&> DenseEntityArray<Entity, DefaultInitialize>::getEvenIfInactive(const EntityArrayId<Entity>& id) const {
+	const auto index = denseIndex(id);
+	if (index == INVALID_DENSE_INDEX) {
+		return std::nullopt;
+	}
+	return entities[index];
+}
+
+template<typename Entity, typename DefaultInitialize>
+bool DenseEntityArray<Entity, DefaultInitialize>::isAlive(const EntityArrayId<Entity>& id) {
+	return get(id).has_value();
+}
+
+template<typename Entity, typename DefaultInitialize>
+EntityArrayPair<Entity> DenseEntityArray<Entity, DefaultInitialize>::create() {
+	u32 slot;
+	if (freeSlots.size() == 0) {
+		slot = u32(slotVersions.size());
+		slotVersions.push_back(0);
+		slotDenseIndices.push_back(INVALID_DENSE_INDEX);
+	} else {
+		slot = freeSlots.back();
+		freeSlots.pop_back();
+	}
+
+	// Appending and then moving the first inactive entity to the end to make space in the active part.
+	const auto index = u32(entities.size());
+	entities.emplace_back(DefaultInitialize()());
+	denseSlots.push_back(slot);
+	slotDenseIndices[slot] = index;
+	swapDense(index, activeCount_);
+	activeCount_++;
+
+	const EntityArrayId<Entity> id(slot, slotVersions[slot]);
+	entitiesAddedThisFrame.push_back(id);
+	return { id, entities[activeCount_ - 1] };
+}
+
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::destroy(const EntityArrayId<Entity>& id) {
+	entitiesToRemove.push_back(id);
+}
+
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::deactivate(const EntityArrayId<Entity>& id) {
+	const auto index = denseIndex(id);
+	if (index >= activeCount_) {
+		return;
+	}
+	swapDense(index, activeCount_ - 1);
+	activeCount_--;
+}
+
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::activate(const EntityArrayId<Entity>& id) {
+	const auto index = denseIndex(id);
+	if (index == INVALID_DENSE_INDEX || index < activeCount_) {
+		return;
+	}
+	swapDense(index, activeCount_);
+	activeCount_++;
+}
+
+template<typename Entity, typename DefaultInitialize>
+void DenseEntityArray<Entity, DefaultInitialize>::reset() {
+	for (const auto slot : denseSlots) {
+		slotVersions[slot]++;
+		slotDenseIndices[slot] = INVALID_DENSE_INDEX;
+	}
+	entities.clear();
+	denseSlots.clear();
+	activeCount_ = 0;
+	freeSlots.clear();
+	// Iterating backwards so the ids are given out in order, which is required for level loading.
+	for (i32 i = i32(slotVersions.size()) - 1; i >= 0; i--) {
+		freeSlots.push_back(i);
+	}
+	entitiesToRemove.clear();
+	entitiesAddedLastFrame_.clear();
+	entitiesAddedThisFrame.clear();
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::begin() -> Iterator {
+	return Iterator{ 0, *this };
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::end() -> Iterator {
+	return Iterator{ activeCount_, *this };
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::Iterator::operator++() -> Iterator& {
+	index++;
+	return *this;
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::Iterator::operator!=(const Iterator& other) const -> bool {
+	ASSERT(&array == &other.array);
+	return index != other.index;
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::Iterator::operator->() -> Entity* {
+	return &array.entities[index];
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::Iterator::operator->() const -> const Entity* {
+	return &array.entities[index];
+}
+
+template<typename Entity, typename DefaultInitialize>
+auto DenseEntityArray<Entity, DefaultInitialize>::Iterator::operator*() -> EntityArrayPair<Entity> {
+	const auto slot = array.denseSlots[index];
+	return EntityArrayPair<Entity>(EntityArrayId<Entity>{ slot, array.slotVersions[slot] }, array.entities[index]);
+}
+
 template<typename Entity>
 auto EntityArrayPair<Entity>::operator->() -> Entity* {
 	return &entity;
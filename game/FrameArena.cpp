@@ -0,0 +1,71 @@
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+
+FrameArena::FrameArena(usize initialCapacity) {
+	addBlock(std::max(initialCapacity, usize(64)));
+}
+
+void* FrameArena::allocate(usize size, usize alignment) {
+	frameAllocationCount++;
+	frameAllocatedBytes += size;
+
+	auto tryAllocate = [&]() -> void* {
+		auto& block = blocks.back();
+		const auto address = reinterpret_cast<uintptr_t>(block.data.get()) + usedInLastBlock;
+		const auto aligned = (address + alignment - 1) & ~(uintptr_t(alignment) - 1);
+		const auto end = aligned - reinterpret_cast<uintptr_t>(block.data.get()) + size;
+		if (end > block.size) {
+			return nullptr;
+		}
+		usedInLastBlock = end;
+		return reinterpret_cast<void*>(aligned);
+	};
+	if (auto result = tryAllocate()) {
+		return result;
+	}
+	// The alignment padding has to fit too.
+	addBlock(std::max(2 * blocks.back().size, size + alignment));
+	return tryAllocate();
+}
+
+void FrameArena::reset() {
+	lastFrameAllocationCount = frameAllocationCount;
+	lastFrameAllocatedBytes = frameAllocatedBytes;
+	peakFrameAllocatedBytes = std::max(peakFrameAllocatedBytes, frameAllocatedBytes);
+	frameAllocationCount = 0;
+	frameAllocatedBytes = 0;
+
+	if (blocks.size() > 1) {
+		// Merging the blocks so the next frame fits into a single one.
+		usize totalSize = 0;
+		for (const auto& block : blocks) {
+			totalSize += block.size;
+		}
+		blocks.clear();
+		addBlock(totalSize);
+	}
+	usedInLastBlock = 0;
+}
+
+usize FrameArena::capacity() const {
+	usize result = 0;
+	for (const auto& block : blocks) {
+		result += block.size;
+	}
+	return result;
+}
+
+void FrameArena::addBlock(usize size) {
+	blocks.push_back(Block{ .data = std::make_unique_for_overwrite<u8[]>(size), .size = size });
+	usedInLastBlock = 0;
+	heapAllocationCount++;
+}
+
+std::string_view intToString(FrameArena& arena, i64 value) {
+	// The sign and 19 digits.
+	const auto buffer = arena.allocateArray<char>(20);
+	const auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+	return std::string_view(buffer.data(), result.ptr - buffer.data());
+}
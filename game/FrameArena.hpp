@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Types.hpp>
+#include <View.hpp>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+
+/*
+Linear allocator for memory that only lives until the end of the frame. It's owned by MainLoop and reset at the start of every frame, which frees everything allocated from it at once.
+
+Allocating just moves an offset inside of the current block. If the block runs out a new one, at least twice as large, is allocated from the heap. When the arena is reset after a frame that needed multiple blocks they are replaced by a single block with their total size, so after the first few frames a frame doesn't allocate anything from the heap as long as it doesn't need more memory than the previous ones.
+
+Nothing is destroyed when the arena is reset so only trivially destructible types or containers using FrameAllocator, whose destructors don't free anything, should be put into it.
+*/
+struct FrameArena {
+	explicit FrameArena(usize initialCapacity = 1024 * 1024);
+
+	void* allocate(usize size, usize alignment = alignof(std::max_align_t));
+	// The elements are uninitialized.
+	template<typename T>
+	View<T> allocateArray(usize count);
+	void reset();
+
+	usize capacity() const;
+
+	struct Block {
+		std::unique_ptr<u8[]> data;
+		usize size;
+	};
+	// Allocations are made from the last block.
+	std::vector<Block> blocks;
+	usize usedInLastBlock = 0;
+
+	// Reset at the start of every frame.
+	i64 frameAllocationCount = 0;
+	usize frameAllocatedBytes = 0;
+	// The values for the previous frame, saved when the arena is reset.
+	i64 lastFrameAllocationCount = 0;
+	usize lastFrameAllocatedBytes = 0;
+	usize peakFrameAllocatedBytes = 0;
+	// The number of blocks allocated from the heap. Stops changing once the arena is large enough.
+	i64 heapAllocationCount = 0;
+
+private:
+	void addBlock(usize size);
+};
+
+// Standard library allocator that allocates from a frame arena. Deallocating does nothing, the memory is reused after the arena is reset. The containers using it can't outlive the frame.
+template<typename T>
+struct FrameAllocator {
+	using value_type = T;
+
+	FrameAllocator(FrameArena& arena) : arena(&arena) {}
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(usize count) {
+		return static_cast<T*>(arena->allocate(count * sizeof(T), alignof(T)));
+	}
+	void deallocate(T*, usize) {}
+
+	template<typename U>
+	bool operator==(const FrameAllocator<U>& other) const {
+		return arena == other.arena;
+	}
+
+	FrameArena* arena;
+};
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+using FrameString = std::basic_string<char, std::char_traits<char>, FrameAllocator<char>>;
+
+// Formats the integer into memory allocated from the arena.
+std::string_view intToString(FrameArena& arena, i64 value);
+
+template<typename T>
+View<T> FrameArena::allocateArray(usize count) {
+	return View<T>(static_cast<T*>(allocate(count * sizeof(T), alignof(T))), count);
+}
@@ -11,17 +11,19 @@
 #include <game/Shaders/transparencyCompositingData.hpp>
 #include <game/Shaders/texturedFullscreenQuadData.hpp>
 #include <Timer.hpp>
+#include <game/StereographicArc.hpp>
 
+// The VAO is bound before writing, because writing to the Ibo binds it to the currently bound VAO.
 template<typename Vertex>
 void renderTriangles(ShaderProgram& shader, TriangleRenderer<Vertex>& r) {
 	if (r.vertices.size() == 0 || r.indices.size() == 0) {
 		return;
 	}
-	r.vbo.allocateData(r.vertices.data(), r.vertices.size() * sizeof(Vertex));
-	r.ibo.allocateData(r.indices.data(), r.indices.size() * sizeof(u32));
+	r.vao.bind();
+	r.vbo.write(r.vertices.data(), r.vertices.size() * sizeof(Vertex));
+	r.ibo.write(r.indices.data(), r.indices.size() * sizeof(u32));
 
 	shader.use();
-	r.vao.bind();
 	glDrawElements(GL_TRIANGLES, i32(r.indices.size()), GL_UNSIGNED_INT, nullptr);
 
 	r.vertices.clear();
@@ -29,28 +31,22 @@ void renderTriangles(ShaderProgram& shader, TriangleRenderer<Vertex>& r) {
 }
 
 template<typename Vertex, typename Instance>
-void renderTriangles(ShaderProgram& shader, TriangleRenderer<Vertex>& r, Vbo& instancesVbo, const Instance& instance) {
+void renderTriangles(ShaderProgram& shader, TriangleRenderer<Vertex>& r, StreamingBuffer<Vbo>& instancesBuffer, const Instance& instance) {
 	if (r.vertices.size() == 0 || r.indices.size() == 0) {
 		return;
 	}
-	r.vbo.allocateData(r.vertices.data(), r.vertices.size() * sizeof(Vertex));
-	r.ibo.allocateData(r.indices.data(), r.indices.size() * sizeof(u32));
+	r.vao.bind();
+	r.vbo.write(r.vertices.data(), r.vertices.size() * sizeof(Vertex));
+	r.ibo.write(r.indices.data(), r.indices.size() * sizeof(u32));
+	instancesBuffer.write(&instance, sizeof(Instance));
 
 	shader.use();
-	drawInstances(
-		r.vao,
-		instancesVbo,
-		constView(instance),
-		[&](usize count) {
-			glDrawElements(GL_TRIANGLES, i32(r.indices.size()), GL_UNSIGNED_INT, nullptr);
-		}
-	);
+	glDrawElements(GL_TRIANGLES, i32(r.indices.size()), GL_UNSIGNED_INT, nullptr);
 
 	r.vertices.clear();
 	r.indices.clear();
 }
 
-
 template<typename Shader, typename Vertex>
 Mesh makeMesh(View<const Vertex> vertices, View<const i32> indices, Vbo& instancesVbo) {
 	auto vbo = Vbo(vertices.data(), vertices.size() * sizeof(Vertex));
@@ -64,11 +60,15 @@ Mesh makeMesh(View<const Vertex> vertices, View<const i32> indices, Vbo& instanc
 	};
 }
 
+// Unlike drawInstances this doesn't split the instances into batches of the size of the buffer. The buffer grows to fit all of them, so they are drawn with a single draw call.
 template<typename Instance>
-void drawMeshInstances(Mesh& mesh, View<const Instance> instances, Vbo& instancesVbo) {
-	drawInstances(mesh.vao, instancesVbo, instances, [&](GLsizei count) {
-		glDrawElementsInstanced(GL_TRIANGLES, GLsizei(mesh.indexCount), GL_UNSIGNED_INT, nullptr, count);
-	});
+void drawMeshInstances(Mesh& mesh, View<const Instance> instances, StreamingBuffer<Vbo>& instancesBuffer) {
+	if (instances.size() == 0) {
+		return;
+	}
+	instancesBuffer.write(instances.data(), instances.size() * sizeof(Instance));
+	mesh.vao.bind();
+	glDrawElementsInstanced(GL_TRIANGLES, GLsizei(mesh.indexCount), GL_UNSIGNED_INT, nullptr, GLsizei(instances.size()));
 }
 
 #include <game/DoublyConnectedEdgeList.hpp>
@@ -98,7 +98,8 @@ i32 infinitePlaneIndices[]{
 #include "generated/FontData.hpp"
 
 GameRenderer GameRenderer::make() {
-	auto instancesVbo = Vbo::dynamicDraw(1024ull * 20);
+	const auto instancesVboSize = 1024ull * 20;
+	auto instancesVbo = Vbo::dynamicDraw(instancesVboSize);
 
 	auto makeColoredShadedMesh = [&instancesVbo](const std::vector<Vertex3Pn>& vertices, const std::vector<i32>& indices) {
 		return makeMesh<ColoredShader>(constView(vertices), constView(indices), instancesVbo);
@@ -265,6 +266,35 @@ GameRenderer GameRenderer::make() {
 	//}
 	//auto sphereImpostorMeshTri = makeMesh<SphereImpostorShader>(constView(sphereImpostorMeshVertices), constView(sphereImpostorMeshIndices), instancesVbo);
 
+	auto stereographicArcMesh = [&] {
+		std::vector<StereographicArcMeshVertex> arcVertices;
+		std::vector<i32> arcIndices;
+		const auto ringCount = STEREOGRAPHIC_ARC_RING_COUNT;
+		const auto crossSectionPointCount = STEREOGRAPHIC_ARC_CROSS_SECTION_POINT_COUNT;
+		// The same order of vertices and indices as in LineGenerator::addCircularArc.
+		for (i32 ringI = 0; ringI < ringCount; ringI++) {
+			const auto t = f32(ringI) / f32(ringCount - 1);
+			for (i32 i = 0; i < crossSectionPointCount; i++) {
+				const auto a = (f32(i) / f32(crossSectionPointCount)) * TAU<f32>;
+				arcVertices.push_back(StereographicArcMeshVertex{ .crossSection = Vec2::oriented(a), .t = t });
+			}
+		}
+		for (i32 ringI = 0; ringI < ringCount - 1; ringI++) {
+			i32 previous = crossSectionPointCount - 1;
+			for (i32 i = 0; i < crossSectionPointCount; i++) {
+				indicesAddQuad(
+					arcIndices,
+					ringI * crossSectionPointCount + previous,
+					(ringI + 1) * crossSectionPointCount + previous,
+					(ringI + 1) * crossSectionPointCount + i,
+					ringI * crossSectionPointCount + i
+				);
+				previous = i;
+			}
+		}
+		return makeMesh<StereographicArcShader>(constView(arcVertices), constView(arcIndices), instancesVbo);
+	}();
+
 	auto text3QuadMesh = [&] {
 		Vertex3P quad3Vertices[]{
 			Vertex3P{ Vec3(-1.0f, 1.0f, 0.0f) },
@@ -294,6 +324,8 @@ GameRenderer GameRenderer::make() {
 		//MOVE(cubeMesh),
 		//.coloredShadingTriangles = TriangleRenderer<Vertex3Pnc>::make<ColoredShadingShader>(instancesVbo),
 		.coloredTriangles = TriangleRenderer<Vertex3Pn>::make<ColoredShader>(instancesVbo),
+		.stereographicArcShader = MAKE_GENERATED_SHADER(STEREOGRAPHIC_ARC),
+		MOVE(stereographicArcMesh),
 		//.coloredShadingShader = MAKE_GENERATED_SHADER(COLORED_SHADING),
 		//.homogenousShader = MAKE_GENERATED_SHADER(HOMOGENOUS),
 		//.infinitePlaneMesh = makeMesh<HomogenousShader>(constView(infinitePlaneVertices), constView(infinitePlaneIndices), instancesVbo),
@@ -312,7 +344,7 @@ GameRenderer GameRenderer::make() {
 		#endif
 
 		//MOVE(gfx2d),
-		MOVE(instancesVbo),
+		.instancesBuffer = StreamingBuffer<Vbo>{ .buffer = std::move(instancesVbo), .capacity = instancesVboSize },
 	};
 	t.tookSeconds("initializing GameRenderer");
 	//saveFontToCpp("cached/RobotoMono-Regular.png", "cached/RobotoMono-Regular.json");
@@ -321,6 +353,12 @@ GameRenderer GameRenderer::make() {
 }
 
 void GameRenderer::frameUpdate(Mat4 view, Vec3 cameraPosition, const StereographicCamera& stereographicCamera) {
+	bytesUploadedLastFrame = instancesBuffer.bytesUploaded + coloredTriangles.vbo.bytesUploaded + coloredTriangles.ibo.bytesUploaded;
+	instancesBuffer.resetCounters();
+	coloredTriangles.vbo.resetCounters();
+	coloredTriangles.ibo.resetCounters();
+
+	this->view4 = stereographicCamera.view4();
 	this->viewInverse4 = stereographicCamera.view4Inversed();
 	this->cameraPos4 = stereographicCamera.pos4();
 	const auto cameraForward = (Vec4(Vec3::FORWARD, 0.0f) * view.inversed()).xyz().normalized();
@@ -365,7 +403,7 @@ void GameRenderer::sphere(Vec3 center, f32 radius, Vec3 color) {
 
 void GameRenderer::renderHemispheres() {
 	initColoredShader();
-	drawMeshInstances(hemisphere, constView(hemispheres), instancesVbo);
+	drawMeshInstances(hemisphere, constView(hemispheres), instancesBuffer);
 	hemispheres.clear();
 }
 
@@ -402,7 +440,7 @@ Mat4 transformMesh(Vec3 a, Vec3 b) {
 
 void GameRenderer::renderCyllinders() {
 	initColoredShader();
-	drawMeshInstances(cyllinderMesh, constView(cyllinders), instancesVbo);
+	drawMeshInstances(cyllinderMesh, constView(cyllinders), instancesBuffer);
 	cyllinders.clear();
 }
 
@@ -446,7 +484,7 @@ void GameRenderer::renderColoredTriangles(const ColoredInstance& instance) {
 		.view = view,
 	});
 	//.model = coloredShadingModel,
-	renderTriangles(coloredShader, coloredTriangles, instancesVbo, instance);
+	renderTriangles(coloredShader, coloredTriangles, instancesBuffer, instance);
 }
 
 void GameRenderer::coloredTrianglesAddMesh(const std::vector<Vec3>& positions, const std::vector<Vec3>& normals, const std::vector<i32>& indices, Vec3 color) {
@@ -566,6 +604,25 @@ void GameRenderer::coloredTrianglesAddMesh(const LineGenerator& lineGenerator, V
 //	}
 //}
 
+void GameRenderer::stereographicArc(Vec4 e0, Vec4 e1, f32 width, Vec3 color) {
+	stereographicArcs.push_back(StereographicArcInstance{
+		.e0 = e0,
+		.e1 = e1,
+		.width = width,
+		.color = color,
+	});
+}
+
+void GameRenderer::renderStereographicArcs() {
+	stereographicArcShader.use();
+	shaderSetUniforms(stereographicArcShader, StereographicArcVertUniforms{
+		.transform = transform,
+		.view4 = view4,
+	});
+	drawMeshInstances(stereographicArcMesh, constView(stereographicArcs), instancesBuffer);
+	stereographicArcs.clear();
+}
+
 void GameRenderer::stereographicLineSegment(Vec4 e0, Vec4 e1, f32 width, bool scaleWidth) {
 	const auto segment = StereographicSegment::fromEndpoints(e0, e1);
 	stereographicLineSegment(segment, width, scaleWidth);
@@ -850,7 +907,7 @@ void GameRenderer::renderText() {
 	//	});
 
 	//drawInstances(text3QuadMesh.vao, instancesVbo, constView(text3Instances), drawMeshInstances);
-	drawMeshInstances(text3QuadMesh, constView(text3Instances), instancesVbo);
+	drawMeshInstances(text3QuadMesh, constView(text3Instances), instancesBuffer);
 	text3Instances.clear();
 	glDisable(GL_BLEND);
 }
@@ -3,6 +3,7 @@
 #include <engine/Graphics/Fbo.hpp>
 #include <engine/gfx2d/Gfx2d.hpp>
 #include <game/TriangleRenderer.hpp>
+#include <game/StreamingBuffer.hpp>
 #include <game/Shaders/coloredData.hpp>
 #include <game/Shaders/coloredShadingData.hpp>
 #include <game/LineGenerator.hpp>
@@ -10,6 +11,7 @@
 #include <game/Shaders/sphereImpostorData.hpp>
 #include <game/Shaders/sphereImpostor2Data.hpp>
 #include <game/Shaders/text3Data.hpp>
+#include <game/Shaders/stereographicArcData.hpp>
 #include <game/Cubemap.hpp>
 #include <game/StereographicCamera.hpp>
 #include <gfx2d/FontRendering/Font.hpp>
@@ -84,6 +86,15 @@ struct GameRenderer {
 
 	bool useImpostorsTriangles = true;
 
+	// Draws the arcs of great circles between e0 and e1 as instances of a tube mesh that the vertex shader bends, see StereographicArc.hpp. Only the edges for which isStereographicArcInstanceable is true can be drawn this way.
+	ShaderProgram& stereographicArcShader;
+	Mesh stereographicArcMesh;
+	std::vector<StereographicArcInstance> stereographicArcs;
+	void stereographicArc(Vec4 e0, Vec4 e1, f32 width, Vec3 color);
+	void renderStereographicArcs();
+	// If this is false the arcs are generated on the CPU instead.
+	bool useInstancedStereographicArcs = true;
+
 	void stereographicLineSegment(Vec4 e0, Vec4 e1, f32 width = 0.02f, bool scaleWidth = true);
 	void stereographicLineSegment(const StereographicSegment& segment, f32 width = 0.02f, bool scaleWidth = true);
 
@@ -105,8 +116,12 @@ struct GameRenderer {
 	//Gfx2d gfx2d;
 
 	Vec4 cameraPos4 = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	Mat4 view4 = Mat4::identity;
 	Mat4 viewInverse4 = Mat4::identity;
 
-	Vbo instancesVbo;
+	// All the instance batches are written into this buffer right before they are drawn.
+	StreamingBuffer<Vbo> instancesBuffer;
+	// The number of bytes written to instancesBuffer and coloredTriangles during the previous frame. Updated by frameUpdate.
+	usize bytesUploadedLastFrame = 0;
 
 };
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <engine/Math/Interpolation.hpp>
 #include <engine/Math/Angles.hpp>
 #include <game/MeshUtils.hpp>
+#include <array>
 
 std::optional<i32> circleArcPointCountRequiredToAchiveError(f32 desiredMaxDeviation, f32 radius, f32 arcAngleLength, i32 maxAllowedPointCount) {
 	const auto a = arcAngleLength;
@@ -35,7 +36,8 @@ std::optional<i32> circleArcPointCountRequiredToAchiveError(f32 desiredMaxDeviat
 	// 1 / n < arccos(2(m/r - 1)^2 - 1) / a
 	// n > a / arccos(2(m/r - 1)^2 - 1)
 	//const auto desiredDeviation = 0.007f;
-	const auto k = acos(2.0f * pow(desiredMaxDeviation / radius - 1.0f, 2.0f) - 1.0f);
+	const auto t = desiredMaxDeviation / radius - 1.0f;
+	const auto k = acos(2.0f * t * t - 1.0f);
 	const auto n = i32(std::ceil(a / k));
 	auto divisionCount = n;
 
@@ -291,19 +293,24 @@ void LineGenerator::addFlatCurve(const std::vector<Vec3>& curvePoints, Vec3 came
 void LineGenerator::addCircularArc(Vec3 aRelativeToCenter, Vec3 velocityOutOfA, Vec3 circleCenter, f32 arclength, f32 tubeRadius, i32 pointCount) {
 
 	velocityOutOfA = velocityOutOfA.normalized() * aRelativeToCenter.length();
-	const auto t0 = aRelativeToCenter.length();
-	const auto t1 = velocityOutOfA.length();
 
-	std::vector<Vec2> circlePoints;
-	const i32 circlePointCount = 10;
-	for (i32 i = 0; i < circlePointCount; i++) {
-		const auto a = (f32(i) / f32(circlePointCount)) * TAU<f32>;
-		circlePoints.push_back(Vec2::oriented(a));
-	}
+	// This is called for every curved edge every frame, so the cross section isn't recomputed each time.
+	static constexpr i32 circlePointCount = 10;
+	static const auto circlePoints = [] {
+		std::array<Vec2, circlePointCount> points;
+		for (i32 i = 0; i < circlePointCount; i++) {
+			const auto a = (f32(i) / f32(circlePointCount)) * TAU<f32>;
+			points[i] = Vec2::oriented(a);
+		}
+		return points;
+	}();
 
 	const auto offset = vertexCount();
 
 	const auto count = pointCount;
+	positions.resize(offset + count * circlePointCount);
+	normals.resize(offset + count * circlePointCount);
+	auto vertex = offset;
 	const auto curveBinormal = cross(aRelativeToCenter, velocityOutOfA).normalized();
 	for (i32 curveI = 0; curveI < count; curveI++) {
 		const auto curveAngle = lerp(0.0f, arclength, f32(curveI) / f32(count - 1));
@@ -316,9 +323,9 @@ void LineGenerator::addCircularArc(Vec3 aRelativeToCenter, Vec3 velocityOutOfA,
 			const auto surfaceNormal = 
 				tubeRadius * 
 				(circlePoint.x * curveNormal + circlePoint.y * curveBinormal);
-			const auto surfacePosition = curvePosition + surfaceNormal;
-			positions.push_back(surfacePosition);
-			normals.push_back(surfaceNormal);
+			positions[vertex] = curvePosition + surfaceNormal;
+			normals[vertex] = surfaceNormal;
+			vertex++;
 		}
 	}
 	for (i32 circleI = 0; circleI < count - 1; circleI++) {
@@ -57,6 +57,7 @@ void onWindowSizeChange(Vec2 size) {
 }
 
 void MainLoop::update() {
+	frameArena.reset();
 	ShaderManager::update();
 
     
@@ -71,5 +72,5 @@ void MainLoop::update() {
         windowSize = currentWindowSize;
     }
 	//game.update(renderer);
-	minesweeper.update(renderer);
+	minesweeper.update(renderer, frameArena);
 }
\ No newline at end of file
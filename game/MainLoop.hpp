@@ -2,6 +2,7 @@
 
 #include <game/Game.hpp>
 #include <game/Minesweeper.hpp>
+#include <game/FrameArena.hpp>
 
 struct MainLoop {
 	MainLoop();
@@ -11,4 +12,6 @@ struct MainLoop {
 	//Game game;
 	Minesweeper minesweeper;
 	GameRenderer renderer;
+	// Reset at the start of every update.
+	FrameArena frameArena;
 };
\ No newline at end of file
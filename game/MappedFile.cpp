@@ -0,0 +1,123 @@
+#include "MappedFile.hpp"
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+std::optional<MappedFile> MappedFile::open(const char* path) {
+	MappedFile result;
+	result.fileHandle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (result.fileHandle == INVALID_HANDLE_VALUE) {
+		result.fileHandle = nullptr;
+		return std::nullopt;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(result.fileHandle, &size)) {
+		return std::nullopt;
+	}
+	result.size = usize(size.QuadPart);
+	// Mapping an empty file fails.
+	if (result.size == 0) {
+		return result;
+	}
+	result.mappingHandle = CreateFileMappingA(result.fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (result.mappingHandle == nullptr) {
+		return std::nullopt;
+	}
+	result.bytes = reinterpret_cast<const u8*>(MapViewOfFile(result.mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (result.bytes == nullptr) {
+		return std::nullopt;
+	}
+	return result;
+}
+
+void MappedFile::close() {
+	if (bytes != nullptr) {
+		UnmapViewOfFile(bytes);
+	}
+	if (mappingHandle != nullptr) {
+		CloseHandle(mappingHandle);
+	}
+	if (fileHandle != nullptr) {
+		CloseHandle(fileHandle);
+	}
+	bytes = nullptr;
+	size = 0;
+	mappingHandle = nullptr;
+	fileHandle = nullptr;
+}
+
+#else
+
+std::optional<MappedFile> MappedFile::open(const char* path) {
+	const auto file = ::open(path, O_RDONLY);
+	if (file == -1) {
+		return std::nullopt;
+	}
+	struct stat status;
+	if (fstat(file, &status) != 0) {
+		::close(file);
+		return std::nullopt;
+	}
+	MappedFile result;
+	result.size = usize(status.st_size);
+	// Mapping an empty file fails.
+	if (result.size == 0) {
+		::close(file);
+		return result;
+	}
+	const auto mapped = mmap(nullptr, result.size, PROT_READ, MAP_PRIVATE, file, 0);
+	// The mapping stays valid after closing the file.
+	::close(file);
+	if (mapped == MAP_FAILED) {
+		return std::nullopt;
+	}
+	result.bytes = reinterpret_cast<const u8*>(mapped);
+	return result;
+}
+
+void MappedFile::close() {
+	if (bytes != nullptr) {
+		munmap(const_cast<u8*>(bytes), size);
+	}
+	bytes = nullptr;
+	size = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this == &other) {
+		return *this;
+	}
+	close();
+	bytes = std::exchange(other.bytes, nullptr);
+	size = std::exchange(other.size, 0);
+#ifdef _WIN32
+	fileHandle = std::exchange(other.fileHandle, nullptr);
+	mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+	return *this;
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+View<const u8> MappedFile::data() const {
+	return View<const u8>(bytes, size);
+}
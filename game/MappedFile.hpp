@@ -0,0 +1,28 @@
+#pragma once
+
+#include <Types.hpp>
+#include <View.hpp>
+#include <optional>
+
+// Read only memory mapping of a whole file. The file is unmapped when the object is destroyed.
+struct MappedFile {
+	static std::optional<MappedFile> open(const char* path);
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	View<const u8> data() const;
+
+	MappedFile() = default;
+	void close();
+
+	const u8* bytes = nullptr;
+	usize size = 0;
+#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+#endif
+};
@@ -10,7 +10,9 @@
 #include <engine/Math/Frustum.hpp>
 #include <game/Math.hpp>
 #include <game/4d.hpp>
-#include <engine/Math/Circle.hpp>
+#include <game/TilingFile.hpp>
+#include <game/StereographicBatch.hpp>
+#include <game/StereographicArc.hpp>
 #include <engine/Math/Angles.hpp>
 #include <StringStream.hpp>
 #include <Put.hpp>
@@ -27,17 +29,10 @@ if bomb count = cell count then just set win on first move.
 
 #include <Timer.hpp>
 #include <fstream>
-
-i32 boardCellCount[]{
-	144,
-	120,
-	216,
-	600,
-	720
-};
+#include <cstdio>
 
 Minesweeper::Minesweeper()
-	: t(Polytope())
+	: t()
 	, rng(dev()) {
 
 	auto& style = ImGui::GetStyle();
@@ -74,9 +69,8 @@ Minesweeper::Minesweeper()
 	style.PopupRounding = 4;
 	style.GrabRounding = 3;
 
-	const auto defaultDensity = 0.15f;
-	for (i32 i = 0; i < 5; i++) {
-		bombCountSettings[i] = floor(boardCellCount[i] * defaultDensity);
+	for (i32 i = 0; i < i32(std::size(bombCountSettings)); i++) {
+		bombCountSettings[i] = defaultBombCount(Board(i));
 	}
 	/*bombCountSettings[i32(Board::CELL_24_SNUB)] = floor(144 * defaultDensity);
 	bombCountSettings[i32(Board::CELL_120)] = floor(120 * defaultDensity);
@@ -119,7 +113,7 @@ struct GameInput {
 	bool rightMouseDown = false;
 };
 
-void Minesweeper::update(GameRenderer& renderer) {
+void Minesweeper::update(GameRenderer& renderer, FrameArena& frameArena) {
 	/*if (Input::isKeyDown(KeyCode::ESCAPE)) {
 		Window::toggleCursor();
 	}*/
@@ -193,44 +187,30 @@ void Minesweeper::update(GameRenderer& renderer) {
 	const auto view4 = stereographicCamera.view4();
 	const auto frustum = Frustum::fromMatrix(renderer.projection * renderer.view);
 
-	std::vector<Vec4> transformedVertices4;
-	for (const auto& vertex : t.vertices) {
-		transformedVertices4.push_back(view4 * vertex);
-	}
-
-	f32 diameter = 0.0f;
-	{
-		std::vector<Vec4> v;
-		auto& vertices = t.cells[0].vertices;
-		for (const auto& vertex : vertices) {
-			v.push_back(t.vertices[vertex]);
-		}
-
-		for (i32 i = 0; i < v.size(); i++) {
-			for (i32 j = i + 1; j < v.size(); j++) {
-				const auto d = (v[i] - v[j]).length();
-				if (d > diameter) {
-					diameter = d;
-				}
-			}
-		}
-	}
-
-	// Non regular polytopes have multiple cell sizes, but it looks good as is so I will leave it like that.
-	//const auto edgeLength = (t.vertices[t.edges[0].vertices[0]] - t.vertices[t.edges[0].vertices[1]]).length();
-	const auto polytopeScale = diameter / 0.756f; 
 	stereographicCamera.movementSpeed = polytopeScale * 0.4f;
 	const auto textSize = 0.1f * polytopeScale;
 	const auto sphereRadius = textSize / 2.5f;
 	const auto segmentWidth = 0.005f * polytopeScale;
 
+	// The camera is at the origin of the projected space. The point projected to the origin is the antipode of the camera position, which is projected to infinity.
+	const auto cameraPoint4 = -stereographicCamera.pos4();
+	// Everything below only looks at the cells and edges near the camera. On the small boards these are all of them.
+	visibility.query(cameraPoint4);
 
-	std::vector<Vec3> cellCentersTransformed;
-	for (const auto& cell : t.cells) {
-		const auto p4 = view4 * cell.centroid;
-		const auto p3 = stereographicProjection(p4);
-		cellCentersTransformed.push_back(p3);
-		//renderer.sphere(p3, 0.01f, Color3::GREEN);
+	if (visibility.everythingVisible()) {
+		stereographicProjection(view4, constView(t.cellCentroids), View<Vec3>(cellCentersTransformed.data(), cellCentersTransformed.size()), frameArena.allocateArray<u64>(stereographicInfinityMaskWordCount(t.cellCount())));
+	} else {
+		// The centroids of the visible cells are gathered so that they can be projected in one batch.
+		const auto visibleCount = i64(visibility.visibleCells.size());
+		auto centroids = frameArena.allocateArray<Vec4>(visibleCount);
+		for (i64 i = 0; i < visibleCount; i++) {
+			centroids[i] = t.cellCentroids[visibility.visibleCells[i]];
+		}
+		auto projected = frameArena.allocateArray<Vec3>(visibleCount);
+		stereographicProjection(view4, View<const Vec4>(centroids.data(), visibleCount), projected, frameArena.allocateArray<u64>(stereographicInfinityMaskWordCount(visibleCount)));
+		for (i64 i = 0; i < visibleCount; i++) {
+			cellCentersTransformed[visibility.visibleCells[i]] = projected[i];
+		}
 	}
 
 	struct Hit {
@@ -239,7 +219,11 @@ void Minesweeper::update(GameRenderer& renderer) {
 	};
 	std::optional<Hit> closestUnrevealedHit;
 	std::optional<Hit> closestHit;
-	for (CellIndex cellI = 0; cellI < t.cells.size(); cellI++) {
+	// The ray goes along the z axis, which is the view space direction (0, 0, 1, 0) at the camera.
+	const auto cameraForward4 = stereographicCamera.view4Inversed() * Vec4(0.0f, 0.0f, 1.0f, 0.0f);
+	pickingCandidates.clear();
+	picking.query(cameraPoint4, cameraForward4, CellPicking::maxAngularDistanceForSphereRadius(sphereRadius), pickingCandidates);
+	for (const auto& cellI : pickingCandidates) {
 		auto& center = cellCentersTransformed[cellI];
 		//renderer.sphere(center, radius, Color3::GREEN);
 		const auto i = raySphereIntersection(ray, center, sphereRadius);
@@ -248,7 +232,7 @@ void Minesweeper::update(GameRenderer& renderer) {
 			continue;
 		}
 
-		if (!isRevealed[cellI]) {
+		if (!board.isRevealed(cellI)) {
 			if (!closestUnrevealedHit.has_value() || *i < closestUnrevealedHit->t) {
 				closestUnrevealedHit = Hit{
 					.cellI = cellI,
@@ -257,7 +241,7 @@ void Minesweeper::update(GameRenderer& renderer) {
 			}
 		}
 
-		if (!isRevealed[cellI] || (isRevealed[cellI] && neighbouringBombsCount[cellI] != 0)) {
+		if (!board.isRevealed(cellI) || (board.isRevealed(cellI) && board.neighbouringBombCount(cellI) != 0)) {
 			if (!closestHit.has_value() || *i < closestHit->t) {
 				closestHit = Hit{
 					.cellI = cellI,
@@ -269,9 +253,13 @@ void Minesweeper::update(GameRenderer& renderer) {
 	}
 	const auto hoverAnimationTimeToFinish = 0.1f;
 	if (closestUnrevealedHit.has_value()) {
-		updateConstantSpeedT(cellHoverAnimationT[closestUnrevealedHit->cellI], hoverAnimationTimeToFinish, true);
+		auto& hoverT = cellHoverAnimationT[closestUnrevealedHit->cellI];
+		if (hoverT == 0.0f) {
+			animatedCells.push_back(closestUnrevealedHit->cellI);
+		}
+		updateConstantSpeedT(hoverT, hoverAnimationTimeToFinish, true);
 		//renderer.sphere(ray.at(closestHit->t), 0.01f, Color3::WHITE);
-		if (!isMarked[closestUnrevealedHit->cellI] && input.leftMouseDown) {
+		if (!board.isMarked(closestUnrevealedHit->cellI) && input.leftMouseDown) {
 			if (state == State::BEFORE_FIRST_MOVE) {
 				startGame(closestUnrevealedHit->cellI);
 			} else {
@@ -280,8 +268,8 @@ void Minesweeper::update(GameRenderer& renderer) {
 		}
 
 		if (input.rightMouseDown) {
-			if (!isRevealed[closestUnrevealedHit->cellI]) {
-				isMarked[closestUnrevealedHit->cellI] = !isMarked[closestUnrevealedHit->cellI];
+			if (!board.isRevealed(closestUnrevealedHit->cellI)) {
+				board.toggleMarked(closestUnrevealedHit->cellI);
 			}
 		}
 	}
@@ -296,35 +284,28 @@ void Minesweeper::update(GameRenderer& renderer) {
 	}
 
 
-	i32 cellsRevealed = 0;
-	for (const auto& revaled : isRevealed) {
-		if (revaled) {
-			cellsRevealed++;
-		}
-	}
-	//ImGui::Text("%d/%d cells revealed", cellsRevealed, t.cells.size());
+	//ImGui::Text("%d/%d cells revealed", board.revealedCount, t.cellCount());
 
-	for (CellIndex i = 0; i < t.cells.size(); i++) {
+	std::erase_if(animatedCells, [&](CellIndex i) {
 		if (closestUnrevealedHit.has_value() && closestUnrevealedHit->cellI == i) {
-			continue;
+			return false;
 		}
 		updateConstantSpeedT(cellHoverAnimationT[i], hoverAnimationTimeToFinish, false);
-	}
+		return cellHoverAnimationT[i] == 0.0f;
+	});
 
-	std::vector<CellIndex> cellsSortedByDistance;
-	for (CellIndex i = 0; i < t.cells.size(); i++) {
-		cellsSortedByDistance.push_back(i);
-	}
+	cellsSortedByDistance.assign(visibility.visibleCells.begin(), visibility.visibleCells.end());
 	std::ranges::sort(cellsSortedByDistance, [&](i32 a, i32 b) {
 		return cellCentersTransformed[a].z > cellCentersTransformed[b].z;
 	});
-	std::vector<bool> isHighligtedCellNeighbour;
-	isHighligtedCellNeighbour.resize(t.cells.size(), false);
-	if (highlightNeighbours.has_value()) {
-		for (const auto& neighbour : cellToNeighbours[*highlightNeighbours]) {
-			isHighligtedCellNeighbour[neighbour] = true;
+	// The neighbours are sorted so this doesn't need a per cell array that would have to be cleared every frame.
+	auto isHighligtedCellNeighbour = [&](CellIndex cellI) {
+		if (!highlightNeighbours.has_value()) {
+			return false;
 		}
-	}
+		const auto neighbours = board.neighbours[*highlightNeighbours];
+		return std::binary_search(neighbours.begin(), neighbours.end(), cellI);
+	};
 
 
 	for (const auto& cellI : cellsSortedByDistance) {
@@ -337,7 +318,7 @@ void Minesweeper::update(GameRenderer& renderer) {
 			continue;
 		}
 
-		const auto c = neighbouringBombsCount[cellI];
+		const auto c = board.neighbouringBombCount(cellI);
 
 		Vec3 colors[]{
 			Vec3(1.6f, 0.0f, 96.9f) / 100.0f,
@@ -362,7 +343,7 @@ void Minesweeper::update(GameRenderer& renderer) {
 
 		color = lerp(color, color * 0.5f, cellHoverAnimationT[cellI]);
 
-		const auto highlightedCellNeighbour = isHighligtedCellNeighbour[cellI];
+		const auto highlightedCellNeighbour = isHighligtedCellNeighbour(cellI);
 		const auto highlightedCell = highlightNeighbours.has_value() && cellI == *highlightNeighbours;
 
 		auto highlightedColor = [&](Vec3 color) {
@@ -377,17 +358,17 @@ void Minesweeper::update(GameRenderer& renderer) {
 			return color;
 		};
 
-		if (isRevealed[cellI]) {
-			if (isBomb[cellI]) {
+		if (board.isRevealed(cellI)) {
+			if (board.isBomb(cellI)) {
 				renderer.sphere(center, sphereRadius, highlightedColor(Vec3(0.05f)));
 			} else {
 				if (c >= 1) {
-					renderer.centertedText(center, textSize, std::to_string(c), highlightedColor(color));
+					renderer.centertedText(center, textSize, intToString(frameArena, c), highlightedColor(color));
 				}
 			}
 		} else {
 			Vec3 color;
-			if (isMarked[cellI]) {
+			if (board.isMarked(cellI)) {
 				if (highlightedCell) {
 					color = Vec3(1.0f, 0.44, 0.0f);
 				} else if (highlightedCellNeighbour) {
@@ -410,17 +391,8 @@ void Minesweeper::update(GameRenderer& renderer) {
 	static i32 maxAllowedPointCount = 5;
 	/*ImGui::SliderFloat("desired deviation", &desiredDeviation, 0.007, 0.1f);
 	ImGui::SliderInt("max allowed point count", &maxAllowedPointCount, 5, 20);*/
-	auto drawSegment = [&renderer, &frustum, &segmentWidth](Vec4 e0, Vec4 e1) {
-
-		const auto p0 = stereographicProjection(e0);
-		const auto p1 = stereographicProjection(e1);
-
-		auto velocityOutOfAToB = [](Vec4 a, Vec4 b) {
-			const auto velocity4 = (b - dot(b, a.normalized()) * a.normalized()).normalized();
-			const auto velocity3 = stereographicProjectionJacobian(a, velocity4);
-			return velocity3;
-		};
-
+	// The endpoints in view space and their projections.
+	auto drawSegment = [&renderer, &frustum, &segmentWidth](Vec4 e0, Vec4 e1, Vec3 p0, Vec3 p1) {
 		auto drawLineWithFrustumCulling = [&renderer, &segmentWidth, &frustum](Vec3 v0, Vec3 v1) {
 			const auto box = Box3::containingRoundCappedCyllinder(v0, v1, segmentWidth);
 			if (!frustum.intersects(box)) {
@@ -429,119 +401,79 @@ void Minesweeper::update(GameRenderer& renderer) {
 			renderer.line(v0, v1, segmentWidth, Color3::WHITE);
 		};
 
-		if (isPointAtInfinity(p0) && isPointAtInfinity(p1)) {
-			// Can't tell if they are connected by a line going though infinity or going though the origin. I suspect that it's probably though infinity, but then there is nothing to draw.
+		const auto segment = StereographicSegment::fromProjectedEndpoints(e0, e1, p0, p1);
+		if (segment.type == StereographicSegment::Type::LINE) {
+			drawLineWithFrustumCulling(segment.line.e[0], segment.line.e[1]);
 			return;
-		} else if (isPointAtInfinity(p0) || isPointAtInfinity(p1)) {
-			auto atInfinity = p0;
-			auto finite = p1;
-			auto atInfinity4 = e0;
-			auto finite4 = e1;
-			if (isPointAtInfinity(finite)) {
-				std::swap(atInfinity, finite);
-				std::swap(atInfinity4, finite4);
-			}
-			// Which direction should infinity be aproached from?
-			// I know that the line goes though the origin and the finite point.
-			const auto directionFromFiniteToInfinity = velocityOutOfAToB(finite4, atInfinity4).normalized();
-			drawLineWithFrustumCulling(finite, finite + directionFromFiniteToInfinity * 1000.0f);
-		} else {
-			auto p2 = antipodalPoint(p0);
-			if (isPointAtInfinity(p2)) {
-				p2 = antipodalPoint(p1);
-				if (isPointAtInfinity(p2)) {
-					// This would probably mean that the 2 points are very near the origin. 
-					// Could draw a line.
-					CHECK_NOT_REACHED();
-					return;
-				}
-			}
-			// Lets assume the 3 points are distinct. That is p0 and p1 are not antipodal. This shouldn't be the case when the points near enough to eachother. For example like in a polytope.
-
-			const auto velocityOutOfP0ToP1 = velocityOutOfAToB(e0, e1);
-
-			const auto coordinateSystemOrigin = p0;
-			Vec3 v0 = p2 - coordinateSystemOrigin;
-			Vec3 v1 = p1 - coordinateSystemOrigin;
-			const auto b0 = v0.normalized();
-			const auto b1 = (v1 - dot(v1, b0) * b0).normalized();
-			auto coordinatesInBasis = [&b0, &b1](Vec3 v) -> Vec2 {
-				return Vec2(dot(v, b0), dot(v, b1));
-			};
-			auto fromCoordinatesInBasis = [&b0, &b1, &coordinateSystemOrigin](Vec2 v) -> Vec3 {
-				return v.x * b0 + v.y * b1 + coordinateSystemOrigin;
-			};
-			const auto c0 = Vec2(0.0f);
-			const auto c1 = coordinatesInBasis(v0);
-			const auto c2 = coordinatesInBasis(v1);
-			const auto circle = Circle::thoughPoints(c0, c1, c2);
-			Vec3 center = fromCoordinatesInBasis(circle.center);
-			const auto radius = circle.radius;
-
-			
-			auto circularDistance = [](Vec3 a, Vec3 b) {
-				return acos(std::clamp(dot(a.normalized(), b.normalized()), -1.0f, 1.0f));
-			};
-			f32 d = circularDistance(p0 - center, p1 - center);
-			const auto p = (p0 - center);
-			const auto v = velocityOutOfP0ToP1.normalized() * p.length();
-			
-			{
-				const auto calculatedEndpoint0 = center + p * cos(d) + v * sin(d);
-				const auto calculatedEndpoint1 = center + p * cos(TAU<f32> -d) + v * sin(TAU<f32> -d);
-				const auto correctEndpoint = p1;
-				if (calculatedEndpoint0.distanceTo(correctEndpoint) > calculatedEndpoint1.distanceTo(correctEndpoint)) {
-					d = TAU<f32> -d;
-				}
-			}
+		}
 
-			if (abs(d) < 0.01f || abs(d - TAU<f32>) < 0.01f) {
-				// If the angle is too small then the above check may not work due to floating point errors. This guess can sometimes be wrong that is when the case abs(d - TAU<f32>) actually happens, but it seems to work fine for now.
-				drawLineWithFrustumCulling(p0, p1);
-			} else {
-				const auto box = Box3::containingCircleArcTube(center, p, v, d, segmentWidth);
-				
-				if (frustum.intersects(box)) {
-					const auto pointCount = circleArcPointCountRequiredToAchiveError(desiredDeviation, radius, d, maxAllowedPointCount);
-					if (!pointCount.has_value()) {
-						return;
-					}
-					if (*pointCount == 2) {
-						renderer.line(p0, p1, segmentWidth, Color3::WHITE);
-					} else {
-						renderer.lineGenerator.addCircularArc(p, v, center, d, segmentWidth, *pointCount);
-					}
-				}
-			}
+		const auto& arc = segment.circular;
+		const auto d = arc.angle;
+		if (d < 0.01f || abs(d - TAU<f32>) < 0.01f) {
+			// The circle is almost a line. An angle of almost TAU would mean that the arc goes almost all the way around though infinity, which shouldn't happen for edges of a polytope, so it's also treated as a floating point error.
+			drawLineWithFrustumCulling(p0, p1);
+			return;
+		}
+		const auto box = Box3::containingCircleArcTube(arc.center, arc.start, arc.initialVelocity, d, segmentWidth);
+		if (!frustum.intersects(box)) {
+			return;
+		}
+		const auto radius = arc.start.length();
+		const auto pointCount = circleArcPointCountRequiredToAchiveError(desiredDeviation, radius, d, maxAllowedPointCount);
+		if (!pointCount.has_value()) {
+			return;
+		}
+		if (*pointCount == 2) {
+			renderer.line(p0, p1, segmentWidth, Color3::WHITE);
+		} else {
+			renderer.lineGenerator.addCircularArc(arc.start, arc.initialVelocity, arc.center, d, segmentWidth, *pointCount);
 		}
 	};
 
 	i32 edgesDrawn = 0;
-	for (const auto& edge : t.edges) {
-		const auto e0 = transformedVertices4[edge.vertices[0]];
-		const auto e1 = transformedVertices4[edge.vertices[1]];
-		drawSegment(e0, e1);
+	// The edges that can be instanced are bent by the vertex shader so they don't need to be projected here. The endpoints of the remaining edge i are 2 i and 2 i + 1.
+	const auto instancedArcs = renderer.useInstancedStereographicArcs;
+	const auto pointAtInfinity = stereographicCamera.pos4();
+	auto endpoints = frameArena.allocateArray<Vec4>(2 * i64(visibility.visibleEdges.size()));
+	i64 edgeCount = 0;
+	for (const auto& edgeI : visibility.visibleEdges) {
+		const auto& edge = t.edges[edgeI];
+		const auto e0 = t.vertices[edge.vertices[0]];
+		const auto e1 = t.vertices[edge.vertices[1]];
+		if (instancedArcs && isStereographicArcInstanceable(e0, e1, pointAtInfinity)) {
+			renderer.stereographicArc(e0, e1, segmentWidth, Color3::WHITE);
+			continue;
+		}
+		endpoints[2 * edgeCount] = e0;
+		endpoints[2 * edgeCount + 1] = e1;
+		edgeCount++;
 	}
+	const auto endpointCount = 2 * edgeCount;
+	auto endpoints4 = frameArena.allocateArray<Vec4>(endpointCount);
+	auto endpoints3 = frameArena.allocateArray<Vec3>(endpointCount);
+	auto atInfinity = frameArena.allocateArray<u64>(stereographicInfinityMaskWordCount(endpointCount));
+	stereographicProjection(view4, View<const Vec4>(endpoints.data(), endpointCount), endpoints4, endpoints3, atInfinity);
 
-	 //should also win if every non bomb cell is revealed
-	const auto nonBombCellsCount = t.cells.size() - bombCount;
-	if (state == State::GAME_IN_PROGRESS) {
-		i32 nonBombCellsUncovered = 0;
-		for (CellIndex i = 0; i < t.cells.size(); i++) {
-			if (!isBomb[i] && isRevealed[i]) {
-				nonBombCellsUncovered++;
-			}
-		}
-		if (nonBombCellsUncovered == nonBombCellsCount) {
-			state = State::WON;
-			openMenu();
+	const View<const u64> mask(atInfinity.data(), atInfinity.size());
+	for (i64 i = 0; i < edgeCount; i++) {
+		if (isPointAtInfinity(mask, 2 * i) && isPointAtInfinity(mask, 2 * i + 1)) {
+			// Can't tell if they are connected by a line going though infinity or going though the origin. It's probably though infinity, but then there is nothing to draw.
+			continue;
 		}
+		drawSegment(endpoints4[2 * i], endpoints4[2 * i + 1], endpoints3[2 * i], endpoints3[2 * i + 1]);
+	}
+
+	 //should also win if every non bomb cell is revealed
+	if (state == State::GAME_IN_PROGRESS && board.hiddenNonBombCount == 0) {
+		state = State::WON;
+		openMenu();
 	}
 
 	//ImGui::Text("%d/%d edges drawn", edgesDrawn, t.edges.size());
 
 	renderer.renderHemispheres();
 	renderer.renderCyllinders();
+	renderer.renderStereographicArcs();
 
 	//ImGui::Text("line triangle count %d", renderer.lineGenerator.indices.size() / 3);
 	renderer.coloredTrianglesAddMesh(renderer.lineGenerator, Color3::WHITE);
@@ -619,30 +551,21 @@ void Minesweeper::update(GameRenderer& renderer) {
 		ImGui::GetForegroundDrawList()->AddCircleFilled(ImVec2(pos.x, pos.y), 4.0f, 0xFFFFFFFF);*/
 	} else {
 		auto& dl = *ImGui::GetForegroundDrawList();
-		auto io = ImGui::GetIO();
+		auto& io = ImGui::GetIO();
 		{
-			i32 markedCount = 0;
-			i32 revealedCount = 0;
-			for (i32 i = 0; i < t.cells.size(); i++) {
-				if (isMarked[i]) {
-					markedCount++;
-				}
-				if (isRevealed[i]) {
-					revealedCount++;
-				}
-			}
 			if (state != State::LOST && state != State::WON) {
 				//StringStream s;
-				std::stringstream s;
-				put(s, "bombs: %\nmarked: %\nrevealed: %/%", bombCount, markedCount, revealedCount, t.cells.size());
+				// Formatting into a fixed buffer, because a stream would allocate every frame.
+				char str[128];
+				const auto length = snprintf(str, std::size(str), "bombs: %d\nmarked: %d\nrevealed: %d/%d", bombCount, board.markedCount, board.revealedCount, t.cellCount());
+				const auto strEnd = str + std::clamp(length, 0, i32(std::size(str)) - 1);
 				//put(s, "bombs: %", bombCount);
 				auto& font = io.FontDefault;
 				//put("%", s.string());
 				f32 size = 30.0f;
 				const auto addText = [&](f32 x, f32 y, u32 color = 0xF0000000) {
 					f32 offset = 5.0f;
-					const auto& str = s.str();
-					dl.AddText(font, size, ImVec2(x + offset, y + offset), color, str.c_str(), str.c_str() + str.size());
+					dl.AddText(font, size, ImVec2(x + offset, y + offset), color, str, strEnd);
 					};
 				addText(1, 1);
 				addText(-1, -1);
@@ -743,7 +666,7 @@ void Minesweeper::menuGui() {
 	/*Tiling tiling(makeSubdiviedHypercube2());
 	const auto n = tiling.cellsNeighbouringToCell();
 	i32 maxNeighbourCount = 0;
-	for (i32 i = 0; i < t.cells.size(); i++) {
+	for (i32 i = 0; i < t.cellCount(); i++) {
 		maxNeighbourCount = std::max(i32(n[i].size()), maxNeighbourCount);
 	}*/
 	i32 maxNeighbourCounts[]{
@@ -752,11 +675,19 @@ void Minesweeper::menuGui() {
 		26, // SUBDIVIDED_HYPERCUBE,
 		56, // CELL_600,
 		32, // CELL_600_RECTIFIED,
+		26, // LARGE_SUBDIVIDED_HYPERCUBE,
 	};
 
 	if (uiTableBegin("game")) {
 		combo("board", reinterpret_cast<int*>(&boardSetting), constView(boardStrings));
-		sliderInt("bomb count", bombCountSettings[i32(boardSetting)], 0, boardCellCount[i32(boardSetting)] - maxNeighbourCounts[i32(boardSetting)] - 1);
+		if (boardSetting == Board::LARGE_SUBDIVIDED_HYPERCUBE) {
+			const auto oldDivisionCount = divisionCountSetting;
+			sliderInt("divisions", divisionCountSetting, 2, 22);
+			if (divisionCountSetting != oldDivisionCount) {
+				bombCountSettings[i32(boardSetting)] = defaultBombCount(boardSetting);
+			}
+		}
+		sliderInt("bomb count", bombCountSettings[i32(boardSetting)], 0, boardCellCount(boardSetting) - maxNeighbourCounts[i32(boardSetting)] - 1);
 		ImGui::EndTable();
 	}
 
@@ -823,24 +754,73 @@ void Minesweeper::closeMenu() {
 
 void Minesweeper::loadBoard(Board board) {
 	loadedBoard = board;
+	// The files are created by the tilingConverter tool.
+	const char* fileName = "";
 	switch (board) {
 		using enum Board;
-	case CELL_120: loadBoard(make120cell()); break;
-	case SUBDIVIDED_HYPERCUBE: loadBoard(makeSubdiviedHypercube2()); break;
-	case CELL_600: loadBoard(make600cell()); break;
-	case CELL_600_RECTIFIED: loadBoard(makeRectified600cell()); break;
-	case CELL_24_SNUB: loadBoard(makeSnub24cell()); break;
+	case CELL_120: fileName = "120cell.tiling"; break;
+	case SUBDIVIDED_HYPERCUBE: fileName = "subdiviedHypercube.tiling"; break;
+	case CELL_600: fileName = "600cell.tiling"; break;
+	case CELL_600_RECTIFIED: fileName = "rectified600cell.tiling"; break;
+	case CELL_24_SNUB: fileName = "snub24cell.tiling"; break;
+	case LARGE_SUBDIVIDED_HYPERCUBE:
+		loadBoard(GeneratedBoard{ .divisionCount = divisionCountSetting });
+		return;
 	}
+	const auto path = std::string(TILING_FILES_DIRECTORY) + fileName;
+	auto loaded = loadTilingFile(path.c_str());
+	if (!loaded.has_value()) {
+		put("failed to load %", path);
+		CHECK_NOT_REACHED();
+		return;
+	}
+	loadBoard(std::move(loaded->tiling), loaded->cellsSharingVertex);
 }
 
-void Minesweeper::loadBoard(const Polytope& polytope) {
+void Minesweeper::loadBoard(const GeneratedBoard& board) {
+	// Generating the largest boards takes a few seconds so they are cached.
+	auto loaded = tilingCache.get(TilingCache::key("subdiviedHypercube4", board.divisionCount), [&] {
+		return subdiviedHypercube4(board.divisionCount);
+	});
+	loadBoard(std::move(loaded.tiling), loaded.cellsSharingVertex);
+}
+
+void Minesweeper::loadBoard(const FlatPolytope4& polytope) {
+	Tiling tiling(polytope);
+	const auto cellsSharingVertex = tiling.cellsSharingVertex();
+	loadBoard(std::move(tiling), cellsSharingVertex);
+}
+
+void Minesweeper::loadBoard(Tiling&& tiling, const CellAdjacency& cellsSharingVertex) {
 	highlightNeighbours = std::nullopt;
 	bombCount = bombCountSettings[i32(loadedBoard)];
-	t = Tiling(polytope);
-	cellToNeighbours = t.cellsNeighbouringToCell();
-	cellHoverAnimationT.resize(t.cells.size(), 0.0f);
+	t = std::move(tiling);
+	board.initialize(cellsSharingVertex);
+	cellHoverAnimationT.clear();
+	cellHoverAnimationT.resize(t.cellCount(), 0.0f);
+	animatedCells.clear();
+	cellCentersTransformed.resize(t.cellCount());
 	initialize();
 
+	f32 diameter = 0.0f;
+	{
+		const auto vertices = t.verticesOfCell(0);
+		for (i32 i = 0; i < vertices.size(); i++) {
+			for (i32 j = i + 1; j < vertices.size(); j++) {
+				const auto d = (t.vertices[vertices[i]] - t.vertices[vertices[j]]).length();
+				if (d > diameter) {
+					diameter = d;
+				}
+			}
+		}
+	}
+	// Non regular polytopes have multiple cell sizes, but it looks good as is so I will leave it like that.
+	//const auto edgeLength = (t.vertices[t.edges[0].vertices[0]] - t.vertices[t.edges[0].vertices[1]]).length();
+	polytopeScale = diameter / 0.756f;
+
+	visibility.build(t, MAX_VISIBLE_CELL_COUNT);
+	picking.build(t, visibility);
+
 	auto moveTo = [&](Vec4 p) {
 		Vec4 origin = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
 		const auto movement = movementForwardOnSphere(
@@ -849,12 +829,12 @@ void Minesweeper::loadBoard(const Polytope& polytope) {
 		);
 		stereographicCamera.transformation = movement;
 	};
-	auto& face = t.faces[0];
+	const auto face = t.verticesOfFace(0);
 	Vec4 center(0.0f);
-	for (const auto& vertex : face.vertices) {
+	for (const auto& vertex : face) {
 		center += t.vertices[vertex];
 	}
-	center /= face.vertices.size();
+	center /= f32(face.size());
 	center = center.normalized();
 	/*const auto a = t.vertices[t.edges[0].vertices[0]];
 	const auto b = t.vertices[t.edges[0].vertices[1]];
@@ -862,17 +842,30 @@ void Minesweeper::loadBoard(const Polytope& polytope) {
 	moveTo(center);
 }
 
-void Minesweeper::initialize() {
-	isBomb.clear();
-	isBomb.resize(t.cells.size(), false);
-
-	isRevealed.clear();
-	isRevealed.resize(t.cells.size(), false);
+i32 Minesweeper::boardCellCount(Board board) const {
+	switch (board) {
+		using enum Board;
+	case CELL_24_SNUB: return 144;
+	case CELL_120: return 120;
+	case SUBDIVIDED_HYPERCUBE: return 216;
+	case CELL_600: return 600;
+	case CELL_600_RECTIFIED: return 720;
+	case LARGE_SUBDIVIDED_HYPERCUBE: {
+		const auto cubesPerEdge = divisionCountSetting + 1;
+		return 8 * cubesPerEdge * cubesPerEdge * cubesPerEdge;
+	}
+	}
+	CHECK_NOT_REACHED();
+	return 0;
+}
 
-	neighbouringBombsCount.resize(t.cells.size());
+i32 Minesweeper::defaultBombCount(Board board) const {
+	const auto defaultDensity = 0.15f;
+	return i32(floor(boardCellCount(board) * defaultDensity));
+}
 
-	isMarked.clear();
-	isMarked.resize(t.cells.size(), false);
+void Minesweeper::initialize() {
+	board.clear();
 }
 
 void Minesweeper::reveal(CellIndex cell) {
@@ -880,41 +873,22 @@ void Minesweeper::reveal(CellIndex cell) {
 		return;
 	}
 
-	if (isRevealed[cell]) {
+	if (board.isRevealed(cell)) {
 		return;
 	}
 
-	if (isBomb[cell]) {
+	if (board.isBomb(cell)) {
 		gameOver();
 		return;
 	}
 
-	/*std::vector<bool> visited;
-	visited.resize(t.cells.size());*/
-
-	std::vector<i32> toVisit;
-	toVisit.push_back(cell);
-	while (toVisit.size() > 0) {
-		const auto c = toVisit.back();
-		toVisit.pop_back();
-		isRevealed[c] = true;
-		if (neighbouringBombsCount[c] == 0) {
-			for (const auto& neighbour : cellToNeighbours[c]) {
-				if (isRevealed[neighbour] || isBomb[neighbour]) {
-					continue;
-				}
-				toVisit.push_back(neighbour);
-			}
-		}
-	}
+	board.reveal(cell);
 }
 
 void Minesweeper::gameOver() {
 	state = State::LOST;
 	openMenu();
-	for (CellIndex i = 0; i < t.cells.size(); i++) {
-		isRevealed[i] = true;
-	}
+	board.revealAll();
 }
 /*
 First move.
@@ -940,14 +914,14 @@ void Minesweeper::startGame(CellIndex firstUncoveredCell) {
 		break;
 	case FIRST_MOVE_EMPTY_CELL:
 		cellsToAvoid.insert(firstUncoveredCell);
-		for (const auto& neighbour : cellToNeighbours[firstUncoveredCell]) {
+		for (const auto& neighbour : board.neighbours[firstUncoveredCell]) {
 			cellsToAvoid.insert(neighbour);
 		}
 		break;
 	}
 
 	std::vector<CellIndex> possibleBombLocations;
-	for (CellIndex i = 0; i < t.cells.size(); i++) {
+	for (CellIndex i = 0; i < t.cellCount(); i++) {
 		if (!cellsToAvoid.contains(i)) {
 			possibleBombLocations.push_back(i);
 		}
@@ -960,18 +934,7 @@ void Minesweeper::startGame(CellIndex firstUncoveredCell) {
 		bombCount,
 		rng
 	);
-	for (const auto& cellI : bombLocations) {
-		isBomb[cellI] = true;
-	}
-	for (CellIndex i = 0; i < t.cells.size(); i++) {
-		auto& count = neighbouringBombsCount[i];
-		count = 0;
-		for (const auto& neighbour : cellToNeighbours[i]) {
-			if (isBomb[neighbour]) {
-				count++;
-			}
-		}
-	}
+	board.placeBombs(constView(bombLocations));
 
 	reveal(firstUncoveredCell);
 	state = State::GAME_IN_PROGRESS;
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <game/Tiling.hpp>
+#include <game/MinesweeperBoard.hpp>
+#include <game/CellPicking.hpp>
+#include <game/TilingCache.hpp>
+#include <game/FrameArena.hpp>
 #include <game/GameRenderer.hpp>
 #include <random>
 
 struct Minesweeper {
 	Minesweeper();
-	void update(GameRenderer& renderer);
+	// The arena is reset by the caller every frame.
+	void update(GameRenderer& renderer, FrameArena& frameArena);
 	void menuGui();
 	void openMenu();
 	void closeMenu();
@@ -15,12 +20,7 @@ struct Minesweeper {
 
 	bool isMenuOpen = true;
 
-	std::vector<std::vector<CellIndex>> cellToNeighbours;
-
-	std::vector<bool> isBomb;
-	std::vector<i32> neighbouringBombsCount;
-	std::vector<bool> isMarked;
-	std::vector<bool> isRevealed;
+	MinesweeperBoard board;
 
 	enum class State {
 		BEFORE_FIRST_MOVE,
@@ -42,6 +42,7 @@ struct Minesweeper {
 		SUBDIVIDED_HYPERCUBE,
 		CELL_600,
 		CELL_600_RECTIFIED,
+		LARGE_SUBDIVIDED_HYPERCUBE,
 	};
 	static constexpr const char* boardStrings[] = {
 		"snub 24 cell",
@@ -49,13 +50,25 @@ struct Minesweeper {
 		"subdivided hypercube",
 		"600 cell",
 		"rectified 600 cell",
+		"large subdivided hypercube",
+	};
+	// A board that isn't precomputed. The tiling is generated when the board is loaded for the first time and then stored in the tiling cache.
+	struct GeneratedBoard {
+		// The board has 8 (divisionCount + 1)^3 cells, so 10 divisions is around 10k cells and 22 divisions is around 100k cells.
+		i32 divisionCount;
 	};
 	void loadBoard(Board board);
-	void loadBoard(const Polytope& polytope);
+	void loadBoard(const GeneratedBoard& board);
+	void loadBoard(const FlatPolytope4& polytope);
+	void loadBoard(Tiling&& tiling, const CellAdjacency& cellsSharingVertex);
 	Board loadedBoard = Board::CELL_120;
 
 	Board boardSetting = Board::CELL_120;
-	i32 bombCountSettings[5];
+	i32 bombCountSettings[std::size(boardStrings)];
+	// Used by Board::LARGE_SUBDIVIDED_HYPERCUBE.
+	i32 divisionCountSetting = 10;
+	i32 boardCellCount(Board board) const;
+	i32 defaultBombCount(Board board) const;
 	//i32 bombCountSetting = 10;
 
 	i32 bombCount = 0;
@@ -67,6 +80,20 @@ struct Minesweeper {
 	std::optional<i32> highlightNeighbours;
 
 	std::vector<f32> cellHoverAnimationT;
+	// The cells with a non zero hover animation time. Only a few cells are animated at once so the rest don't need to be updated every frame.
+	std::vector<CellIndex> animatedCells;
+
+	// The size of the cells used to scale the things drawn in them.
+	f32 polytopeScale = 1.0f;
+	TilingVisibility visibility;
+	CellPicking picking;
+	// The candidates for the cell under the cursor. Kept between frames like cellsSortedByDistance.
+	std::vector<CellIndex> pickingCandidates;
+	// Indexed by cell, but only the visible cells are updated each frame.
+	std::vector<Vec3> cellCentersTransformed;
+	// Scratch buffer kept between frames so it doesn't have to be allocated every frame.
+	std::vector<CellIndex> cellsSortedByDistance;
+	TilingCache tilingCache;
 
 	void initialize();
 	void startGame(i32 firstUncoveredCellI);
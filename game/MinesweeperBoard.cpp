@@ -0,0 +1,112 @@
+#include "MinesweeperBoard.hpp"
+#include <Assertions.hpp>
+#include <algorithm>
+#include <bit>
+
+void MinesweeperBoard::initialize(const CellAdjacency& cellNeighbours) {
+	neighbours = cellNeighbours;
+	clear();
+}
+
+void MinesweeperBoard::clear() {
+	cells.clear();
+	cells.resize(neighbours.cellCount(), 0);
+	bombCount = 0;
+	revealedCount = 0;
+	markedCount = 0;
+	hiddenNonBombCount = cellCount();
+}
+
+void MinesweeperBoard::placeBombs(View<const CellIndex> bombCells) {
+	for (const auto& cell : bombCells) {
+		CHECK(!isBomb(cell));
+		cells[cell] |= BOMB;
+		for (const auto& neighbour : neighbours[cell]) {
+			cells[neighbour] += CellState(1 << COUNT_SHIFT);
+		}
+		if (!isRevealed(cell)) {
+			hiddenNonBombCount--;
+		}
+	}
+	bombCount += i32(bombCells.size());
+}
+
+void MinesweeperBoard::reveal(CellIndex cell) {
+	if (isRevealed(cell)) {
+		return;
+	}
+	CHECK(!isBomb(cell));
+
+	const auto wordCount = (cellCount() + 63) / 64;
+	frontier.resize(wordCount, 0);
+	nextFrontier.resize(wordCount, 0);
+
+	cells[cell] |= REVEALED;
+	frontier[cell / 64] |= u64(1) << (cell % 64);
+	// The range of the words that can be non zero.
+	i32 firstWord = cell / 64;
+	i32 lastWord = firstWord;
+	while (firstWord <= lastWord) {
+		i32 nextFirstWord = wordCount;
+		i32 nextLastWord = -1;
+		for (i32 wordI = firstWord; wordI <= lastWord; wordI++) {
+			auto word = frontier[wordI];
+			frontier[wordI] = 0;
+			while (word != 0) {
+				const auto c = wordI * 64 + std::countr_zero(word);
+				word &= word - 1;
+				revealedCount++;
+				hiddenNonBombCount--;
+				if (neighbouringBombCount(c) != 0) {
+					continue;
+				}
+				for (const auto& neighbour : neighbours[c]) {
+					if (cells[neighbour] & (REVEALED | BOMB)) {
+						continue;
+					}
+					cells[neighbour] |= REVEALED;
+					const auto neighbourWord = neighbour / 64;
+					nextFrontier[neighbourWord] |= u64(1) << (neighbour % 64);
+					nextFirstWord = std::min(nextFirstWord, neighbourWord);
+					nextLastWord = std::max(nextLastWord, neighbourWord);
+				}
+			}
+		}
+		std::swap(frontier, nextFrontier);
+		firstWord = nextFirstWord;
+		lastWord = nextLastWord;
+	}
+}
+
+void MinesweeperBoard::revealAll() {
+	for (auto& cell : cells) {
+		cell |= REVEALED;
+	}
+	revealedCount = cellCount();
+	hiddenNonBombCount = 0;
+}
+
+void MinesweeperBoard::toggleMarked(CellIndex cell) {
+	cells[cell] ^= MARKED;
+	markedCount += isMarked(cell) ? 1 : -1;
+}
+
+bool MinesweeperBoard::isBomb(CellIndex cell) const {
+	return cells[cell] & BOMB;
+}
+
+bool MinesweeperBoard::isRevealed(CellIndex cell) const {
+	return cells[cell] & REVEALED;
+}
+
+bool MinesweeperBoard::isMarked(CellIndex cell) const {
+	return cells[cell] & MARKED;
+}
+
+i32 MinesweeperBoard::neighbouringBombCount(CellIndex cell) const {
+	return cells[cell] >> COUNT_SHIFT;
+}
+
+i32 MinesweeperBoard::cellCount() const {
+	return i32(cells.size());
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <game/Tiling.hpp>
+
+/*
+The state of the Minesweeper cells without anything related to the geometry or rendering.
+
+Each cell is a single word containing the flags and the number of neighbouring bombs in the bits above them, so the reveal, which reads the state of a cell and its neighbours, touches one array instead of four separate ones. The neighbours are stored in compressed sparse row format.
+
+The reveal processes the cells in batches. The frontier contains the cells revealed in the previous step. The unrevealed neighbours without bombs of the cells in the frontier with no neighbouring bombs are revealed and form the next frontier. A cell is revealed when it's added to the frontier so it's never added twice and the neighbours of each cell are only read once. The frontiers are bitsets, which are iterated in the order of the cell indices. On the large boards most of the time was spent waiting for the neighbour lists of cells visited in a random order and in this order they are read mostly forward through memory.
+*/
+struct MinesweeperBoard {
+	using CellState = u16;
+	static constexpr CellState BOMB = 1 << 0;
+	static constexpr CellState REVEALED = 1 << 1;
+	static constexpr CellState MARKED = 1 << 2;
+	static constexpr i32 COUNT_SHIFT = 3;
+
+	// Copies the adjacency and clears the board.
+	void initialize(const CellAdjacency& cellNeighbours);
+	void clear();
+	// Also computes the number of neighbouring bombs of every cell.
+	void placeBombs(View<const CellIndex> bombCells);
+	// The cell can't be a bomb. Reveals the cell and if it has no neighbouring bombs floods through the neighbours with no bombs.
+	void reveal(CellIndex cell);
+	void revealAll();
+	void toggleMarked(CellIndex cell);
+
+	bool isBomb(CellIndex cell) const;
+	bool isRevealed(CellIndex cell) const;
+	bool isMarked(CellIndex cell) const;
+	i32 neighbouringBombCount(CellIndex cell) const;
+	i32 cellCount() const;
+
+	std::vector<CellState> cells;
+	CellAdjacency neighbours;
+
+	// Maintained by the functions above so nothing has to count the cells.
+	i32 bombCount = 0;
+	i32 revealedCount = 0;
+	i32 markedCount = 0;
+	// The game is won when this reaches zero.
+	i32 hiddenNonBombCount = 0;
+
+	// Bitsets with a bit for each cell. All zero between reveals.
+	std::vector<u64> frontier;
+	std::vector<u64> nextFrontier;
+};
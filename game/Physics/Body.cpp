@@ -30,6 +30,10 @@ void Body::set(float radiusToSet, float massToSet) {
 
 	radius = radiusToSet;
 	mass = massToSet;
+	// The entities are reused after being destroyed.
+	sleepTime = 0.0f;
+	wallIndex = -1;
+	wallMeshIndex = -1;
 	//width = w;
 	//mass = m;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <engine/Math/Vec4.hpp>
 #include <game/EntityArray.hpp>
+#include <View.hpp>
 
 struct Body {
 	Body();
@@ -18,7 +19,23 @@ struct Body {
 	f32 radius;
 	//Vec2 width;
 
-	bool s = false;
+	// Index into the walls array if the body is a wall. The wall geometry is stored separately so the loops that only update the state of moving bodies don't need to load it.
+	i32 wallIndex = -1;
+	bool isWall() const { return wallIndex != -1; }
+	// Index into the wall meshes array if the body is a wall mesh.
+	i32 wallMeshIndex = -1;
+	bool isWallMesh() const { return wallMeshIndex != -1; }
+
+	// How long the body has been moving slower than the sleep threshold.
+	f32 sleepTime = 0.0f;
+
+	float friction;
+	float mass, invMass;
+	//float I, invI;
+};
+
+// Static spherical triangle. The triangle is the set of points on the sphere lying on the plane with normal planeNormal and having a non negative dot product with each of the edge normals.
+struct Wall {
 	Vec4 planeNormal = Vec4(0.0f);
 	Vec4 v0 = Vec4(0.0f);
 	Vec4 v1 = Vec4(0.0f);
@@ -26,10 +43,6 @@ struct Body {
 	Vec4 edgeNormal0 = Vec4(0.0f);
 	Vec4 edgeNormal1 = Vec4(0.0f);
 	Vec4 edgeNormal2 = Vec4(0.0f);
-
-	float friction;
-	float mass, invMass;
-	//float I, invI;
 };
 
 struct BodyDefaultInitialize {
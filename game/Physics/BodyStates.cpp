@@ -0,0 +1,230 @@
+#include "BodyStates.hpp"
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BODY_STATES_SSE
+#include <emmintrin.h>
+#endif
+
+void BodyStates::clear() {
+	for (auto v : { &positionX, &positionY, &positionZ, &positionW, &velocityX, &velocityY, &velocityZ, &velocityW, &forceX, &forceY, &forceZ, &forceW, &invMass }) {
+		v->clear();
+	}
+}
+
+i32 BodyStates::count() const {
+	return i32(invMass.size());
+}
+
+void BodyStates::add(const Body& body) {
+	positionX.push_back(body.position.x);
+	positionY.push_back(body.position.y);
+	positionZ.push_back(body.position.z);
+	positionW.push_back(body.position.w);
+	velocityX.push_back(body.velocity.x);
+	velocityY.push_back(body.velocity.y);
+	velocityZ.push_back(body.velocity.z);
+	velocityW.push_back(body.velocity.w);
+	forceX.push_back(body.force.x);
+	forceY.push_back(body.force.y);
+	forceZ.push_back(body.force.z);
+	forceW.push_back(body.force.w);
+	invMass.push_back(body.invMass);
+}
+
+void BodyStates::gatherVelocities(View<Body* const> bodies) {
+	for (i32 i = 0; i < count(); i++) {
+		const auto& v = bodies[i]->velocity;
+		velocityX[i] = v.x;
+		velocityY[i] = v.y;
+		velocityZ[i] = v.z;
+		velocityW[i] = v.w;
+	}
+}
+
+void BodyStates::scatterVelocities(View<Body* const> bodies) const {
+	for (i32 i = 0; i < count(); i++) {
+		bodies[i]->velocity = Vec4(velocityX[i], velocityY[i], velocityZ[i], velocityW[i]);
+	}
+}
+
+void BodyStates::scatterPositionsAndVelocities(View<Body* const> bodies) const {
+	for (i32 i = 0; i < count(); i++) {
+		bodies[i]->position = Vec4(positionX[i], positionY[i], positionZ[i], positionW[i]);
+		bodies[i]->velocity = Vec4(velocityX[i], velocityY[i], velocityZ[i], velocityW[i]);
+	}
+}
+
+Vec4 BodyStates::position(i32 i) const {
+	return Vec4(positionX[i], positionY[i], positionZ[i], positionW[i]);
+}
+
+Vec4 BodyStates::velocity(i32 i) const {
+	return Vec4(velocityX[i], velocityY[i], velocityZ[i], velocityW[i]);
+}
+
+void BodyStates::setPositionAndVelocity(i32 i, Vec4 position, Vec4 velocity) {
+	positionX[i] = position.x;
+	positionY[i] = position.y;
+	positionZ[i] = position.z;
+	positionW[i] = position.w;
+	velocityX[i] = velocity.x;
+	velocityY[i] = velocity.y;
+	velocityZ[i] = velocity.z;
+	velocityW[i] = velocity.w;
+}
+
+// Same as projectVectorToSphereTangentSpace, but uses dot(p, p) instead of normalizing p, which avoids a square root.
+static void projectVelocityToSphereTangentSpace(BodyStates& s, i32 i) {
+	const auto pp = s.positionX[i] * s.positionX[i] + s.positionY[i] * s.positionY[i] + s.positionZ[i] * s.positionZ[i] + s.positionW[i] * s.positionW[i];
+	const auto vp = s.velocityX[i] * s.positionX[i] + s.velocityY[i] * s.positionY[i] + s.velocityZ[i] * s.positionZ[i] + s.velocityW[i] * s.positionW[i];
+	const auto d = vp / pp;
+	s.velocityX[i] -= d * s.positionX[i];
+	s.velocityY[i] -= d * s.positionY[i];
+	s.velocityZ[i] -= d * s.positionZ[i];
+	s.velocityW[i] -= d * s.positionW[i];
+}
+
+#ifdef BODY_STATES_SSE
+static void projectVelocitiesToSphereTangentSpace4(BodyStates& s, i32 i) {
+	const auto px = _mm_loadu_ps(&s.positionX[i]);
+	const auto py = _mm_loadu_ps(&s.positionY[i]);
+	const auto pz = _mm_loadu_ps(&s.positionZ[i]);
+	const auto pw = _mm_loadu_ps(&s.positionW[i]);
+	auto vx = _mm_loadu_ps(&s.velocityX[i]);
+	auto vy = _mm_loadu_ps(&s.velocityY[i]);
+	auto vz = _mm_loadu_ps(&s.velocityZ[i]);
+	auto vw = _mm_loadu_ps(&s.velocityW[i]);
+	const auto pp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_add_ps(_mm_mul_ps(pz, pz), _mm_mul_ps(pw, pw)));
+	const auto vp = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, px), _mm_mul_ps(vy, py)), _mm_add_ps(_mm_mul_ps(vz, pz), _mm_mul_ps(vw, pw)));
+	const auto d = _mm_div_ps(vp, pp);
+	_mm_storeu_ps(&s.velocityX[i], _mm_sub_ps(vx, _mm_mul_ps(d, px)));
+	_mm_storeu_ps(&s.velocityY[i], _mm_sub_ps(vy, _mm_mul_ps(d, py)));
+	_mm_storeu_ps(&s.velocityZ[i], _mm_sub_ps(vz, _mm_mul_ps(d, pz)));
+	_mm_storeu_ps(&s.velocityW[i], _mm_sub_ps(vw, _mm_mul_ps(d, pw)));
+}
+#endif
+
+void integrateForces(BodyStates& s, Vec4 gravity, f32 resistance, f32 dt) {
+	i32 i = 0;
+	#ifdef BODY_STATES_SSE
+	const auto dt4 = _mm_set1_ps(dt);
+	const auto resistance4 = _mm_set1_ps(resistance);
+	const auto gx = _mm_set1_ps(gravity.x);
+	const auto gy = _mm_set1_ps(gravity.y);
+	const auto gz = _mm_set1_ps(gravity.z);
+	const auto gw = _mm_set1_ps(gravity.w);
+	for (; i + 4 <= s.count(); i += 4) {
+		const auto invMass = _mm_loadu_ps(&s.invMass[i]);
+		auto update = [&](std::vector<f32>& velocity, const std::vector<f32>& force, __m128 g) {
+			const auto a = _mm_mul_ps(dt4, _mm_add_ps(g, _mm_mul_ps(invMass, _mm_loadu_ps(&force[i]))));
+			const auto v = _mm_mul_ps(_mm_add_ps(_mm_loadu_ps(&velocity[i]), a), resistance4);
+			_mm_storeu_ps(&velocity[i], v);
+		};
+		update(s.velocityX, s.forceX, gx);
+		update(s.velocityY, s.forceY, gy);
+		update(s.velocityZ, s.forceZ, gz);
+		update(s.velocityW, s.forceW, gw);
+		projectVelocitiesToSphereTangentSpace4(s, i);
+	}
+	#endif
+	for (; i < s.count(); i++) {
+		const auto invMass = s.invMass[i];
+		s.velocityX[i] = (s.velocityX[i] + dt * (gravity.x + invMass * s.forceX[i])) * resistance;
+		s.velocityY[i] = (s.velocityY[i] + dt * (gravity.y + invMass * s.forceY[i])) * resistance;
+		s.velocityZ[i] = (s.velocityZ[i] + dt * (gravity.z + invMass * s.forceZ[i])) * resistance;
+		s.velocityW[i] = (s.velocityW[i] + dt * (gravity.w + invMass * s.forceW[i])) * resistance;
+		projectVelocityToSphereTangentSpace(s, i);
+	}
+}
+
+void projectVelocitiesToSphereTangentSpace(BodyStates& s) {
+	i32 i = 0;
+	#ifdef BODY_STATES_SSE
+	for (; i + 4 <= s.count(); i += 4) {
+		projectVelocitiesToSphereTangentSpace4(s, i);
+	}
+	#endif
+	for (; i < s.count(); i++) {
+		projectVelocityToSphereTangentSpace(s, i);
+	}
+}
+
+/*
+The geodesic starting at a point p on the unit sphere with a tangent velocity v is the great circle in the plane spanned by p and v.
+p(t) = cos(|v| t) p + sin(|v| t) v / |v|
+Its derivative is the parallel transported velocity
+v(t) = cos(|v| t) v - |v| sin(|v| t) p
+This is the same rotation as the one computed by movementForwardOnSphere, but without constructing a basis of the whole space.
+*/
+void moveForwardOnSphere(BodyStates& s, f32 dt) {
+	i32 i = 0;
+	#ifdef BODY_STATES_SSE
+	const auto dt4 = _mm_set1_ps(dt);
+	const auto zero = _mm_setzero_ps();
+	const auto one = _mm_set1_ps(1.0f);
+	for (; i + 4 <= s.count(); i += 4) {
+		auto px = _mm_loadu_ps(&s.positionX[i]);
+		auto py = _mm_loadu_ps(&s.positionY[i]);
+		auto pz = _mm_loadu_ps(&s.positionZ[i]);
+		auto pw = _mm_loadu_ps(&s.positionW[i]);
+		const auto vx = _mm_loadu_ps(&s.velocityX[i]);
+		const auto vy = _mm_loadu_ps(&s.velocityY[i]);
+		const auto vz = _mm_loadu_ps(&s.velocityZ[i]);
+		const auto vw = _mm_loadu_ps(&s.velocityW[i]);
+
+		const auto speed = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_add_ps(_mm_mul_ps(vz, vz), _mm_mul_ps(vw, vw))));
+		const auto angle = _mm_mul_ps(speed, dt4);
+		// There are no SSE trigonometric functions.
+		alignas(16) f32 angles[4], sines[4], cosines[4];
+		_mm_store_ps(angles, angle);
+		for (i32 j = 0; j < 4; j++) {
+			sines[j] = sin(angles[j]);
+			cosines[j] = cos(angles[j]);
+		}
+		const auto sinA = _mm_load_ps(sines);
+		const auto cosA = _mm_load_ps(cosines);
+		// sin(angle) / speed. Zero if the body isn't moving.
+		const auto isMoving = _mm_cmpgt_ps(speed, zero);
+		const auto sinOverSpeed = _mm_and_ps(isMoving, _mm_div_ps(sinA, _mm_or_ps(speed, _mm_andnot_ps(isMoving, one))));
+		const auto speedSin = _mm_mul_ps(speed, sinA);
+
+		auto newP = [&](__m128 p, __m128 v) { return _mm_add_ps(_mm_mul_ps(cosA, p), _mm_mul_ps(sinOverSpeed, v)); };
+		auto newV = [&](__m128 p, __m128 v) { return _mm_sub_ps(_mm_mul_ps(cosA, v), _mm_mul_ps(speedSin, p)); };
+		_mm_storeu_ps(&s.velocityX[i], newV(px, vx));
+		_mm_storeu_ps(&s.velocityY[i], newV(py, vy));
+		_mm_storeu_ps(&s.velocityZ[i], newV(pz, vz));
+		_mm_storeu_ps(&s.velocityW[i], newV(pw, vw));
+		px = newP(px, vx);
+		py = newP(py, vy);
+		pz = newP(pz, vz);
+		pw = newP(pw, vw);
+
+		// Renormalizing to prevent drifting off the sphere.
+		const auto length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_add_ps(_mm_mul_ps(pz, pz), _mm_mul_ps(pw, pw))));
+		_mm_storeu_ps(&s.positionX[i], _mm_div_ps(px, length));
+		_mm_storeu_ps(&s.positionY[i], _mm_div_ps(py, length));
+		_mm_storeu_ps(&s.positionZ[i], _mm_div_ps(pz, length));
+		_mm_storeu_ps(&s.positionW[i], _mm_div_ps(pw, length));
+	}
+	#endif
+	for (; i < s.count(); i++) {
+		const auto p = Vec4(s.positionX[i], s.positionY[i], s.positionZ[i], s.positionW[i]);
+		const auto v = Vec4(s.velocityX[i], s.velocityY[i], s.velocityZ[i], s.velocityW[i]);
+		const auto speed = v.length();
+		const auto angle = speed * dt;
+		const auto sinA = sin(angle);
+		const auto cosA = cos(angle);
+		const auto sinOverSpeed = speed > 0.0f ? sinA / speed : 0.0f;
+		const auto newV = cosA * v - speed * sinA * p;
+		const auto newP = (cosA * p + sinOverSpeed * v).normalized();
+		s.positionX[i] = newP.x;
+		s.positionY[i] = newP.y;
+		s.positionZ[i] = newP.z;
+		s.positionW[i] = newP.w;
+		s.velocityX[i] = newV.x;
+		s.velocityY[i] = newV.y;
+		s.velocityZ[i] = newV.z;
+		s.velocityW[i] = newV.w;
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <game/Physics/Body.hpp>
+#include <vector>
+
+/*
+Structure of arrays copy of the moving bodies used by the integration passes. It's only a temporary copy. The Body structs stay the state of the simulation, because the solver and the collision code work on them, so the copy is filled with add and the results are written back using the scatter functions.
+
+Each component is stored in a separate array so the kernels can process 4 bodies at once with one SIMD register per component. If SSE isn't available (for example on the web build) the kernels fall back to scalar code with the same results up to floating point reordering.
+*/
+struct BodyStates {
+	void clear();
+	i32 count() const;
+
+	void add(const Body& body);
+	void gatherVelocities(View<Body* const> bodies);
+	void scatterVelocities(View<Body* const> bodies) const;
+	void scatterPositionsAndVelocities(View<Body* const> bodies) const;
+
+	Vec4 position(i32 i) const;
+	Vec4 velocity(i32 i) const;
+	void setPositionAndVelocity(i32 i, Vec4 position, Vec4 velocity);
+
+	std::vector<f32> positionX, positionY, positionZ, positionW;
+	std::vector<f32> velocityX, velocityY, velocityZ, velocityW;
+	std::vector<f32> forceX, forceY, forceZ, forceW;
+	std::vector<f32> invMass;
+};
+
+// velocity = projectVectorToSphereTangentSpace(position, (velocity + dt * (gravity + invMass * force)) * resistance)
+void integrateForces(BodyStates& s, Vec4 gravity, f32 resistance, f32 dt);
+void projectVelocitiesToSphereTangentSpace(BodyStates& s);
+// Moves the positions along the geodesics by velocity * dt and parallel transports the velocities.
+void moveForwardOnSphere(BodyStates& s, f32 dt);
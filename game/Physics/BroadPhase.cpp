@@ -0,0 +1,119 @@
+#include "BroadPhase.hpp"
+#include "ContactConstraint.hpp"
+#include <game/4d.hpp>
+#include <engine/Math/Angles.hpp>
+
+SphereCap bodyBoundingCap(const Body& body, const StaticGeometry& geometry) {
+	if (body.isWallMesh()) {
+		return SphereCap{ .center = Vec4(0.0f, 0.0f, 0.0f, 1.0f), .angularRadius = PI<f32> };
+	}
+	if (body.isWall()) {
+		const auto& wall = geometry.walls[body.wallIndex];
+		return sphericalTriangleBoundingCap(wall.v0, wall.v1, wall.v2);
+	}
+	return SphereCap{ .center = body.position.normalized(), .angularRadius = body.radius };
+}
+
+void BroadPhase::findPairs(BodyArray& bodies, const StaticGeometry& geometry, std::vector<BodyIdPair>& pairs) {
+	if (staticBodies.modified) {
+		rebuildStatic(bodies, geometry);
+	}
+	touchedSleepingBodies.clear();
+
+	dynamicBodies.clear();
+	dynamicCaps.clear();
+	f32 maxRadius = 0.0f;
+	for (auto body : bodies) {
+		if (body->invMass == 0.0f) {
+			continue;
+		}
+		dynamicBodies.push_back(body.id);
+		dynamicCaps.push_back(bodyBoundingCap(body.entity, geometry));
+		maxRadius = std::max(maxRadius, dynamicCaps.back().angularRadius);
+	}
+
+	// The bodies are inserted only into the cell containing their center. The cell size is the largest diameter so a query with a box expanded by the max radius only visits the neighbouring cells.
+	const auto dynamicCount = i32(dynamicBodies.size());
+	dynamicGrid.reset(2.0f * maxRadius, std::max(2 * dynamicCount, 64));
+	for (i32 i = 0; i < dynamicCount; i++) {
+		const auto& center = dynamicCaps[i].center;
+		dynamicGrid.insert(center, center, i);
+	}
+	dynamicGrid.build();
+
+	for (i32 i = 0; i < dynamicCount; i++) {
+		const auto& cap = dynamicCaps[i];
+		dynamicGrid.forEachOverlapping(capBoxMin(cap, maxRadius), capBoxMax(cap, maxRadius), [&](i32 j) {
+			// Each body is in a single bucket and each bucket is visited once so this also removes duplicates.
+			if (j <= i) {
+				return;
+			}
+			if (capsOverlap(cap, dynamicCaps[j])) {
+				pairs.push_back(BodyIdPair(dynamicBodies[i], dynamicBodies[j]));
+			}
+		});
+
+		staticBodies.forEachOverlapping(cap, [&](i32 j) {
+			const auto& id = staticBodies.bodies[j];
+			if (!bodies.isAlive(id)) {
+				// Removed static bodies are only cleaned up when the grid is rebuilt.
+				staticBodies.modified = true;
+				return;
+			}
+			pairs.push_back(BodyIdPair(dynamicBodies[i], id));
+		});
+
+		// Checking the triangles here would query the mesh grid a second time in collideSphereMesh, which returns no contacts if nothing overlaps.
+		for (const auto& meshId : wallMeshBodies) {
+			if (!bodies.isAlive(meshId)) {
+				staticBodies.modified = true;
+				continue;
+			}
+			pairs.push_back(BodyIdPair(dynamicBodies[i], meshId));
+		}
+
+		if (!sleepingBodies.bodies.empty()) {
+			sleepingBodies.forEachOverlapping(cap, [&](i32 j) {
+				touchedSleepingBodies.push_back(sleepingBodies.bodies[j]);
+			});
+		}
+	}
+}
+
+void BroadPhase::markStaticBodiesModified() {
+	staticBodies.modified = true;
+}
+
+void BroadPhase::rebuildStatic(BodyArray& bodies, const StaticGeometry& geometry) {
+	staticBodies.modified = false;
+	staticBodies.bodies.clear();
+	staticBodies.caps.clear();
+	wallMeshBodies.clear();
+	for (auto body : bodies) {
+		if (body->invMass != 0.0f) {
+			continue;
+		}
+		if (body->isWallMesh()) {
+			wallMeshBodies.push_back(body.id);
+			continue;
+		}
+		staticBodies.bodies.push_back(body.id);
+		staticBodies.caps.push_back(bodyBoundingCap(body.entity, geometry));
+	}
+	staticBodies.build();
+}
+
+void BroadPhase::setSleepingBodies(BodyArray& bodies, View<const BodyId> sleepingBodyIds, const StaticGeometry& geometry) {
+	sleepingBodies.bodies.clear();
+	sleepingBodies.caps.clear();
+	for (const auto& id : sleepingBodyIds) {
+		const auto body = bodies.getEvenIfInactive(id);
+		if (!body.has_value()) {
+			continue;
+		}
+		sleepingBodies.bodies.push_back(id);
+		sleepingBodies.caps.push_back(bodyBoundingCap(*body, geometry));
+	}
+	sleepingBodies.modified = false;
+	sleepingBodies.build();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <engine/Math/Vec4.hpp>
+#include <game/Physics/Body.hpp>
+#include <game/Physics/SpatialHash4.hpp>
+#include <game/Physics/WallMesh.hpp>
+#include <vector>
+
+struct BodyIdPair;
+
+SphereCap bodyBoundingCap(const Body& body, const StaticGeometry& geometry);
+
+// Bodies that don't move between steps. They are inserted once and the grid is only rebuilt when the set of bodies changes.
+struct FixedBodiesGrid : CapGrid {
+	bool modified = true;
+	// Parallel to caps.
+	std::vector<BodyId> bodies;
+};
+
+/*
+Finds the pairs of bodies whose bounding caps overlap.
+
+Dynamic bodies are reinserted each step into a grid with cell size equal to the largest dynamic diameter, so only the neighbouring cells need to be checked.
+Static bodies (the walls and anything else with infinite mass) are inserted once into a separate grid, which is only rebuilt when a static body is added or when removed static bodies accumulate.
+Wall meshes have their own grids so they aren't inserted into the static grid. Every dynamic body is paired with every wall mesh and collideSphereMesh finds the overlapping triangles, so the triangle grid is only queried once per body.
+Sleeping bodies are deactivated so they aren't iterated. They are kept in a third grid, which is only used to find the sleeping bodies touched by the awake ones.
+*/
+struct BroadPhase {
+	void findPairs(BodyArray& bodies, const StaticGeometry& geometry, std::vector<BodyIdPair>& pairs);
+	void markStaticBodiesModified();
+	void setSleepingBodies(BodyArray& bodies, View<const BodyId> sleepingBodyIds, const StaticGeometry& geometry);
+
+	FixedBodiesGrid staticBodies;
+	std::vector<BodyId> wallMeshBodies;
+	void rebuildStatic(BodyArray& bodies, const StaticGeometry& geometry);
+
+	FixedBodiesGrid sleepingBodies;
+	// The sleeping bodies overlapping awake dynamic bodies found by the last findPairs. Can contain duplicates.
+	std::vector<BodyId> touchedSleepingBodies;
+
+	std::vector<BodyId> dynamicBodies;
+	std::vector<SphereCap> dynamicCaps;
+	SpatialHash4 dynamicGrid;
+};
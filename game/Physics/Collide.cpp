@@ -56,9 +56,6 @@ Vec4 closestPointOnTriangle(Vec4 planeNormal, Vec4 edgeNormal0, Vec4 edgeNormal1
 	const auto d0 = dot(pProjectedOntoSphere, edgeNormal0);
 	const auto d1 = dot(pProjectedOntoSphere, edgeNormal1);
 	const auto d2 = dot(pProjectedOntoSphere, edgeNormal2);
-	edgeNormal0 = edgeNormal0.normalized();
-	edgeNormal1 = edgeNormal1.normalized();
-	edgeNormal2 = edgeNormal2.normalized();
 	if (d0 > 0.0f && d1 > 0.0f && d2 > 0.0f) {
 		return pProjectedOntoSphere;
 	}
@@ -130,15 +127,12 @@ Vec4 closestPointOnTriangle(Vec4 planeNormal, Vec4 edgeNormal0, Vec4 edgeNormal1
 //	return v[0];
 //}
 
-int collide2(Contact* contacts, const Body& bodyA, const Body& bodyB) {
-	CHECK(bodyA.s);
-	const auto p = closestPointOnTriangle(bodyA.planeNormal, bodyA.edgeNormal0, bodyA.edgeNormal1, bodyA.edgeNormal2, bodyB.position, bodyA.v0, bodyA.v1, bodyA.v2);
-
-	auto& c = contacts[0];
+// Fills the contact between a static body with closest point p and bodyB. The normals point from the static body to bodyB.
+static bool staticContact(Contact& c, Vec4 p, const Body& bodyB) {
 	// TODO: What sign should seperation be?
 	c.separation = sphereAngularDistance(p, bodyB.position);
 	if (c.separation > bodyB.radius) {
-		return 0;
+		return false;
 	}
 	//c.separation = -c.separation;
 	c.position = p;
@@ -161,7 +155,65 @@ int collide2(Contact* contacts, const Body& bodyA, const Body& bodyB) {
 	//c.normalBToA = -normalizedDirectionFromAToB(bodyB->position, p);
 	//CHECK(abs(c.normalBToA.length() - 1.0f) < 0.01f);
 	c.feature = FeaturePair{ .value = 0 };
-	return 1;
+	return true;
+}
+
+int collide2(Contact* contacts, const Wall& wallA, const Body& bodyB) {
+	const auto p = closestPointOnTriangle(wallA.planeNormal, wallA.edgeNormal0, wallA.edgeNormal1, wallA.edgeNormal2, bodyB.position, wallA.v0, wallA.v1, wallA.v2);
+	return staticContact(contacts[0], p, bodyB) ? 1 : 0;
+}
+
+/*
+Each triangle near the body gives its closest point. Triangles sharing the feature the closest point lies on give the same point, so only the closest point of each feature is kept. This also happens for the triangles of the same face, because their closest points outside the triangle are on the diagonals or the boundary of the face.
+If there are more features than contact points the deepest ones are kept.
+*/
+int collideSphereMesh(Contact* contacts, WallMesh& mesh, const Body& body) {
+	i32 contactCount = 0;
+	const SphereCap cap{ .center = body.position.normalized(), .angularRadius = body.radius };
+	mesh.forEachTriangleOverlapping(cap, [&](i32 triangleIndex) {
+		const auto closest = mesh.closestPointOnTriangle(triangleIndex, body.position);
+		Contact c;
+		if (!staticContact(c, closest.point, body)) {
+			return;
+		}
+		c.feature = FeaturePair{ .value = closest.feature };
+
+		for (i32 i = 0; i < contactCount; i++) {
+			if (contacts[i].feature.value == c.feature.value) {
+				if (c.separation < contacts[i].separation) {
+					contacts[i] = c;
+				}
+				return;
+			}
+		}
+		if (contactCount < ContactConstraint::MAX_POINTS) {
+			contacts[contactCount] = c;
+			contactCount++;
+			return;
+		}
+		i32 shallowest = 0;
+		for (i32 i = 1; i < contactCount; i++) {
+			if (contacts[i].separation > contacts[shallowest].separation) {
+				shallowest = i;
+			}
+		}
+		if (c.separation < contacts[shallowest].separation) {
+			contacts[shallowest] = c;
+		}
+	});
+	return contactCount;
+}
+
+// Makes the normals point from bodyB to the static body.
+static void flipStaticContacts(Contact* contacts, i32 contactCount) {
+	for (i32 i = 0; i < contactCount; i++) {
+		auto& c = contacts[i];
+		std::swap(c.normalAToB, c.normalBToA);
+		c.normalAToB = -c.normalAToB;
+		c.normalBToA = -c.normalBToA;
+		c.normal = -c.normal;
+		c.normalAtPosition = -c.normalAtPosition;
+	}
 }
 
 bool operator<(const BodyIdPair& a1, const BodyIdPair& a2) {
@@ -175,20 +227,23 @@ bool operator<(const BodyIdPair& a1, const BodyIdPair& a2) {
 }
 
 // https://media.steampowered.com/apps/valve/2015/DirkGregorius_Contacts.pdf
-int collide(Contact* contacts, const Body& bodyA, const Body& bodyB) {
-	if (bodyA.s && bodyB.s) {
+int collide(Contact* contacts, const Body& bodyA, const Body& bodyB, const StaticGeometry& geometry) {
+	const auto aIsStaticGeometry = bodyA.isWall() || bodyA.isWallMesh();
+	const auto bIsStaticGeometry = bodyB.isWall() || bodyB.isWallMesh();
+	if (aIsStaticGeometry && bIsStaticGeometry) {
 		return 0;
 	}
-	if (bodyA.s) {
-		return collide2(contacts, bodyA, bodyB);
-	} else if (bodyB.s) {
-		const auto r = collide2(contacts, bodyB, bodyA);
-		auto& c = contacts[0];
-		std::swap(c.normalAToB, c.normalBToA);
-		c.normalAToB = -c.normalAToB;
-		c.normalBToA = -c.normalBToA;
-		c.normal = -c.normal;
-		c.normalAtPosition = -c.normalAtPosition;
+	if (bodyA.isWall()) {
+		return collide2(contacts, geometry.walls[bodyA.wallIndex], bodyB);
+	} else if (bodyA.isWallMesh()) {
+		return collideSphereMesh(contacts, geometry.wallMeshes[bodyA.wallMeshIndex], bodyB);
+	} else if (bodyB.isWall()) {
+		const auto r = collide2(contacts, geometry.walls[bodyB.wallIndex], bodyA);
+		flipStaticContacts(contacts, r);
+		return r;
+	} else if (bodyB.isWallMesh()) {
+		const auto r = collideSphereMesh(contacts, geometry.wallMeshes[bodyB.wallMeshIndex], bodyA);
+		flipStaticContacts(contacts, r);
 		return r;
 	}
 
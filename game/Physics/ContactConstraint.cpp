@@ -64,15 +64,17 @@ Under this approximation things kinda reduce to normal 3d case.
 
 In spherical geometry object that are large enough can't be moved apart.
 */
-ContactConstraint::ContactConstraint(const Body& b1, const Body b2) {
-	numContacts = collide(contacts, b1, b2);
+i32 ContactConstraint::maxContactCount(const Body& b1, const Body& b2) {
+	return b1.isWallMesh() || b2.isWallMesh() ? MAX_POINTS : 1;
 }
 
-void ContactConstraint::update(Contact* newContacts, int numNewContacts) {
-	Contact mergedContacts[2];
+void ContactConstraint::update(Contact* contactArray, const Contact* newContacts, i32 numNewContacts) {
+	CHECK(numNewContacts <= contactCapacity);
+	const auto contacts = contactArray + firstContact;
+	Contact mergedContacts[MAX_POINTS];
 
 	for (i32 i = 0; i < numNewContacts; ++i) {
-		Contact* cNew = newContacts + i;
+		const Contact* cNew = newContacts + i;
 		i32 k = -1;
 		for (i32 j = 0; j < numContacts; ++j) {
 			Contact* cOld = contacts + j;
@@ -107,7 +109,8 @@ void ContactConstraint::update(Contact* newContacts, int numNewContacts) {
 	numContacts = numNewContacts;
 }
 
-void ContactConstraint::preStep(Body& body1, Body& body2, f32 invDt) {
+void ContactConstraint::preStep(Contact* contactArray, Body& body1, Body& body2, f32 invDt) {
+	const auto contacts = contactArray + firstContact;
 	const float k_allowedPenetration = 0.01f;
 	//const float k_allowedPenetration = 0.001f;
 	//float k_biasFactor = World::positionCorrection ? 0.2f : 0.0f;
@@ -248,7 +251,8 @@ Vec4 velocityAtPoint(const Body& body, Vec4 point) {
 //	return velocity;
 //}
 
-void ContactConstraint::applyImpulse(Body& b1, Body& b2) {
+void ContactConstraint::applyImpulse(Contact* contactArray, Body& b1, Body& b2) {
+	const auto contacts = contactArray + firstContact;
 	/*Body* b1 = body1;
 	Body* b2 = body2;*/
 
@@ -2,6 +2,7 @@
 
 #include <engine/Math/Vec4.hpp>
 #include <game/Physics/Body.hpp>
+#include <game/Physics/WallMesh.hpp>
 
 union FeaturePair {
 	struct Edges
@@ -32,23 +33,30 @@ struct Contact {
 	FeaturePair feature = FeaturePair{ .value = 0 };
 };
 
+/*
+The contacts are stored in ContactManager::contacts and the functions take the pointer to the start of that array.
+Only a sphere touching a wall mesh can have more than one contact, so each constraint reserves maxContactCount contacts for its pair instead of every constraint having space for MAX_POINTS contacts.
+*/
 struct ContactConstraint {
-	enum { MAX_POINTS = 2 };
+	// A sphere resting in a corner of a wall mesh can touch a few faces at once.
+	enum { MAX_POINTS = 4 };
+	// The number of contacts collide can return for the pair.
+	static i32 maxContactCount(const Body& b1, const Body& b2);
 
-	ContactConstraint(const Body& b1, const Body b2);
+	void update(Contact* contactArray, const Contact* newContacts, i32 numNewContacts);
 
-	void update(Contact* contacts, i32 numContacts);
+	void preStep(Contact* contactArray, Body& body1, Body& body2, f32 inv_dt);
+	void applyImpulse(Contact* contactArray, Body& b1, Body& b2);
 
-	void preStep(Body& body1, Body& body2, f32 inv_dt);
-	void applyImpulse(Body& b1, Body& b2);
-
-	Contact contacts[MAX_POINTS];
+	i32 firstContact;
 	i32 numContacts;
+	i32 contactCapacity;
 };
 
 // Unordered pair. 2 element set.
 struct BodyIdPair {
 	BodyIdPair(BodyId b1, BodyId b2);
+	bool operator==(const BodyIdPair&) const = default;
 
 	BodyId body1;
 	BodyId body2;
@@ -57,5 +65,8 @@ struct BodyIdPair {
 // Used by std::set.
 bool operator<(const BodyIdPair& a1, const BodyIdPair& a2);
 
-int collide(Contact* contacts, const Body& bodyA, const Body& bodyB);
+int collide(Contact* contacts, const Body& bodyA, const Body& bodyB, const StaticGeometry& geometry);
+// Returns at most ContactConstraint::MAX_POINTS contacts, one for each touched feature of the mesh.
+int collideSphereMesh(Contact* contacts, WallMesh& mesh, const Body& body);
+// The edge normals have to be normalized.
 Vec4 closestPointOnTriangle(Vec4 planeNormal, Vec4 edgeNormal0, Vec4 edgeNormal1, Vec4 edgeNormal2, Vec4 point, Vec4 v0, Vec4 v1, Vec4 v2);
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "ContactIslands.hpp"
+#include <numeric>
+#include <bit>
+
+static bool isStatic(const Body* body) {
+	return body->invMass == 0.0f;
+}
+
+i32 ContactIslands::findRoot(i32 bodyIndex) {
+	// Path halving.
+	while (parent[bodyIndex] != bodyIndex) {
+		parent[bodyIndex] = parent[parent[bodyIndex]];
+		bodyIndex = parent[bodyIndex];
+	}
+	return bodyIndex;
+}
+
+void ContactIslands::build(const ContactManager& contacts, i32 bodyIndexCount, i32 minColoredConstraintCount) {
+	islands.clear();
+	constraints.clear();
+	uncoloredIslands.clear();
+	coloredIslands.clear();
+	colors.clear();
+	coloredConstraints.clear();
+
+	parent.resize(bodyIndexCount);
+	std::iota(parent.begin(), parent.end(), 0);
+	rootIsland.clear();
+	rootIsland.resize(bodyIndexCount, -1);
+
+	const auto constraintCount = contacts.size();
+	for (i32 i = 0; i < constraintCount; i++) {
+		const auto& bodies = contacts.bodies[i];
+		if (isStatic(bodies.body1) || isStatic(bodies.body2)) {
+			continue;
+		}
+		const auto root1 = findRoot(contacts.keys[i].body1.index());
+		const auto root2 = findRoot(contacts.keys[i].body2.index());
+		// Always making the smaller index the root so the result doesn't depend on anything other than the constraint order.
+		if (root1 < root2) {
+			parent[root2] = root1;
+		} else {
+			parent[root1] = root2;
+		}
+	}
+
+	// Numbering the islands in the order of their first constraints.
+	constraintIsland.resize(constraintCount);
+	for (i32 i = 0; i < constraintCount; i++) {
+		const auto& key = contacts.keys[i];
+		// A constraint between 2 static bodies (only possible if the bodies couldn't be resolved) doesn't do anything, but it still gets an island so every constraint is solved.
+		const auto dynamicBodyIndex = isStatic(contacts.bodies[i].body1) ? key.body2.index() : key.body1.index();
+		const auto root = findRoot(dynamicBodyIndex);
+		if (rootIsland[root] == -1) {
+			rootIsland[root] = i32(islands.size());
+			islands.push_back(Island{ .constraintsStart = 0, .constraintsEnd = 0 });
+		}
+		constraintIsland[i] = rootIsland[root];
+		islands[constraintIsland[i]].constraintsEnd++;
+	}
+
+	// Counting sort of the constraints by island. The constraintsEnd currently store the sizes.
+	i32 offset = 0;
+	for (auto& island : islands) {
+		const auto size = island.constraintsEnd;
+		island.constraintsStart = offset;
+		island.constraintsEnd = offset;
+		offset += size;
+	}
+	constraints.resize(constraintCount);
+	for (i32 i = 0; i < constraintCount; i++) {
+		constraints[islands[constraintIsland[i]].constraintsEnd++] = i;
+	}
+
+	for (i32 i = 0; i < i32(islands.size()); i++) {
+		auto& island = islands[i];
+		const auto size = island.constraintsEnd - island.constraintsStart;
+		if (minColoredConstraintCount >= 0 && size >= minColoredConstraintCount) {
+			colorIsland(contacts, island);
+			coloredIslands.push_back(i);
+		} else {
+			uncoloredIslands.push_back(i);
+		}
+	}
+}
+
+void ContactIslands::colorIsland(const ContactManager& contacts, Island& island) {
+	// Greedy coloring in the constraint order. Each constraint gets the lowest color not used by any of its dynamic bodies.
+	bodyUsedColors.resize(parent.size(), 0);
+	constraintColor.resize(constraints.size());
+	i32 colorSizes[MAX_COLORS + 1]{};
+	for (i32 j = island.constraintsStart; j < island.constraintsEnd; j++) {
+		const auto i = constraints[j];
+		const auto& key = contacts.keys[i];
+		const auto& bodies = contacts.bodies[i];
+		const auto dynamic1 = !isStatic(bodies.body1);
+		const auto dynamic2 = !isStatic(bodies.body2);
+		u64 used = 0;
+		if (dynamic1) {
+			used |= bodyUsedColors[key.body1.index()];
+		}
+		if (dynamic2) {
+			used |= bodyUsedColors[key.body2.index()];
+		}
+		// Equal to MAX_COLORS if all the colors are used.
+		const auto color = i32(std::countr_one(used));
+		constraintColor[j] = color;
+		colorSizes[color]++;
+		if (color == MAX_COLORS) {
+			continue;
+		}
+		if (dynamic1) {
+			bodyUsedColors[key.body1.index()] |= u64(1) << color;
+		}
+		if (dynamic2) {
+			bodyUsedColors[key.body2.index()] |= u64(1) << color;
+		}
+	}
+
+	island.colorsStart = i32(colors.size());
+	i32 colorInsertPosition[MAX_COLORS + 1];
+	i32 start = i32(coloredConstraints.size());
+	for (i32 color = 0; color <= MAX_COLORS; color++) {
+		if (colorSizes[color] == 0) {
+			continue;
+		}
+		colorInsertPosition[color] = start;
+		colors.push_back(Color{ .start = start, .end = start + colorSizes[color], .isOverflow = color == MAX_COLORS });
+		start += colorSizes[color];
+	}
+	island.colorsEnd = i32(colors.size());
+	coloredConstraints.resize(coloredConstraints.size() + (island.constraintsEnd - island.constraintsStart));
+	for (i32 j = island.constraintsStart; j < island.constraintsEnd; j++) {
+		coloredConstraints[colorInsertPosition[constraintColor[j]]++] = constraints[j];
+	}
+
+	for (i32 j = island.constraintsStart; j < island.constraintsEnd; j++) {
+		const auto& key = contacts.keys[constraints[j]];
+		bodyUsedColors[key.body1.index()] = 0;
+		bodyUsedColors[key.body2.index()] = 0;
+	}
+}
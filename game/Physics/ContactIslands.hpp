@@ -0,0 +1,55 @@
+#pragma once
+
+#include <game/Physics/ContactManager.hpp>
+#include <vector>
+
+/*
+Groups the contact constraints into islands, which are the connected components of the graph with the dynamic bodies as vertices and the constraints as edges.
+
+Static bodies don't connect islands, because applying an impulse to a body with infinite mass doesn't change its velocity. So two piles of bodies lying on the same wall can be solved independently. Because the islands don't share any dynamic bodies solving them in any order gives exactly the same result as solving all the constraints in a single loop.
+
+Large islands can additionally be colored. Constraints of the same color don't share any dynamic bodies so they can be solved in parallel. This changes the order in which the constraints are solved so the result is different from the sequential solver, but it still doesn't depend on the number of threads or the scheduling.
+*/
+struct ContactIslands {
+	// Islands with at least minColoredConstraintCount constraints are colored. Negative values disable coloring.
+	void build(const ContactManager& contacts, i32 bodyIndexCount, i32 minColoredConstraintCount);
+
+	struct Island {
+		// Range in constraints.
+		i32 constraintsStart;
+		i32 constraintsEnd;
+		// Range in colors. Empty if the island isn't colored.
+		i32 colorsStart = 0;
+		i32 colorsEnd = 0;
+		bool isColored() const { return colorsStart != colorsEnd; }
+	};
+	// Ordered by the first constraint in each island, so the order only depends on the order of the constraints.
+	std::vector<Island> islands;
+	// The constraint indices of island i are in the range [islands[i].constraintsStart, islands[i].constraintsEnd) in the same order as in ContactManager.
+	std::vector<i32> constraints;
+	// Indices of the islands with and without colors. Stored separately, because they are solved differently.
+	std::vector<i32> uncoloredIslands;
+	std::vector<i32> coloredIslands;
+
+	struct Color {
+		// Range in coloredConstraints.
+		i32 start;
+		i32 end;
+		// The constraints that didn't fit into MAX_COLORS colors. They can share bodies so they have to be solved sequentially.
+		bool isOverflow;
+	};
+	std::vector<Color> colors;
+	std::vector<i32> coloredConstraints;
+	static constexpr i32 MAX_COLORS = 64;
+
+	// Union find over the body indices.
+	std::vector<i32> parent;
+	i32 findRoot(i32 bodyIndex);
+	std::vector<i32> rootIsland;
+	std::vector<i32> constraintIsland;
+
+	// Bit i is set if the body is used by a constraint of color i.
+	std::vector<u64> bodyUsedColors;
+	std::vector<i32> constraintColor;
+	void colorIsland(const ContactManager& contacts, Island& island);
+};
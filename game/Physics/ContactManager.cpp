@@ -0,0 +1,144 @@
+#include "ContactManager.hpp"
+#include <algorithm>
+
+void ContactManager::beginUpdate() {
+	currentUpdate++;
+}
+
+void ContactManager::update(const BodyIdPair& key, const Contact* newContacts, i32 newContactCount, i32 contactCapacity) {
+	const auto index = find(key);
+	if (index != EMPTY) {
+		constraints[index].update(contacts.data(), newContacts, newContactCount);
+		updatedInUpdate[index] = currentUpdate;
+		return;
+	}
+
+	// Keeping the load factor below 0.5 so the probe sequences stay short.
+	if ((keys.size() + 1) * 2 > table.size()) {
+		rebuildTable((keys.size() + 1) * 2);
+	}
+	const auto newIndex = i32(keys.size());
+	keys.push_back(key);
+	constraints.push_back(ContactConstraint{
+		.firstContact = i32(contacts.size()),
+		.numContacts = newContactCount,
+		.contactCapacity = contactCapacity
+	});
+	contacts.insert(contacts.end(), newContacts, newContacts + newContactCount);
+	contacts.resize(contacts.size() + contactCapacity - newContactCount);
+	bodies.push_back(BodyPointers{ nullptr, nullptr });
+	updatedInUpdate.push_back(currentUpdate);
+
+	const auto mask = table.size() - 1;
+	for (usize slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+		if (table[slot] == EMPTY) {
+			table[slot] = newIndex;
+			break;
+		}
+	}
+}
+
+void ContactManager::removeStale() {
+	i32 kept = 0;
+	i32 keptContacts = 0;
+	for (i32 i = 0; i < size(); i++) {
+		if (updatedInUpdate[i] != currentUpdate) {
+			continue;
+		}
+		if (kept != i) {
+			keys[kept] = keys[i];
+			constraints[kept] = constraints[i];
+			updatedInUpdate[kept] = updatedInUpdate[i];
+		}
+		// The ranges are in order so the kept ones only move towards the start.
+		auto& constraint = constraints[kept];
+		if (keptContacts != constraint.firstContact) {
+			const auto range = contacts.begin() + constraint.firstContact;
+			std::copy(range, range + constraint.contactCapacity, contacts.begin() + keptContacts);
+			constraint.firstContact = keptContacts;
+		}
+		keptContacts += constraint.contactCapacity;
+		kept++;
+	}
+	if (kept == size()) {
+		return;
+	}
+	// BodyIdPair isn't default constructible so can't use resize.
+	keys.erase(keys.begin() + kept, keys.end());
+	constraints.resize(kept);
+	contacts.resize(keptContacts);
+	updatedInUpdate.erase(updatedInUpdate.begin() + kept, updatedInUpdate.end());
+	bodies.resize(kept);
+	rebuildTable(keys.size() * 2);
+}
+
+void ContactManager::resolveBodies(BodyArray& bodyArray) {
+	for (i32 i = 0; i < size(); i++) {
+		auto a = bodyArray.get(keys[i].body1);
+		auto b = bodyArray.get(keys[i].body2);
+		if (!a.has_value() || !b.has_value()) {
+			// The broad phase only reports alive bodies and bodies are only destroyed at the start of the step.
+			CHECK_NOT_REACHED();
+			bodies[i] = BodyPointers{ &invalidBody, &invalidBody };
+			continue;
+		}
+		bodies[i] = BodyPointers{ &*a, &*b };
+	}
+}
+
+void ContactManager::clear() {
+	keys.clear();
+	constraints.clear();
+	contacts.clear();
+	bodies.clear();
+	updatedInUpdate.clear();
+	table.clear();
+}
+
+i32 ContactManager::size() const {
+	return i32(keys.size());
+}
+
+i32 ContactManager::find(const BodyIdPair& key) const {
+	if (table.size() == 0) {
+		return EMPTY;
+	}
+	const auto mask = table.size() - 1;
+	for (usize slot = hash(key) & mask;; slot = (slot + 1) & mask) {
+		const auto index = table[slot];
+		if (index == EMPTY) {
+			return EMPTY;
+		}
+		if (keys[index] == key) {
+			return index;
+		}
+	}
+}
+
+void ContactManager::rebuildTable(usize minSize) {
+	usize tableSize = 16;
+	while (tableSize < minSize) {
+		tableSize *= 2;
+	}
+	table.clear();
+	table.resize(tableSize, EMPTY);
+	const auto mask = tableSize - 1;
+	for (i32 i = 0; i < size(); i++) {
+		for (usize slot = hash(keys[i]) & mask;; slot = (slot + 1) & mask) {
+			if (table[slot] == EMPTY) {
+				table[slot] = i;
+				break;
+			}
+		}
+	}
+}
+
+usize ContactManager::hash(const BodyIdPair& key) {
+	// The indices of the bodies are unique among alive bodies so the versions don't need to be hashed.
+	u64 h = (u64(u32(key.body1.index())) << 32) | u64(u32(key.body2.index()));
+	// https://xorshift.di.unimi.it/splitmix64.c
+	h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+	h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+	h = h ^ (h >> 31);
+	return usize(h);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <game/Physics/ContactConstraint.hpp>
+#include <vector>
+
+/*
+Stores the contact constraints in contiguous arrays so the solver loops are a linear sweep.
+
+The constraints are found by an open addressing hash table from the body pair to the index in the arrays. The constraints that weren't updated during the broad phase are removed in bulk by compacting the arrays, which keeps the order of the remaining constraints so the results don't depend on the history of insertions and removals.
+*/
+struct ContactManager {
+	// Called before the broad phase updates the constraints.
+	void beginUpdate();
+	// Merges the new contacts into the existing constraint for the pair or adds a new constraint with space for contactCapacity contacts.
+	void update(const BodyIdPair& key, const Contact* newContacts, i32 newContactCount, i32 contactCapacity);
+	// Removes the constraints that weren't updated since beginUpdate.
+	void removeStale();
+	// Caches the pointers to the bodies for the duration of the step. The pointers are invalidated when bodies are created.
+	void resolveBodies(BodyArray& bodies);
+
+	void clear();
+	i32 size() const;
+	// Returns -1 if the pair doesn't have a constraint.
+	i32 find(const BodyIdPair& key) const;
+
+	std::vector<BodyIdPair> keys;
+	std::vector<ContactConstraint> constraints;
+	// Constraint i uses the range [firstContact, firstContact + contactCapacity). The ranges are in the same order as the constraints.
+	std::vector<Contact> contacts;
+	struct BodyPointers {
+		Body* body1;
+		Body* body2;
+	};
+	std::vector<BodyPointers> bodies;
+	// Has infinite mass so applying impulses to it does nothing. Used instead of null if a body couldn't be resolved so the solver loops don't need to check.
+	Body invalidBody;
+	std::vector<i32> updatedInUpdate;
+	i32 currentUpdate = 0;
+
+	// Power of two size. Stores the index into the arrays or EMPTY.
+	std::vector<i32> table;
+	static constexpr i32 EMPTY = -1;
+	void rebuildTable(usize minSize);
+	static usize hash(const BodyIdPair& key);
+};
@@ -0,0 +1,70 @@
+#include "ContinuousCollision.hpp"
+#include "ContactConstraint.hpp"
+#include <game/4d.hpp>
+#include <cmath>
+
+Vec4 positionAlongGeodesic(Vec4 position, Vec4 velocity, f32 t) {
+	const auto speed = velocity.length();
+	if (speed == 0.0f) {
+		return position;
+	}
+	const auto angle = speed * t;
+	return (cos(angle) * position + (sin(angle) / speed) * velocity).normalized();
+}
+
+Vec4 velocityAlongGeodesic(Vec4 position, Vec4 velocity, f32 t) {
+	const auto speed = velocity.length();
+	const auto angle = speed * t;
+	return cos(angle) * velocity - (speed * sin(angle)) * position;
+}
+
+template<typename DistanceFunction>
+static std::optional<f32> conservativeAdvancement(f32 targetDistance, f32 maxApproachSpeed, f32 maxTime, DistanceFunction distanceAt) {
+	const i32 MAX_ITERATIONS = 32;
+	if (distanceAt(0.0f) <= targetDistance + CCD_TOLERANCE) {
+		return std::nullopt;
+	}
+	if (maxApproachSpeed <= 0.0f) {
+		return std::nullopt;
+	}
+	f32 t = 0.0f;
+	for (i32 i = 0; i < MAX_ITERATIONS; i++) {
+		const auto gap = distanceAt(t) - targetDistance;
+		if (gap <= CCD_TOLERANCE) {
+			return t;
+		}
+		t += gap / maxApproachSpeed;
+		if (t >= maxTime) {
+			return std::nullopt;
+		}
+	}
+	// Only happens for grazing contacts, where the bodies approach much slower than the bound. Returning the reached time is still safe, because the time never goes past the time of impact.
+	return t;
+}
+
+std::optional<f32> sphereSphereTimeOfImpact(Vec4 position0, Vec4 velocity0, f32 radius0, Vec4 position1, Vec4 velocity1, f32 radius1, f32 maxTime) {
+	const auto targetDistance = radius0 + radius1 - CCD_TARGET_PENETRATION;
+	const auto maxApproachSpeed = velocity0.length() + velocity1.length();
+	return conservativeAdvancement(targetDistance, maxApproachSpeed, maxTime, [&](f32 t) {
+		return sphereAngularDistance(
+			positionAlongGeodesic(position0, velocity0, t),
+			positionAlongGeodesic(position1, velocity1, t));
+	});
+}
+
+std::optional<f32> sphereWallTimeOfImpact(Vec4 position, Vec4 velocity, f32 radius, const Wall& wall, f32 maxTime) {
+	const auto targetDistance = radius - CCD_TARGET_PENETRATION;
+	return conservativeAdvancement(targetDistance, velocity.length(), maxTime, [&](f32 t) {
+		const auto p = positionAlongGeodesic(position, velocity, t);
+		const auto closest = closestPointOnTriangle(wall.planeNormal, wall.edgeNormal0, wall.edgeNormal1, wall.edgeNormal2, p, wall.v0, wall.v1, wall.v2);
+		return sphereAngularDistance(p, closest);
+	});
+}
+
+std::optional<f32> sphereWallMeshTriangleTimeOfImpact(Vec4 position, Vec4 velocity, f32 radius, const WallMesh& mesh, i32 triangle, f32 maxTime) {
+	const auto targetDistance = radius - CCD_TARGET_PENETRATION;
+	return conservativeAdvancement(targetDistance, velocity.length(), maxTime, [&](f32 t) {
+		const auto p = positionAlongGeodesic(position, velocity, t);
+		return sphereAngularDistance(p, mesh.closestPointOnTriangle(triangle, p).point);
+	});
+}
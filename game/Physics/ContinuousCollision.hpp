@@ -0,0 +1,24 @@
+#pragma once
+
+#include <game/Physics/Body.hpp>
+#include <game/Physics/WallMesh.hpp>
+#include <optional>
+
+/*
+A body with position p and tangent velocity v moves along the great circle
+p(t) = cos(|v| t) p + sin(|v| t) v / |v|
+so the angular speed of its center is |v|. This bounds how fast the angular distance to any other point or set can change, which is used to do conservative advancement. At each iteration the time is advanced by the current gap divided by the maximum approach speed, so the bodies never step over the time of impact.
+
+The time of impact is the time when the bodies overlap by CCD_TARGET_PENETRATION. Stopping slightly after touching makes the discrete collision detection create the contact on the next step, while still staying below the penetration allowed by the solver so the position correction doesn't push the bodies apart.
+*/
+constexpr f32 CCD_TARGET_PENETRATION = 0.005f;
+constexpr f32 CCD_TOLERANCE = 0.0025f;
+
+Vec4 positionAlongGeodesic(Vec4 position, Vec4 velocity, f32 t);
+// The parallel transported velocity.
+Vec4 velocityAlongGeodesic(Vec4 position, Vec4 velocity, f32 t);
+
+// Returns std::nullopt if the spheres don't collide before maxTime or if they are already touching at time zero, in which case the discrete collision detection handles them.
+std::optional<f32> sphereSphereTimeOfImpact(Vec4 position0, Vec4 velocity0, f32 radius0, Vec4 position1, Vec4 velocity1, f32 radius1, f32 maxTime);
+std::optional<f32> sphereWallTimeOfImpact(Vec4 position, Vec4 velocity, f32 radius, const Wall& wall, f32 maxTime);
+std::optional<f32> sphereWallMeshTriangleTimeOfImpact(Vec4 position, Vec4 velocity, f32 radius, const WallMesh& mesh, i32 triangle, f32 maxTime);
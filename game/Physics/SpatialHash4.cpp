@@ -0,0 +1,107 @@
+#include "SpatialHash4.hpp"
+#include <game/4d.hpp>
+#include <engine/Math/Angles.hpp>
+#include <cmath>
+#include <algorithm>
+
+bool capsOverlap(const SphereCap& a, const SphereCap& b) {
+	const auto maxDistance = a.angularRadius + b.angularRadius;
+	if (maxDistance >= PI<f32>) {
+		return true;
+	}
+	// Comparing cosines instead of calling sphereAngularDistance to avoid the acos. cos is decreasing on [0, pi].
+	return dot(a.center, b.center) >= cos(maxDistance);
+}
+
+SphereCap sphericalTriangleBoundingCap(Vec4 v0, Vec4 v1, Vec4 v2) {
+	const auto center = (v0 + v1 + v2).normalized();
+	const auto radius = std::max({
+		sphereAngularDistance(center, v0),
+		sphereAngularDistance(center, v1),
+		sphereAngularDistance(center, v2)
+	});
+	return SphereCap{ .center = center, .angularRadius = radius };
+}
+
+Vec4 capBoxMin(const SphereCap& cap, f32 expand) {
+	return cap.center - Vec4(cap.angularRadius + expand);
+}
+
+Vec4 capBoxMax(const SphereCap& cap, f32 expand) {
+	return cap.center + Vec4(cap.angularRadius + expand);
+}
+
+void SpatialHash4::reset(f32 cellSizeToSet, i32 bucketCountToSet) {
+	// The coordinates of points on the unit sphere are in [-1, 1] so the cells don't need to be smaller than this to get a good distribution. It also prevents division by zero.
+	cellSize = std::max(cellSizeToSet, 1.0f / 64.0f);
+	bucketCount = std::max(bucketCountToSet, 1);
+	entries.clear();
+}
+
+void SpatialHash4::insert(Vec4 min, Vec4 max, i32 value) {
+	const i32 x0 = cellCoordinate(min.x), x1 = cellCoordinate(max.x);
+	const i32 y0 = cellCoordinate(min.y), y1 = cellCoordinate(max.y);
+	const i32 z0 = cellCoordinate(min.z), z1 = cellCoordinate(max.z);
+	const i32 w0 = cellCoordinate(min.w), w1 = cellCoordinate(max.w);
+	for (i32 x = x0; x <= x1; x++) {
+		for (i32 y = y0; y <= y1; y++) {
+			for (i32 z = z0; z <= z1; z++) {
+				for (i32 w = w0; w <= w1; w++) {
+					entries.push_back(Entry{ .bucket = bucketIndex(x, y, z, w), .value = value });
+				}
+			}
+		}
+	}
+}
+
+void SpatialHash4::build() {
+	// Counting sort by bucket.
+	bucketStart.clear();
+	bucketStart.resize(bucketCount + 1, 0);
+	for (const auto& entry : entries) {
+		bucketStart[entry.bucket + 1]++;
+	}
+	for (i32 i = 0; i < bucketCount; i++) {
+		bucketStart[i + 1] += bucketStart[i];
+	}
+	values.resize(entries.size());
+	// Reusing the scratch as the insert positions.
+	bucketsScratch.assign(bucketStart.begin(), bucketStart.end() - 1);
+	for (const auto& entry : entries) {
+		values[bucketsScratch[entry.bucket]++] = entry.value;
+	}
+}
+
+i32 SpatialHash4::bucketIndex(i32 x, i32 y, i32 z, i32 w) const {
+	// https://matthias-research.github.io/pages/publications/tetraederCollision.pdf
+	const u32 hash =
+		(u32(x) * 73856093u) ^
+		(u32(y) * 19349663u) ^
+		(u32(z) * 83492791u) ^
+		(u32(w) * 50331653u);
+	return i32(hash % u32(bucketCount));
+}
+
+i32 SpatialHash4::cellCoordinate(f32 v) const {
+	// Everything inserted and queried is on the unit sphere, which is inside [-1, 1]^4, so the boxes are clamped to it. Otherwise a cap larger than the sphere, like the swept cap of a body moving several radians in a step, would visit a number of cells growing with the fourth power of its radius. Also maps NaN to 1 instead of converting it to an integer.
+	v = std::max(-1.0f, std::min(1.0f, v));
+	return i32(floor(v / cellSize));
+}
+
+void CapGrid::build() {
+	const auto count = i32(caps.size());
+	lastQueriedBy.clear();
+	lastQueriedBy.resize(count, -1);
+
+	f32 diameterSum = 0.0f;
+	for (const auto& cap : caps) {
+		diameterSum += 2.0f * cap.angularRadius;
+	}
+	// Using the average size, because the caps can have different sizes. With this size each cap overlaps around 2^4 cells.
+	const auto cellSize = count == 0 ? 1.0f : diameterSum / f32(count);
+	grid.reset(cellSize, std::max(16 * count, 64));
+	for (i32 i = 0; i < count; i++) {
+		grid.insert(capBoxMin(caps[i]), capBoxMax(caps[i]), i);
+	}
+	grid.build();
+}
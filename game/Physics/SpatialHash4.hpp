@@ -0,0 +1,115 @@
+#pragma once
+
+#include <engine/Math/Vec4.hpp>
+#include <Types.hpp>
+#include <vector>
+#include <algorithm>
+
+// The set of points on the 3-sphere with angular distance from the center less or equal to the angular radius.
+struct SphereCap {
+	Vec4 center;
+	f32 angularRadius;
+};
+bool capsOverlap(const SphereCap& a, const SphereCap& b);
+// The edges of the triangle are great circle arcs so the triangle is contained in the convex hull of its vertices, which is contained in any cap containing the vertices.
+SphereCap sphericalTriangleBoundingCap(Vec4 v0, Vec4 v1, Vec4 v2);
+// The axis aligned box containing the cap, optionally expanded.
+Vec4 capBoxMin(const SphereCap& cap, f32 expand = 0.0f);
+Vec4 capBoxMax(const SphereCap& cap, f32 expand = 0.0f);
+
+/*
+Hashed uniform grid over the 4D space the 3-sphere is embedded in.
+
+The euclidean distance between 2 points on the unit sphere is 2 sin(angle / 2) <= angle, so a cap with angular radius r is contained inside the axis aligned box [center - r, center + r]. This makes it possible to just use a regular grid in R^4 instead of partitioning the sphere itself. Most of the cells are empty, because the sphere is a 3 dimensional subset of R^4, so the cells are hashed into a fixed number of buckets.
+
+Multiple cells can map into the same bucket so the values in a bucket are only candidates and have to be filtered by the caller.
+*/
+struct SpatialHash4 {
+	void reset(f32 cellSize, i32 bucketCount);
+	// Inserts the value into every cell overlapping the box.
+	void insert(Vec4 min, Vec4 max, i32 value);
+	// Has to be called after inserting and before querying.
+	void build();
+
+	// Calls f(value) for each value in each bucket overlapping the box. Each bucket is visited once, but a value inserted into multiple cells may be reported multiple times.
+	template<typename Function>
+	void forEachOverlapping(Vec4 min, Vec4 max, Function f);
+
+	f32 cellSize = 1.0f;
+	i32 bucketCount = 0;
+
+	struct Entry {
+		i32 bucket;
+		i32 value;
+	};
+	std::vector<Entry> entries;
+	// Values sorted by bucket. The values of bucket i are in the range [bucketStart[i], bucketStart[i + 1]).
+	std::vector<i32> bucketStart;
+	std::vector<i32> values;
+
+	std::vector<i32> bucketsScratch;
+
+	i32 bucketIndex(i32 x, i32 y, i32 z, i32 w) const;
+	i32 cellCoordinate(f32 v) const;
+};
+
+// Grid of caps that don't move. The caps are inserted into every cell they overlap so querying only needs to visit the cells overlapping the query.
+struct CapGrid {
+	// Has to be called after filling the caps.
+	void build();
+	// Calls f(i) once for each cap i overlapping the given cap.
+	template<typename Function>
+	void forEachOverlapping(const SphereCap& cap, Function f);
+
+	std::vector<SphereCap> caps;
+	SpatialHash4 grid;
+	// Used to remove duplicates from the query results without clearing anything between queries. A cap can be inserted into multiple buckets.
+	std::vector<i64> lastQueriedBy;
+	i64 queryCount = 0;
+};
+
+template<typename Function>
+void SpatialHash4::forEachOverlapping(Vec4 min, Vec4 max, Function f) {
+	if (bucketCount == 0) {
+		return;
+	}
+	const i32 x0 = cellCoordinate(min.x), x1 = cellCoordinate(max.x);
+	const i32 y0 = cellCoordinate(min.y), y1 = cellCoordinate(max.y);
+	const i32 z0 = cellCoordinate(min.z), z1 = cellCoordinate(max.z);
+	const i32 w0 = cellCoordinate(min.w), w1 = cellCoordinate(max.w);
+
+	bucketsScratch.clear();
+	for (i32 x = x0; x <= x1; x++) {
+		for (i32 y = y0; y <= y1; y++) {
+			for (i32 z = z0; z <= z1; z++) {
+				for (i32 w = w0; w <= w1; w++) {
+					bucketsScratch.push_back(bucketIndex(x, y, z, w));
+				}
+			}
+		}
+	}
+	// Different cells can hash to the same bucket.
+	std::ranges::sort(bucketsScratch);
+	const auto uniqueEnd = std::unique(bucketsScratch.begin(), bucketsScratch.end());
+
+	for (auto it = bucketsScratch.begin(); it != uniqueEnd; ++it) {
+		const auto bucket = *it;
+		for (i32 i = bucketStart[bucket]; i < bucketStart[bucket + 1]; i++) {
+			f(values[i]);
+		}
+	}
+}
+
+template<typename Function>
+void CapGrid::forEachOverlapping(const SphereCap& cap, Function f) {
+	queryCount++;
+	grid.forEachOverlapping(cap.center - Vec4(cap.angularRadius), cap.center + Vec4(cap.angularRadius), [&](i32 i) {
+		if (lastQueriedBy[i] == queryCount) {
+			return;
+		}
+		lastQueriedBy[i] = queryCount;
+		if (capsOverlap(cap, caps[i])) {
+			f(i);
+		}
+	});
+}
@@ -0,0 +1,117 @@
+#include "WallMesh.hpp"
+#include <game/Tiling.hpp>
+#include <game/Math.hpp>
+#include <map>
+
+WallMesh WallMesh::fromTiling(const Tiling& tiling) {
+	WallMesh mesh;
+	// The tiling vertices are already normalized.
+	mesh.vertices = tiling.vertices;
+	mesh.faceCount = tiling.faceCount();
+
+	std::map<std::pair<i32, i32>, i32> edgeIndices;
+	auto sortedPair = [](i32 a, i32 b) {
+		return a < b ? std::pair(a, b) : std::pair(b, a);
+	};
+	for (const auto& edge : tiling.edges) {
+		edgeIndices[sortedPair(edge.vertices[0], edge.vertices[1])] = i32(mesh.edges.size());
+		mesh.edges.push_back(Edge{ { edge.vertices[0], edge.vertices[1] } });
+	}
+	auto findEdge = [&](i32 a, i32 b) -> i32 {
+		const auto it = edgeIndices.find(sortedPair(a, b));
+		return it == edgeIndices.end() ? -1 : it->second;
+	};
+
+	for (i32 faceIndex = 0; faceIndex < tiling.faceCount(); faceIndex++) {
+		const auto face = tiling.verticesOfFace(faceIndex);
+		const auto faceVertexCount = i32(face.size());
+		for (i32 i = 1; i < faceVertexCount - 1; i++) {
+			Triangle triangle{
+				.vertices = { face[0], face[i], face[i + 1] },
+				.face = faceIndex,
+			};
+			const auto& v0 = mesh.vertices[triangle.vertices[0]];
+			const auto& v1 = mesh.vertices[triangle.vertices[1]];
+			const auto& v2 = mesh.vertices[triangle.vertices[2]];
+			triangle.planeNormal = crossProduct(v0, v1, v2).normalized();
+
+			// The edge v1 v2 is always on the boundary of the face. The other 2 are only on the boundary for the first and the last triangle of the fan.
+			const bool isBoundaryEdge[3]{ i == 1, true, i + 1 == faceVertexCount - 1 };
+			for (i32 j = 0; j < 3; j++) {
+				const auto a = triangle.vertices[j];
+				const auto b = triangle.vertices[(j + 1) % 3];
+				const auto& opposite = mesh.vertices[triangle.vertices[(j + 2) % 3]];
+				auto normal = crossProduct(mesh.vertices[a], mesh.vertices[b], triangle.planeNormal).normalized();
+				if (dot(normal, opposite) < 0.0f) {
+					normal = -normal;
+				}
+				triangle.edgeNormals[j] = normal;
+				triangle.edges[j] = isBoundaryEdge[j] ? findEdge(a, b) : -1;
+			}
+			mesh.triangles.push_back(triangle);
+			mesh.triangleGrid.caps.push_back(sphericalTriangleBoundingCap(v0, v1, v2));
+		}
+	}
+	mesh.triangleGrid.build();
+	return mesh;
+}
+
+i32 WallMesh::featureId(FeatureType type, i32 index) {
+	return i32((u32(type) << 30) | u32(index));
+}
+
+/*
+The edge normals are orthogonal to the plane normal so projecting the point onto the plane of the triangle doesn't change the dot products with them. If all of them are non negative the closest point is the projection.
+
+Otherwise the closest point is on one of the edges with a negative dot product. Projecting onto the plane of the edge gives a point on the great circle containing the edge. The plane of the edge from a to b cuts the great circle through the other edges at a and -a, so the point on the circle lies on the arc from a to b exactly when it's on the inner side of both of the other edges. If it isn't, the closest point is one of the endpoints.
+
+The candidates are compared using the dot product with the point instead of the angular distance, because the candidates are on the sphere and the cosine is decreasing.
+*/
+WallMesh::ClosestPoint WallMesh::closestPointOnTriangle(i32 triangleIndex, Vec4 point) const {
+	const auto& triangle = triangles[triangleIndex];
+	const auto projected = point - dot(point, triangle.planeNormal) * triangle.planeNormal;
+	const f32 d[3]{
+		dot(point, triangle.edgeNormals[0]),
+		dot(point, triangle.edgeNormals[1]),
+		dot(point, triangle.edgeNormals[2]),
+	};
+	if (d[0] >= 0.0f && d[1] >= 0.0f && d[2] >= 0.0f && projected.lengthSquared() > 0.0f) {
+		return ClosestPoint{ .point = projected.normalized(), .feature = featureId(FeatureType::FACE, triangle.face) };
+	}
+
+	ClosestPoint closest{ .point = vertices[triangle.vertices[0]], .feature = featureId(FeatureType::VERTEX, triangle.vertices[0]) };
+	f32 closestCosine = dot(closest.point, point);
+	auto consider = [&](Vec4 candidate, i32 feature) {
+		const auto cosine = dot(candidate, point);
+		if (cosine > closestCosine) {
+			closestCosine = cosine;
+			closest = ClosestPoint{ .point = candidate, .feature = feature };
+		}
+	};
+
+	for (i32 i = 0; i < 3; i++) {
+		if (d[i] >= 0.0f) {
+			continue;
+		}
+		const auto a = triangle.vertices[i];
+		const auto b = triangle.vertices[(i + 1) % 3];
+		const auto onCircle = projected - d[i] * triangle.edgeNormals[i];
+		const auto next = (i + 1) % 3;
+		const auto previous = (i + 2) % 3;
+		const auto isOnArc =
+			dot(onCircle, triangle.edgeNormals[next]) >= 0.0f &&
+			dot(onCircle, triangle.edgeNormals[previous]) >= 0.0f &&
+			onCircle.lengthSquared() > 0.0f;
+		if (isOnArc) {
+			const auto edge = triangle.edges[i];
+			const auto feature = edge == -1
+				? featureId(FeatureType::FACE, triangle.face)
+				: featureId(FeatureType::EDGE, edge);
+			consider(onCircle.normalized(), feature);
+		} else {
+			consider(vertices[a], featureId(FeatureType::VERTEX, a));
+			consider(vertices[b], featureId(FeatureType::VERTEX, b));
+		}
+	}
+	return closest;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <engine/Math/Vec4.hpp>
+#include <game/Physics/Body.hpp>
+#include <game/Physics/SpatialHash4.hpp>
+#include <vector>
+
+struct Tiling;
+
+/*
+Static collision geometry made of all the faces of a tiling. Creating a wall body for each triangle of each face duplicates the vertices and puts every triangle into the broad phase. The mesh is a single body instead and a sphere is only tested against the triangles found using its own grid.
+
+The faces are fan triangulated. The vertices are shared and the plane normals and the edge normals are normalized once when the mesh is created so finding the closest point doesn't need to normalize anything other than the result.
+
+The closest point also returns the feature it lies on. The diagonals of the fan triangulation are inside a face so a point on them belongs to the face. Faces sharing an edge or a vertex return the same feature so the contacts found using different triangles can be merged and the feature can be used to match the contacts between steps.
+*/
+struct WallMesh {
+	static WallMesh fromTiling(const Tiling& tiling);
+
+	struct Triangle {
+		i32 vertices[3];
+		// The edge from vertices[i] to vertices[(i + 1) % 3] or -1 if it's a diagonal of the face triangulation.
+		i32 edges[3];
+		i32 face;
+		Vec4 planeNormal;
+		// Inward pointing normal of the plane containing the edge from vertices[i] to vertices[(i + 1) % 3] and the plane normal.
+		Vec4 edgeNormals[3];
+	};
+	struct Edge {
+		i32 vertices[2];
+	};
+
+	std::vector<Vec4> vertices;
+	std::vector<Edge> edges;
+	std::vector<Triangle> triangles;
+	i32 faceCount = 0;
+	// Contains the bounding caps of the triangles.
+	CapGrid triangleGrid;
+
+	enum class FeatureType : u32 {
+		FACE = 0, EDGE = 1, VERTEX = 2
+	};
+	// The type is stored in the top 2 bits and the index of the face, edge or vertex in the rest. Stored in FeaturePair::value.
+	static i32 featureId(FeatureType type, i32 index);
+
+	struct ClosestPoint {
+		Vec4 point;
+		i32 feature;
+	};
+	// The point doesn't need to be on the sphere.
+	ClosestPoint closestPointOnTriangle(i32 triangleIndex, Vec4 point) const;
+
+	template<typename Function>
+	void forEachTriangleOverlapping(const SphereCap& cap, Function f);
+};
+
+// The geometry of the static bodies, which is stored outside of the bodies. Indexed by Body::wallIndex and Body::wallMeshIndex.
+struct StaticGeometry {
+	View<const Wall> walls;
+	// Not const, because querying the triangle grids uses scratch memory stored in the grid.
+	View<WallMesh> wallMeshes;
+};
+
+template<typename Function>
+void WallMesh::forEachTriangleOverlapping(const SphereCap& cap, Function f) {
+	triangleGrid.forEachOverlapping(cap, f);
+}
@@ -1,7 +1,11 @@
 #include "World.hpp"
 #include "Body.hpp"
 #include <game/4d.hpp>
+#include <game/Physics/ContinuousCollision.hpp>
+#include <game/Clock.hpp>
 #include <imgui/imgui.h>
+#include <bit>
+#include <algorithm>
 
 bool World::accumulateImpulses = true;
 bool World::warmStarting = true;
@@ -9,19 +13,54 @@ bool World::positionCorrection = true;
 
 void World::clear() {
 	bodies.reset();
+	accumulatedTime = 0.0f;
+	previousPositions.clear();
+	previousPositionBodies.clear();
 	contactConstraints.clear();
+	walls.clear();
+	wallMeshes.clear();
+	broadPhaseGrid.markStaticBodiesModified();
+	sleepingIslands.clear();
+	bodySleepingIsland.clear();
+	sleepingBodiesModified = true;
 }
 
 void World::broadPhase() {
-	for (auto it = contactConstraints.begin(); it != contactConstraints.end();) {
-		auto& key = it->first;
-		if (!bodies.isAlive(key.body1) || !bodies.isAlive(key.body2)) {
-			it = contactConstraints.erase(it);
-		} else {
-			++it;
+	if (useAllPairsBroadPhase) {
+		broadPhaseAllPairs();
+		return;
+	}
+
+	if (sleepingBodiesModified) {
+		sleepingBodiesModified = false;
+		sleepingBodiesScratch.clear();
+		for (const auto& [_, islandBodies] : sleepingIslands) {
+			sleepingBodiesScratch.insert(sleepingBodiesScratch.end(), islandBodies.begin(), islandBodies.end());
 		}
+		broadPhaseGrid.setSleepingBodies(bodies, constView(sleepingBodiesScratch), staticGeometry());
 	}
 
+	broadPhasePairs.clear();
+	broadPhaseGrid.findPairs(bodies, staticGeometry(), broadPhasePairs);
+	if (!broadPhaseGrid.touchedSleepingBodies.empty()) {
+		// The woken up bodies weren't included in the query so it has to be repeated. This only happens on the step the island is woken up.
+		for (const auto& id : broadPhaseGrid.touchedSleepingBodies) {
+			wake(id);
+		}
+		broadPhasePairs.clear();
+		broadPhaseGrid.findPairs(bodies, staticGeometry(), broadPhasePairs);
+	}
+
+	// Pairs that weren't reported by the broad phase aren't touching so their constraints are removed as stale. This also removes the constraints of destroyed bodies.
+	contactConstraints.beginUpdate();
+	for (const auto& key : broadPhasePairs) {
+		updateContactConstraint(key);
+	}
+	contactConstraints.removeStale();
+}
+
+void World::broadPhaseAllPairs() {
+	contactConstraints.beginUpdate();
 	for (auto i = bodies.begin(); i != bodies.end(); ++i) {
 		auto j = i;
 		++j;
@@ -32,32 +71,415 @@ void World::broadPhase() {
 				continue;
 			}
 
-			BodyIdPair key((*i).id, (*j).id);
-			const auto b1 = bodies.get(key.body1);
-			const auto b2 = bodies.get(key.body2);
-			if (!b1.has_value() || !b2.has_value()) {
-				CHECK_NOT_REACHED();
-				continue;
+			updateContactConstraint(BodyIdPair((*i).id, (*j).id));
+		}
+	}
+	contactConstraints.removeStale();
+}
+
+void World::updateContactConstraint(const BodyIdPair& key) {
+	const auto b1 = bodies.get(key.body1);
+	const auto b2 = bodies.get(key.body2);
+	if (!b1.has_value() || !b2.has_value()) {
+		CHECK_NOT_REACHED();
+		return;
+	}
+	Contact newContacts[ContactConstraint::MAX_POINTS];
+	const auto newContactCount = collide(newContacts, *b1, *b2, staticGeometry());
+
+	if (newContactCount == 0) {
+		return;
+	}
+
+	contactConstraints.update(key, newContacts, newContactCount, ContactConstraint::maxContactCount(*b1, *b2));
+}
+
+void World::solveContacts(f32 invDt) {
+	// Nothing creates bodies until the end of the step so the pointers stay valid.
+	contactConstraints.resolveBodies(bodies);
+	auto& constraints = contactConstraints.constraints;
+	const auto contacts = contactConstraints.contacts.data();
+	const auto& constraintBodies = contactConstraints.bodies;
+	const auto constraintCount = contactConstraints.size();
+
+	#ifdef __EMSCRIPTEN__
+	// The web build is compiled without pthreads, so creating the worker threads would fail.
+	solverThreadCount = 1;
+	#else
+	solverThreadCount = std::max(solverThreadCount, 1);
+	#endif
+	const auto useIslands = solverThreadCount > 1 || useGraphColoring;
+	// The islands are also used to decide which bodies can be put to sleep.
+	if (useIslands || allowSleeping) {
+		islands.build(contactConstraints, i32(bodies.entities.size()), useGraphColoring ? minColoredIslandConstraintCount : -1);
+	}
+
+	if (!useIslands) {
+		auto start = Clock::now();
+		for (i32 i = 0; i < constraintCount; i++) {
+			constraints[i].preStep(contacts, *constraintBodies[i].body1, *constraintBodies[i].body2, invDt);
+		}
+		lastStepTimings.preStep = millisecondsSince(start);
+
+		start = Clock::now();
+		for (i32 iteration = 0; iteration < iterations; iteration++) {
+			for (i32 i = 0; i < constraintCount; i++) {
+				constraints[i].applyImpulse(contacts, *constraintBodies[i].body1, *constraintBodies[i].body2);
 			}
-			ContactConstraint newArb(*b1, *b2);
-
-			if (newArb.numContacts > 0) {
-				auto iter = contactConstraints.find(key);
-				if (iter == contactConstraints.end()) {
-					contactConstraints.insert({ key, newArb });
-				} else {
-					iter->second.update(newArb.contacts, newArb.numContacts);
+		}
+		lastStepTimings.iterations = millisecondsSince(start);
+		return;
+	}
+
+	if (threadPool == nullptr || threadPool->threadCount() != solverThreadCount) {
+		threadPool = std::make_unique<ThreadPool>(solverThreadCount);
+	}
+	// Default constructed bodies have infinite mass and zero velocity, which is the same as the static bodies after integration.
+	staticBodyProxies.assign(solverThreadCount, Body());
+
+	auto body1 = [&](i32 constraint, i32 threadIndex) -> Body& {
+		const auto body = constraintBodies[constraint].body1;
+		return body->invMass == 0.0f ? staticBodyProxies[threadIndex] : *body;
+	};
+	auto body2 = [&](i32 constraint, i32 threadIndex) -> Body& {
+		const auto body = constraintBodies[constraint].body2;
+		return body->invMass == 0.0f ? staticBodyProxies[threadIndex] : *body;
+	};
+
+	// The colored islands are large so they are processed one at a time with the constraints of each color split between the threads.
+	auto forEachColorConstraint = [&](const ContactIslands::Island& island, auto&& f) {
+		for (i32 colorIndex = island.colorsStart; colorIndex < island.colorsEnd; colorIndex++) {
+			const auto& color = islands.colors[colorIndex];
+			if (color.isOverflow) {
+				for (i32 j = color.start; j < color.end; j++) {
+					f(islands.coloredConstraints[j], 0);
 				}
-			} else {
-				contactConstraints.erase(key);
+				continue;
 			}
+			threadPool->parallelFor(color.end - color.start, [&](i32 index, i32 threadIndex) {
+				f(islands.coloredConstraints[color.start + index], threadIndex);
+			});
 		}
+	};
+
+	// The islands don't share dynamic bodies so they can be solved in any order on any thread. The preStep is done in a separate pass only so it can be timed separately.
+	auto start = Clock::now();
+	threadPool->parallelFor(i32(islands.uncoloredIslands.size()), [&](i32 index, i32 threadIndex) {
+		const auto& island = islands.islands[islands.uncoloredIslands[index]];
+		for (i32 j = island.constraintsStart; j < island.constraintsEnd; j++) {
+			const auto i = islands.constraints[j];
+			constraints[i].preStep(contacts, body1(i, threadIndex), body2(i, threadIndex), invDt);
+		}
+	});
+	for (const auto islandIndex : islands.coloredIslands) {
+		forEachColorConstraint(islands.islands[islandIndex], [&](i32 i, i32 threadIndex) {
+			constraints[i].preStep(contacts, body1(i, threadIndex), body2(i, threadIndex), invDt);
+		});
 	}
+	lastStepTimings.preStep = millisecondsSince(start);
+
+	start = Clock::now();
+	threadPool->parallelFor(i32(islands.uncoloredIslands.size()), [&](i32 index, i32 threadIndex) {
+		const auto& island = islands.islands[islands.uncoloredIslands[index]];
+		for (i32 iteration = 0; iteration < iterations; iteration++) {
+			for (i32 j = island.constraintsStart; j < island.constraintsEnd; j++) {
+				const auto i = islands.constraints[j];
+				constraints[i].applyImpulse(contacts, body1(i, threadIndex), body2(i, threadIndex));
+			}
+		}
+	});
+	for (const auto islandIndex : islands.coloredIslands) {
+		const auto& island = islands.islands[islandIndex];
+		for (i32 iteration = 0; iteration < iterations; iteration++) {
+			forEachColorConstraint(island, [&](i32 i, i32 threadIndex) {
+				constraints[i].applyImpulse(contacts, body1(i, threadIndex), body2(i, threadIndex));
+			});
+		}
+	}
+	lastStepTimings.iterations = millisecondsSince(start);
+}
+
+u64 World::stateHash() const {
+	// FNV-1a over the bits of the state of every alive body, including the inactive ones.
+	u64 hash = 14695981039346656037ull;
+	auto add = [&hash](u32 value) {
+		hash ^= value;
+		hash *= 1099511628211ull;
+	};
+	for (i32 i = 0; i < i32(bodies.entities.size()); i++) {
+		if (bodies.entityIsFree[i]) {
+			continue;
+		}
+		const auto& body = bodies.entities[i];
+		add(u32(i));
+		for (i32 j = 0; j < 4; j++) {
+			add(std::bit_cast<u32>(body.position.data()[j]));
+			add(std::bit_cast<u32>(body.velocity.data()[j]));
+		}
+	}
+	return hash;
 }
 
 void World::settingsGui() {
 	ImGui::SliderFloat("resistance", &resistance, 0.0f, 1.0f);
-	ImGui::InputFloat4("gravity", gravity.data());
+	if (ImGui::InputFloat4("gravity", gravity.data())) {
+		wakeAll();
+	}
+	if (ImGui::Checkbox("all pairs broad phase", &useAllPairsBroadPhase)) {
+		wakeAll();
+	}
+	#ifndef __EMSCRIPTEN__
+	ImGui::SliderInt("solver threads", &solverThreadCount, 1, 16);
+	#endif
+	ImGui::Checkbox("graph coloring", &useGraphColoring);
+	ImGui::Checkbox("continuous collision", &useContinuousCollision);
+	if (ImGui::Checkbox("allow sleeping", &allowSleeping) && !allowSleeping) {
+		wakeAll();
+	}
+	ImGui::SliderFloat("fixed dt", &fixedDt, 1.0f / 240.0f, 1.0f / 15.0f);
+	ImGui::SliderInt("max steps per update", &maxStepsPerUpdate, 1, 16);
+	ImGui::Text("dropped steps %lld", static_cast<long long>(droppedStepCount));
+}
+
+i32 World::update(f32 frameDt) {
+	if (fixedDt <= 0.0f) {
+		CHECK_NOT_REACHED();
+		return 0;
+	}
+	accumulatedTime += frameDt;
+	auto stepCount = i32(accumulatedTime / fixedDt);
+	if (stepCount > maxStepsPerUpdate) {
+		const auto droppedCount = stepCount - maxStepsPerUpdate;
+		droppedStepCount += droppedCount;
+		accumulatedTime -= f32(droppedCount) * fixedDt;
+		stepCount = maxStepsPerUpdate;
+	}
+	for (i32 i = 0; i < stepCount; i++) {
+		// Only the state before the last step is interpolated.
+		if (i == stepCount - 1) {
+			savePreviousPositions();
+		}
+		step(fixedDt);
+		accumulatedTime -= fixedDt;
+	}
+	// Rounding errors can leave slightly less than zero or slightly more than a whole step.
+	accumulatedTime = std::clamp(accumulatedTime, 0.0f, fixedDt);
+	return stepCount;
+}
+
+f32 World::interpolationAlpha() const {
+	if (fixedDt <= 0.0f) {
+		return 1.0f;
+	}
+	return std::clamp(accumulatedTime / fixedDt, 0.0f, 1.0f);
+}
+
+void World::savePreviousPositions() {
+	previousPositions.resize(bodies.entities.size());
+	previousPositionBodies.resize(bodies.entities.size(), BodyId::invalid());
+	// The sleeping bodies aren't iterated. They don't move so they are drawn at the current position.
+	for (auto body : bodies) {
+		previousPositions[body.id.index()] = body->position;
+		previousPositionBodies[body.id.index()] = body.id;
+	}
+}
+
+Vec4 World::interpolatedPosition(const BodyId& id) const {
+	const auto body = bodies.get(id);
+	if (!body.has_value()) {
+		const auto sleepingBody = bodies.getEvenIfInactive(id);
+		return sleepingBody.has_value() ? sleepingBody->position : Vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	}
+	const auto index = id.index();
+	if (index >= i32(previousPositionBodies.size()) || previousPositionBodies[index] != id) {
+		return body->position;
+	}
+	return sphereSlerp(previousPositions[index], body->position, interpolationAlpha());
+}
+
+void World::applyForce(const BodyId& id, Vec4 force) {
+	wake(id);
+	auto body = bodies.get(id);
+	if (!body.has_value()) {
+		return;
+	}
+	body->force += force;
+}
+
+void World::wake(const BodyId& id) {
+	if (id.index() >= i32(bodySleepingIsland.size())) {
+		return;
+	}
+	const auto islandId = bodySleepingIsland[id.index()];
+	if (islandId == -1) {
+		return;
+	}
+	const auto island = sleepingIslands.find(islandId);
+	if (island == sleepingIslands.end()) {
+		CHECK_NOT_REACHED();
+		return;
+	}
+	for (const auto& bodyId : island->second) {
+		// Does nothing if the body was destroyed while sleeping.
+		bodies.activate(bodyId);
+		bodySleepingIsland[bodyId.index()] = -1;
+		if (auto body = bodies.get(bodyId); body.has_value()) {
+			body->sleepTime = 0.0f;
+		}
+	}
+	sleepingIslands.erase(island);
+	sleepingBodiesModified = true;
+}
+
+void World::wakeAll() {
+	while (!sleepingIslands.empty()) {
+		const auto& islandBodies = sleepingIslands.begin()->second;
+		if (islandBodies.empty()) {
+			sleepingIslands.erase(sleepingIslands.begin());
+			continue;
+		}
+		wake(islandBodies.front());
+	}
+}
+
+void World::updateSleeping(f32 dt) {
+	// The all pairs broad phase doesn't report the touched sleeping bodies.
+	if (!allowSleeping || useAllPairsBroadPhase) {
+		return;
+	}
+
+	const auto bodyIndexCount = i32(bodies.entities.size());
+	islandMinSleepTime.clear();
+	islandMinSleepTime.resize(bodyIndexCount, INFINITY);
+	const auto thresholdSquared = sleepVelocityThreshold * sleepVelocityThreshold;
+	for (i32 i = 0; i < i32(dynamicBodyPointers.size()); i++) {
+		auto& body = *dynamicBodyPointers[i];
+		if (body.velocity.lengthSquared() > thresholdSquared) {
+			body.sleepTime = 0.0f;
+		} else {
+			body.sleepTime += dt;
+		}
+		// The bodies that aren't in any constraint are their own roots.
+		const auto root = islands.findRoot(dynamicBodyIds[i].index());
+		islandMinSleepTime[root] = std::min(islandMinSleepTime[root], body.sleepTime);
+	}
+
+	bodySleepingIsland.resize(bodyIndexCount, -1);
+	islandRootSleepingIsland.clear();
+	islandRootSleepingIsland.resize(bodyIndexCount, -1);
+	for (i32 i = 0; i < i32(dynamicBodyPointers.size()); i++) {
+		const auto& id = dynamicBodyIds[i];
+		const auto root = islands.findRoot(id.index());
+		if (islandMinSleepTime[root] < timeToSleep) {
+			continue;
+		}
+		auto& islandId = islandRootSleepingIsland[root];
+		if (islandId == -1) {
+			islandId = nextSleepingIslandId++;
+		}
+		sleepingIslands[islandId].push_back(id);
+		bodySleepingIsland[id.index()] = islandId;
+		dynamicBodyPointers[i]->velocity = Vec4(0.0f);
+		bodies.deactivate(id);
+		sleepingBodiesModified = true;
+	}
+}
+
+void World::findTimesOfImpact(f32 dt) {
+	timesOfImpact.clear();
+	if (!useContinuousCollision || useAllPairsBroadPhase) {
+		return;
+	}
+
+	ccdFastBodies.clear();
+	f32 maxDisplacement = 0.0f;
+	f32 maxRadius = 0.0f;
+	for (i32 i = 0; i < integrationBatch.count(); i++) {
+		const auto displacement = integrationBatch.velocity(i).length() * dt;
+		const auto radius = dynamicBodyPointers[i]->radius;
+		maxDisplacement = std::max(maxDisplacement, displacement);
+		maxRadius = std::max(maxRadius, radius);
+		if (displacement > ccdMotionThreshold * radius) {
+			ccdFastBodies.push_back(i);
+		}
+	}
+	if (ccdFastBodies.empty()) {
+		return;
+	}
+
+	ccdStateIndexOfBody.clear();
+	ccdStateIndexOfBody.resize(bodies.entities.size(), -1);
+	for (i32 i = 0; i < i32(dynamicBodyIds.size()); i++) {
+		ccdStateIndexOfBody[dynamicBodyIds[i].index()] = i;
+	}
+
+	for (const auto i : ccdFastBodies) {
+		const auto position = integrationBatch.position(i);
+		const auto velocity = integrationBatch.velocity(i);
+		const auto radius = dynamicBodyPointers[i]->radius;
+		const auto displacement = velocity.length() * dt;
+		f32 timeOfImpact = dt;
+
+		// Contains the whole swept sphere.
+		const SphereCap sweptCap{
+			.center = positionAlongGeodesic(position, velocity, dt / 2.0f),
+			.angularRadius = radius + displacement / 2.0f
+		};
+
+		broadPhaseGrid.staticBodies.forEachOverlapping(sweptCap, [&](i32 j) {
+			const auto wall = bodies.get(broadPhaseGrid.staticBodies.bodies[j]);
+			if (!wall.has_value() || !wall->isWall()) {
+				return;
+			}
+			const auto t = sphereWallTimeOfImpact(position, velocity, radius, walls[wall->wallIndex], timeOfImpact);
+			if (t.has_value()) {
+				timeOfImpact = *t;
+			}
+		});
+		for (const auto& meshId : broadPhaseGrid.wallMeshBodies) {
+			const auto meshBody = bodies.get(meshId);
+			if (!meshBody.has_value()) {
+				continue;
+			}
+			auto& mesh = wallMeshes[meshBody->wallMeshIndex];
+			mesh.forEachTriangleOverlapping(sweptCap, [&](i32 triangle) {
+				const auto t = sphereWallMeshTriangleTimeOfImpact(position, velocity, radius, mesh, triangle, timeOfImpact);
+				if (t.has_value()) {
+					timeOfImpact = *t;
+				}
+			});
+		}
+
+		auto testBody = [&](i32 other) {
+			if (other == -1 || other == i) {
+				return;
+			}
+			const auto t = sphereSphereTimeOfImpact(
+				position, velocity, radius,
+				integrationBatch.position(other), integrationBatch.velocity(other), dynamicBodyPointers[other]->radius,
+				timeOfImpact);
+			if (t.has_value()) {
+				timeOfImpact = *t;
+			}
+		};
+		// The dynamic grid stores the centers at the start of the step. The other bodies can move at most maxDisplacement.
+		const auto expand = sweptCap.angularRadius + maxRadius + maxDisplacement;
+		const auto cellsPerAxis = 2.0f * expand / broadPhaseGrid.dynamicGrid.cellSize + 1.0f;
+		if (pow(cellsPerAxis, 4.0f) > f32(integrationBatch.count())) {
+			// Very fast bodies would visit more cells than there are bodies.
+			for (i32 other = 0; other < integrationBatch.count(); other++) {
+				testBody(other);
+			}
+		} else {
+			broadPhaseGrid.dynamicGrid.forEachOverlapping(sweptCap.center - Vec4(expand), sweptCap.center + Vec4(expand), [&](i32 j) {
+				testBody(ccdStateIndexOfBody[broadPhaseGrid.dynamicBodies[j].index()]);
+			});
+		}
+
+		if (timeOfImpact < dt) {
+			timesOfImpact.push_back(TimeOfImpact{ .stateIndex = i, .time = timeOfImpact, .position = position, .velocity = velocity });
+		}
+	}
 }
 
 void World::createSphere(Vec4 position, f32 radius, f32 mass) {
@@ -69,71 +491,106 @@ void World::createSphere(Vec4 position, f32 radius, f32 mass) {
 EntityArrayPair<Body> World::createWall(Vec4 v0, Vec4 v1, Vec4 v2, Vec4 edgeV2ToV0InwardNormal, Vec4 edgeV0ToV1InwardNormal, Vec4 edgeV1ToV2InwardNormal, Vec4 polygonPlaneNormal) {
 	auto b = bodies.create();
 	b->set(0.0f, INFINITY);
-	b->s = true;
-
-	b->edgeNormal0 = edgeV2ToV0InwardNormal;
-	b->edgeNormal1 = edgeV0ToV1InwardNormal;
-	b->edgeNormal2 = edgeV1ToV2InwardNormal;
-	b->v0 = v0;
-	b->v1 = v1;
-	b->v2 = v2;
-	b->planeNormal = polygonPlaneNormal;
+
+	const auto index = b.id.index();
+	if (index >= i32(walls.size())) {
+		walls.resize(index + 1);
+	}
+	walls[index] = Wall{
+		.planeNormal = polygonPlaneNormal,
+		.v0 = v0,
+		.v1 = v1,
+		.v2 = v2,
+		// Normalized once here so closestPointOnTriangle doesn't have to do it on every call.
+		.edgeNormal0 = edgeV2ToV0InwardNormal.normalized(),
+		.edgeNormal1 = edgeV0ToV1InwardNormal.normalized(),
+		.edgeNormal2 = edgeV1ToV2InwardNormal.normalized(),
+	};
+	b->wallIndex = index;
+	return b;
+}
+
+EntityArrayPair<Body> World::createWallMesh(const Tiling& tiling) {
+	auto b = bodies.create();
+	b->set(0.0f, INFINITY);
+	b->wallMeshIndex = i32(wallMeshes.size());
+	wallMeshes.push_back(WallMesh::fromTiling(tiling));
 	return b;
 }
 
+StaticGeometry World::staticGeometry() {
+	return StaticGeometry{ .walls = constView(walls), .wallMeshes = view(wallMeshes) };
+}
+
 void World::step(f32 dt) {
 	bodies.update();
+	bool staticBodiesAdded = false;
+	for (const auto& id : bodies.entitiesAddedLastFrame()) {
+		// The index could have belonged to a body destroyed while sleeping.
+		if (id.index() < i32(bodySleepingIsland.size())) {
+			bodySleepingIsland[id.index()] = -1;
+		}
+		const auto body = bodies.get(id);
+		if (body.has_value() && body->invMass == 0.0f) {
+			staticBodiesAdded = true;
+		}
+	}
+	if (staticBodiesAdded) {
+		broadPhaseGrid.markStaticBodiesModified();
+		wakeAll();
+	}
 	const f32 invDt = dt > 0.0f ? 1.0f / dt : 0.0f;
+	lastStepTimings = StepTimings{};
 
+	auto start = Clock::now();
 	broadPhase();
+	lastStepTimings.broadPhase = millisecondsSince(start);
 
+	start = Clock::now();
+	integrationBatch.clear();
+	dynamicBodyPointers.clear();
+	dynamicBodyIds.clear();
 	for (auto b : bodies) {
 		if (b->invMass == 0.0f) {
 			b->velocity = Vec4(0.0f);
 			b->position = Vec4(0.0f, 0.0f, 0.0f, 1.0f);
 			continue;
 		}
-
-		// It doesn't matter if the parts of vectors that are outside the tangent space are removed before or after adding, because the removing is linear.
-		Vec4 a = dt * (gravity + b->invMass * b->force);
-		b->velocity += a;
-		b->velocity *= resistance;
-		b->velocity = projectVectorToSphereTangentSpace(b->position, b->velocity);
+		integrationBatch.add(b.entity);
+		dynamicBodyPointers.push_back(&b.entity);
+		dynamicBodyIds.push_back(b.id);
 	}
+	const auto dynamicBodies = constView(dynamicBodyPointers);
 
-	for (auto& [key, constraint] : contactConstraints) {
-		// @Performance: Maybe precompute the references to the bodies somewhere so this doesn't have to call get each time.
-		auto a = bodies.get(key.body1);
-		auto b = bodies.get(key.body2);
-		if (!a.has_value() || !b.has_value()) {
-			CHECK_NOT_REACHED();
-			continue;
-		}
-			
-		constraint.preStep(*a, *b, invDt);
-	}
+	// It doesn't matter if the parts of vectors that are outside the tangent space are removed before or after adding, because the removing is linear.
+	integrateForces(integrationBatch, gravity, resistance, dt);
+	integrationBatch.scatterVelocities(dynamicBodies);
+	lastStepTimings.integration = millisecondsSince(start);
 
-	for (i32 i = 0; i < iterations; i++) {
-		for (auto& [key, constraint] : contactConstraints) {
-			auto a = bodies.get(key.body1);
-			auto b = bodies.get(key.body2);
-			if (!a.has_value() || !b.has_value()) {
-				CHECK_NOT_REACHED();
-				continue;
-			}
+	solveContacts(invDt);
 
-			constraint.applyImpulse(*a, *b);
-		}
+	start = Clock::now();
+	// The static bodies don't move so only the dynamic bodies need to be updated.
+	integrationBatch.gatherVelocities(dynamicBodies);
+	projectVelocitiesToSphereTangentSpace(integrationBatch);
+	for (i32 i = 0; i < integrationBatch.count(); i++) {
+		// The cosine of the angle between the position and the velocity is below 0.02. Multiplied by the lengths so it also holds for bodies at rest.
+		const auto position = integrationBatch.position(i);
+		const auto velocity = integrationBatch.velocity(i);
+		ASSERT(dot(position, velocity) <= 0.02f * position.length() * velocity.length());
 	}
-
-	for (auto b : bodies) {
-		b->velocity = projectVectorToSphereTangentSpace(b->position, b->velocity);
-		const auto t = dot(b->position.normalized(), b->velocity.normalized());
-		CHECK(t < 0.02f);
-		// @Performance: This is probable doable using only quaternions instead of matrix multiplications.
-		const auto movement = movementForwardOnSphere(b->position, b->velocity * dt);
-		b->position = moveForwardOnSphere(b->position, b->velocity * dt);
-		b->velocity = movement * b->velocity;
-		b->force = Vec4(0.0f);
+	findTimesOfImpact(dt);
+	moveForwardOnSphere(integrationBatch, dt);
+	for (const auto& impact : timesOfImpact) {
+		integrationBatch.setPositionAndVelocity(impact.stateIndex,
+			positionAlongGeodesic(impact.position, impact.velocity, impact.time),
+			velocityAlongGeodesic(impact.position, impact.velocity, impact.time));
 	}
+	integrationBatch.scatterPositionsAndVelocities(dynamicBodies);
+	for (auto body : dynamicBodyPointers) {
+		body->force = Vec4(0.0f);
+	}
+	lastStepTimings.integration += millisecondsSince(start);
+
+	updateSleeping(dt);
 }
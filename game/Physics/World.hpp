@@ -1,10 +1,16 @@
 #pragma once
 #include <vector>
-#include <map>
 #include <engine/Math/Vec4.hpp>
 #include "ContactConstraint.hpp"
+#include <game/Physics/ContactManager.hpp>
 #include <game/EntityArray.hpp>
 #include <game/Physics/Body.hpp>
+#include <game/Physics/BroadPhase.hpp>
+#include <game/Physics/BodyStates.hpp>
+#include <game/Physics/ContactIslands.hpp>
+#include <game/ThreadPool.hpp>
+#include <memory>
+#include <map>
 //void initializeBodyIdPair(BodyId& a, BodyId& b);
 
 struct World {
@@ -14,7 +20,44 @@ struct World {
 
 	void step(f32 dt);
 
+	/*
+	Fixed timestep stepping. update adds the frame time to an accumulator and calls step(fixedDt) while at least fixedDt of time is accumulated, so the simulation doesn't depend on the frame rate. Increasing fixedDt lowers the cost of the simulation.
+	At most maxStepsPerUpdate steps are taken in a single update. The rest of the whole steps is dropped so a slow frame doesn't make the next frame even slower. The simulation runs slower than real time instead.
+	The accumulated time left after the steps is between the last 2 states so the bodies should be rendered at interpolatedPosition, which moves along the geodesic between the position before and after the last step. This removes the jitter caused by a varying number of steps per frame. The rendered state is behind the simulation by at most one step.
+	*/
+	f32 fixedDt = 1.0f / 60.0f;
+	i32 maxStepsPerUpdate = 4;
+	f32 accumulatedTime = 0.0f;
+	i64 droppedStepCount = 0;
+	// Returns the number of steps taken.
+	i32 update(f32 frameDt);
+	// The fraction of the last step the rendered state is at. In the range [0, 1]. It is 1 when the accumulator was clamped to fixedDt after dropping steps and when fixedDt isn't positive.
+	f32 interpolationAlpha() const;
+	Vec4 interpolatedPosition(const BodyId& id) const;
+	void savePreviousPositions();
+	// Indexed by the body index. The positions before the last step taken by update.
+	std::vector<Vec4> previousPositions;
+	// The bodies the previous positions belong to. The bodies created after the last step don't have a previous position.
+	std::vector<BodyId> previousPositionBodies;
+
 	void broadPhase();
+	// The old O(n^2) loop over every pair of bodies. Kept for comparison.
+	void broadPhaseAllPairs();
+	void updateContactConstraint(const BodyIdPair& key);
+	bool useAllPairsBroadPhase = false;
+	BroadPhase broadPhaseGrid;
+	std::vector<BodyIdPair> broadPhasePairs;
+
+	// Durations of the phases of the last step in milliseconds. The integration includes both the force integration before the solver and the movement after it.
+	struct StepTimings {
+		f64 broadPhase = 0.0;
+		f64 preStep = 0.0;
+		f64 iterations = 0.0;
+		f64 integration = 0.0;
+	};
+	StepTimings lastStepTimings;
+	// Hash of the positions and velocities of all the bodies including the sleeping ones. Used to check if the simulation is deterministic.
+	u64 stateHash() const;
 
 	f32 resistance = 0.97f;
 	Vec4 gravity = Vec4(0.0f);
@@ -24,8 +67,73 @@ struct World {
 	BodyArray bodies;
 	void createSphere(Vec4 position, f32 radius, f32 mass);
 	EntityArrayPair<Body> createWall(Vec4 v0, Vec4 v1, Vec4 v2, Vec4 edgeV2ToV0InwardNormal, Vec4 edgeV0ToV1InwardNormal, Vec4 edgeV1ToV2InwardNormal, Vec4 polygonPlaneNormal);
+	// Indexed by the index of the wall body. Kept outside of Body so the bodies stay small.
+	std::vector<Wall> walls;
+	// Creates a single static body colliding with all the faces of the tiling.
+	EntityArrayPair<Body> createWallMesh(const Tiling& tiling);
+	// Indexed by Body::wallMeshIndex. The meshes of destroyed bodies are only freed by clear().
+	std::vector<WallMesh> wallMeshes;
+	StaticGeometry staticGeometry();
+
+	// Adds the force and wakes up the body if it's sleeping. Setting the force directly doesn't work for sleeping bodies, because they are deactivated.
+	void applyForce(const BodyId& id, Vec4 force);
+
+	/*
+	Bodies that move slower than sleepVelocityThreshold for timeToSleep seconds are put to sleep, but only if every body in their contact island can be put to sleep. The whole island is then deactivated in the BodyArray so it isn't iterated by the broad phase, the integration and the solver.
+	The island is woken up when an awake body touches one of its bodies, when a force is applied to one of its bodies using applyForce or when the static bodies or gravity change.
+	Anything iterating over the bodies (for example rendering) has to also go over the sleeping bodies using sleepingIslands.
+	The contact constraints of sleeping bodies are removed so they lose the accumulated impulses.
+	*/
+	bool allowSleeping = true;
+	f32 sleepVelocityThreshold = 0.01f;
+	f32 timeToSleep = 0.5f;
+	void wake(const BodyId& id);
+	void wakeAll();
+	void updateSleeping(f32 dt);
+	// Ordered map so the order of the sleeping bodies doesn't depend on the hash function.
+	std::map<i32, std::vector<BodyId>> sleepingIslands;
+	i32 nextSleepingIslandId = 0;
+	// Indexed by the body index. -1 if the body isn't sleeping.
+	std::vector<i32> bodySleepingIsland;
+	bool sleepingBodiesModified = false;
+	std::vector<BodyId> sleepingBodiesScratch;
+	std::vector<f32> islandMinSleepTime;
+	std::vector<i32> islandRootSleepingIsland;
+
+	/*
+	Bodies moving more than ccdMotionThreshold times their radius in a step are swept along their geodesics against the walls and the other dynamic bodies. If they would hit something their movement is stopped at the time of impact and the contact is handled by the solver on the next step. This loses the remaining part of the movement, but prevents tunneling through the walls without making the step smaller.
+	Uses the broad phase grids so it's skipped with the all pairs broad phase.
+	*/
+	bool useContinuousCollision = true;
+	f32 ccdMotionThreshold = 0.5f;
+	void findTimesOfImpact(f32 dt);
+	struct TimeOfImpact {
+		i32 stateIndex;
+		f32 time;
+		Vec4 position;
+		Vec4 velocity;
+	};
+	std::vector<TimeOfImpact> timesOfImpact;
+	std::vector<i32> ccdFastBodies;
+	// Indexed by the body index. -1 if the body isn't in integrationBatch.
+	std::vector<i32> ccdStateIndexOfBody;
+
+	// Scratch copy of the dynamic bodies refilled every step so the integration can run on 4 bodies at once. The bodies in the BodyArray are the state of the simulation. The velocities are copied back before the solver and everything is copied back at the end of the step.
+	BodyStates integrationBatch;
+	std::vector<Body*> dynamicBodyPointers;
+	std::vector<BodyId> dynamicBodyIds;
 	//std::vector<Joint*> joints;
-	std::map<BodyIdPair, ContactConstraint> contactConstraints;
+	ContactManager contactConstraints;
+
+	void solveContacts(f32 invDt);
+	// With 1 thread and coloring disabled the constraints are solved in a single loop without building the islands. Always 1 on the web build.
+	i32 solverThreadCount = 1;
+	bool useGraphColoring = false;
+	i32 minColoredIslandConstraintCount = 256;
+	ContactIslands islands;
+	std::unique_ptr<ThreadPool> threadPool;
+	// Used in place of the static bodies so threads solving different islands don't write to the same body. Applying impulses to static bodies doesn't change them, but it still writes the velocity. One for each thread.
+	std::vector<Body> staticBodyProxies;
 	i32 iterations;
 	static bool accumulateImpulses;
 	static bool warmStarting;
@@ -0,0 +1,93 @@
+#include "Polytopes.hpp"
+
+/*
+The boards loaded from the data generated by outputPolytope4DataCpp. The headers are large so this is only compiled into the tools. The game loads the processed tilings from the files created by the tiling converter instead.
+*/
+
+FlatPolytope4 makeFlatPolytope4(
+	View<const Vec4> vertices,
+	View<const i32> edgesVertices,
+	View<const i32> facesEdges,
+	View<const i32> edgesPerFace,
+	View<const i32> cellsFaces,
+	View<const i32> facesPerCell) {
+	FlatPolytope4 r;
+	r.vertices.assign(vertices.begin(), vertices.end());
+	r.edgesVertices.assign(edgesVertices.begin(), edgesVertices.end());
+	r.facesEdges.assign(facesEdges.begin(), facesEdges.end());
+	r.cellsFaces.assign(cellsFaces.begin(), cellsFaces.end());
+
+	// The data stores the sizes so the offsets are their prefix sums.
+	auto addOffsets = [](std::vector<i32>& offsets, View<const i32> subCellsPerCell) {
+		offsets.reserve(subCellsPerCell.size() + 1);
+		for (const auto& count : subCellsPerCell) {
+			offsets.push_back(offsets.back() + count);
+		}
+	};
+	addOffsets(r.facesEdgesOffsets, edgesPerFace);
+	addOffsets(r.cellsFacesOffsets, facesPerCell);
+	return r;
+}
+
+Polytope makePolytope4(
+	View<const Vec4> vertices,
+	View<const i32> edgesVertices,
+	View<const i32> facesEdges,
+	View<const i32> edgesPerFace,
+	View<const i32> cellsFaces,
+	View<const i32> facesPerCell) {
+	return toPolytope(makeFlatPolytope4(vertices, edgesVertices, facesEdges, edgesPerFace, cellsFaces, facesPerCell));
+}
+
+#define MAKE_POLYTOPE4(name) makePolytope4(constView(name##vertices), constView(name##EdgesVertices), constView(name##FacesEdges), constView(name##EdgesPerFace), constView(name##CellsFaces), constView(name##FacesPerCell))
+#define MAKE_FLAT_POLYTOPE4(name) makeFlatPolytope4(constView(name##vertices), constView(name##EdgesVertices), constView(name##FacesEdges), constView(name##EdgesPerFace), constView(name##CellsFaces), constView(name##FacesPerCell))
+
+#include "600cell.hpp"
+
+Polytope make600cell() {
+	return MAKE_POLYTOPE4(cell600);
+}
+
+FlatPolytope4 makeFlat600cell() {
+	return MAKE_FLAT_POLYTOPE4(cell600);
+}
+
+#include "120cell.hpp"
+
+Polytope make120cell() {
+	return MAKE_POLYTOPE4(cell120);
+	//return generate120cell();
+}
+
+FlatPolytope4 makeFlat120cell() {
+	return MAKE_FLAT_POLYTOPE4(cell120);
+}
+
+#include "Rectified600cell.hpp"
+Polytope makeRectified600cell() {
+	return MAKE_POLYTOPE4(rectified600cell);
+}
+
+FlatPolytope4 makeFlatRectified600cell() {
+	return MAKE_FLAT_POLYTOPE4(rectified600cell);
+}
+
+#include "Snub24cell.hpp"
+
+Polytope makeSnub24cell() {
+	return MAKE_POLYTOPE4(snub24cell);
+}
+
+FlatPolytope4 makeFlatSnub24cell() {
+	return MAKE_FLAT_POLYTOPE4(snub24cell);
+}
+
+#include "SubdiviedHypercube.hpp"
+
+Polytope makeSubdiviedHypercube2() {
+	return MAKE_POLYTOPE4(subdiviedHypercube);
+}
+
+FlatPolytope4 makeFlatSubdiviedHypercube2() {
+	return MAKE_FLAT_POLYTOPE4(subdiviedHypercube);
+}
@@ -6,7 +6,7 @@
 #include <array>
 #include <game/ConvexHull.hpp>
 #include <engine/Math/Quat.hpp>
-#include <game/600cell.hpp>
+#include <engine/Math/Angles.hpp>
 #include <StaticList.hpp>
 #include <View.hpp>
 
@@ -346,33 +346,111 @@ void subdivideCube(
 
 #include <iostream>
 
-Polytope removedDuplicates(Polytope&& p) {
-	Polytope result;
+/*
+The kept vertices are stored in a hashed grid with cells of size 2 * maxDistance. If 2 points are closer than maxDistance then their coordinates differ by less than maxDistance along every axis, so the kept vertex can only be in one of the cells overlapping the box [vertex - maxDistance, vertex + maxDistance]. The box overlaps at most 2 cells along each axis so at most 2^dimension cells are checked for each vertex.
+
+The cell coordinates are hashed into a single number. Different cells can have the same hash, which only adds candidates that are then rejected by the distance check.
+
+Out of the kept vertices that are close enough the one with the lowest index is chosen, which gives the same result as checking the kept vertices in order.
+*/
+std::vector<i32> weldedVertexIndices(const std::vector<Polytope::PointN>& vertices, f32 maxSquaredDistance) {
 	std::vector<i32> oldToNew;
+	oldToNew.reserve(vertices.size());
+	if (vertices.empty()) {
+		return oldToNew;
+	}
+	const auto dimension = i32(vertices[0].size());
+	const auto maxDistance = sqrt(maxSquaredDistance);
+	const auto cellSize = 2.0f * maxDistance;
+
+	auto cellCoordinate = [&](f32 v) -> i64 {
+		return i64(floor(v / cellSize));
+	};
+	auto cellHash = [&](const std::vector<i64>& cell) -> u64 {
+		// FNV-1a over the coordinates.
+		u64 hash = 14695981039346656037ull;
+		for (const auto& coordinate : cell) {
+			hash ^= u64(coordinate);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	};
+	auto squaredDistance = [&](const Polytope::PointN& a, const Polytope::PointN& b) {
+		f32 result = 0.0f;
+		for (i32 i = 0; i < dimension; i++) {
+			const auto d = a[i] - b[i];
+			result += d * d;
+		}
+		return result;
+	};
 
-	//oldToNew.resize(p.vertices.size());
-	oldToNew.clear();
-	for (auto& vertex : p.vertices) {
-		bool alreadyAdded = false;
-		for (i32 alreadyAddedVertexI = 0; alreadyAddedVertexI < result.vertices.size(); alreadyAddedVertexI++) {
-			const auto& alreadyAddedVertex = result.vertices[alreadyAddedVertexI];
-
-			auto dist = [](const std::vector<f32>& a, const std::vector<f32>& b) {
-				f32 result = 0.0f;
-				for (i32 i = 0; i < a.size(); i++) {
-					result += pow(a[i] - b[i], 2.0f);
+	// Linked lists of the kept vertices in each cell. The values are indices into keptVertices.
+	std::unordered_map<u64, i32> cellFirstVertex;
+	std::vector<i32> nextInCell;
+	std::vector<i32> keptVertices;
+
+	std::vector<i64> cellMin(dimension), cellMax(dimension), cell(dimension);
+	for (i32 vertexI = 0; vertexI < i32(vertices.size()); vertexI++) {
+		const auto& vertex = vertices[vertexI];
+		for (i32 i = 0; i < dimension; i++) {
+			cellMin[i] = cellCoordinate(vertex[i] - maxDistance);
+			cellMax[i] = cellCoordinate(vertex[i] + maxDistance);
+		}
+
+		i32 firstKept = -1;
+		// Iterates over all the cells in the box like an odometer.
+		cell = cellMin;
+		for (;;) {
+			const auto it = cellFirstVertex.find(cellHash(cell));
+			if (it != cellFirstVertex.end()) {
+				for (i32 kept = it->second; kept != -1; kept = nextInCell[kept]) {
+					if (firstKept != -1 && kept >= firstKept) {
+						continue;
+					}
+					if (squaredDistance(vertex, vertices[keptVertices[kept]]) < maxSquaredDistance) {
+						firstKept = kept;
+					}
 				}
-				return result;
-			};
-			if (dist(vertex, alreadyAddedVertex) < 0.01f) {
-				oldToNew.push_back(alreadyAddedVertexI);
-				alreadyAdded = true;
+			}
+
+			i32 axis = 0;
+			for (; axis < dimension; axis++) {
+				if (cell[axis] < cellMax[axis]) {
+					cell[axis]++;
+					break;
+				}
+				cell[axis] = cellMin[axis];
+			}
+			if (axis == dimension) {
 				break;
 			}
 		}
-		if (!alreadyAdded) {
-			oldToNew.push_back(i32(result.vertices.size()));
-			result.vertices.push_back(std::move(vertex));
+
+		if (firstKept != -1) {
+			oldToNew.push_back(firstKept);
+			continue;
+		}
+		const auto newIndex = i32(keptVertices.size());
+		oldToNew.push_back(newIndex);
+		keptVertices.push_back(vertexI);
+		for (i32 i = 0; i < dimension; i++) {
+			cell[i] = cellCoordinate(vertex[i]);
+		}
+		// The new vertex is added to the front of the list.
+		const auto [it, inserted] = cellFirstVertex.try_emplace(cellHash(cell), newIndex);
+		nextInCell.push_back(inserted ? -1 : it->second);
+		it->second = newIndex;
+	}
+	return oldToNew;
+}
+
+Polytope removedDuplicates(Polytope&& p, f32 weldDistance) {
+	Polytope result;
+	auto oldToNew = weldedVertexIndices(p.vertices, weldDistance * weldDistance);
+	for (i32 oldI = 0; oldI < i32(p.vertices.size()); oldI++) {
+		// The kept vertices are numbered in the order of the first occurrence.
+		if (oldToNew[oldI] == i32(result.vertices.size())) {
+			result.vertices.push_back(std::move(p.vertices[oldI]));
 		}
 	}
 
@@ -457,6 +535,14 @@ Polytope removedDuplicates(Polytope&& p) {
 }
 
 Polytope subdiviedHypercube4(i32 divisionCount) {
+	/*
+	The edges of the hypercube projected onto the sphere have an angle of pi / 3 and each of them is split into divisionCount + 1 segments. With more than 9 divisions the segments are shorter than the default weld distance and neighbouring vertices got merged. The slerps don't split the edges evenly so the distance is a fraction of the average segment length. It's still much larger than the difference between the duplicated vertices.
+	*/
+	const auto segmentAngle = (PI<f32> / 3.0f) / f32(divisionCount + 1);
+	return removedDuplicates(subdiviedHypercube4WithDuplicates(divisionCount), std::min(0.1f, segmentAngle / 4.0f));
+}
+
+Polytope subdiviedHypercube4WithDuplicates(i32 divisionCount) {
 	const auto h = hypercube(4);
 	/*
 	(4 choose 3) places for the changing 1 and -1
@@ -492,7 +578,7 @@ Polytope subdiviedHypercube4(i32 divisionCount) {
 			//goto zend;
 		}
 	}
-	return removedDuplicates(std::move(result));
+	return result;
 }
 
 Polytope::CellN faceEdgesSorted(const Polytope& p, i32 faceIndex) {
@@ -624,47 +710,6 @@ void add24CellVertices(VertexSet& vertices) {
 	addPermuations(vertices, 0.0f, 0.0f, 2.0f, 2.0f, 0, 0, 1, 1);
 }
 
-Polytope makePolytope4(
-	View<const Vec4> vertices,
-	View<const i32> edgesVertices,
-	View<const i32> facesEdges,
-	View<const i32> edgesPerFace,
-	View<const i32> cellsFaces,
-	View<const i32> facesPerCell) {
-	Polytope r;
-	r.cells.resize(3);
-	for (const auto& v : vertices) {
-		r.vertices.push_back({ v.x, v.y, v.z, v.w });
-	}
-
-	auto& edges = r.cellsOfDimension(1);
-	for (i32 i = 0; i < edgesVertices.size(); i += 2) {
-		edges.push_back({ edgesVertices[i], edgesVertices[i + 1] });
-	}
-
-	auto add = [&](i32 dimension, View<const i32> cellSubCells, View<const i32> subCellsPerCell) {
-		auto& cells = r.cellsOfDimension(dimension);
-		i32 i = 0;
-		for (const auto& subCellCountInCell : subCellsPerCell) {
-			Polytope::CellN cell;
-
-			i32 subCellsInserted = 0;
-			while (subCellsInserted < subCellCountInCell) {
-				cell.push_back(cellSubCells[i]);
-				i++;
-				subCellsInserted++;
-			}
-
-			cells.push_back(std::move(cell));
-		}
-		};
-	add(2, facesEdges, edgesPerFace);
-	add(3, cellsFaces, facesPerCell);
-	return r;
-}
-
-#define MAKE_POLYTOPE4(name) makePolytope4(constView(name##vertices), constView(name##EdgesVertices), constView(name##FacesEdges), constView(name##EdgesPerFace), constView(name##CellsFaces), constView(name##FacesPerCell))
-
 Polytope generate600cell() {
 	const auto p = (1.0f + sqrt(5.0f)) / 2.0f;
 	VertexSet v;
@@ -675,12 +720,6 @@ Polytope generate600cell() {
 	return convexHull(vertices);
 }
 
-#include "600cell.hpp"
-
-Polytope make600cell() {
-	return MAKE_POLYTOPE4(cell600);
-}
-
 Polytope generate120cell(){
 	//https://en.wikipedia.org/wiki/120-cell#%E2%88%9A8_radius_coordinates
 	VertexSet v;
@@ -700,13 +739,6 @@ Polytope generate120cell(){
 	return convexHull(vertices);
 }
 
-#include "120cell.hpp"
-
-Polytope make120cell() {
-	return MAKE_POLYTOPE4(cell120);
-	//return generate120cell();
-}
-
 Polytope make24cell() {
 	VertexSet v;
 	add24CellVertices(v);
@@ -813,11 +845,6 @@ Polytope generateRectified600cell() {
 	return convexHull(vertexSetToVertexList(v));
 }
 
-#include "Rectified600cell.hpp"
-Polytope makeRectified600cell() {
-	return MAKE_POLYTOPE4(rectified600cell);
-}
-
 Polytope generateSnub24cell() {
 	// https://www.qfbox.info/4d/snub24cell
 	VertexSet v;
@@ -827,18 +854,6 @@ Polytope generateSnub24cell() {
 	return convexHull(vertexSetToVertexList(v));
 }
 
-#include "Snub24cell.hpp"
-
-Polytope makeSnub24cell() {
-	return MAKE_POLYTOPE4(snub24cell);
-}
-
-#include "SubdiviedHypercube.hpp"
-
-Polytope makeSubdiviedHypercube2() {
-	return MAKE_POLYTOPE4(subdiviedHypercube);
-}
-
 std::vector<i32> verticesOfFaceWithSortedEdges(const Polytope& p, i32 faceIndex) {
 	return verticesOfFaceWithSortedEdges(p, p.cellsOfDimension(2)[faceIndex]);
 }
@@ -863,6 +878,111 @@ std::vector<i32> verticesOfFaceWithSortedEdges(const Polytope& p, const Polytope
 	return vertices;
 }
 
+i32 FlatPolytope4::edgeCount() const {
+	return i32(edgesVertices.size()) / 2;
+}
+
+i32 FlatPolytope4::faceCount() const {
+	return i32(facesEdgesOffsets.size()) - 1;
+}
+
+i32 FlatPolytope4::cellCount() const {
+	return i32(cellsFacesOffsets.size()) - 1;
+}
+
+View<const i32> FlatPolytope4::edgesOfFace(i32 face) const {
+	return View<const i32>(facesEdges.data() + facesEdgesOffsets[face], facesEdgesOffsets[face + 1] - facesEdgesOffsets[face]);
+}
+
+View<const i32> FlatPolytope4::facesOfCell(i32 cell) const {
+	return View<const i32>(cellsFaces.data() + cellsFacesOffsets[cell], cellsFacesOffsets[cell + 1] - cellsFacesOffsets[cell]);
+}
+
+FlatPolytope4 toFlatPolytope4(const Polytope& p) {
+	FlatPolytope4 r;
+	if (p.cells.size() < 3) {
+		return r;
+	}
+	r.vertices.reserve(p.vertices.size());
+	for (const auto& vertex : p.vertices) {
+		ASSERT(vertex.size() == 4);
+		r.vertices.push_back(Vec4(vertex[0], vertex[1], vertex[2], vertex[3]));
+	}
+	for (const auto& edge : p.cellsOfDimension(1)) {
+		r.edgesVertices.push_back(edge[0]);
+		r.edgesVertices.push_back(edge[1]);
+	}
+	auto add = [](std::vector<i32>& offsets, std::vector<i32>& subCells, const Polytope::CellsN& cells) {
+		for (const auto& cell : cells) {
+			subCells.insert(subCells.end(), cell.begin(), cell.end());
+			offsets.push_back(i32(subCells.size()));
+		}
+	};
+	add(r.facesEdgesOffsets, r.facesEdges, p.cellsOfDimension(2));
+	add(r.cellsFacesOffsets, r.cellsFaces, p.cellsOfDimension(3));
+	return r;
+}
+
+Polytope toPolytope(const FlatPolytope4& p) {
+	Polytope r;
+	r.cells.resize(3);
+	for (const auto& v : p.vertices) {
+		r.vertices.push_back({ v.x, v.y, v.z, v.w });
+	}
+
+	auto& edges = r.cellsOfDimension(1);
+	for (i32 i = 0; i < p.edgeCount(); i++) {
+		edges.push_back({ p.edgesVertices[2 * i], p.edgesVertices[2 * i + 1] });
+	}
+	auto& faces = r.cellsOfDimension(2);
+	for (i32 i = 0; i < p.faceCount(); i++) {
+		const auto faceEdges = p.edgesOfFace(i);
+		faces.push_back(Polytope::CellN(faceEdges.begin(), faceEdges.end()));
+	}
+	auto& cells = r.cellsOfDimension(3);
+	for (i32 i = 0; i < p.cellCount(); i++) {
+		const auto cellFaces = p.facesOfCell(i);
+		cells.push_back(Polytope::CellN(cellFaces.begin(), cellFaces.end()));
+	}
+	return r;
+}
+
+/*
+Walks around the face starting from the first edge. Each vertex of a polygon belongs to exactly 2 of its edges so the next edge is the one containing the last added vertex other than the current edge.
+*/
+void verticesOfFaceInOrder(const FlatPolytope4& p, i32 faceIndex, std::vector<i32>& result) {
+	result.clear();
+	const auto faceEdges = p.edgesOfFace(faceIndex);
+	const auto edgeCount = i32(faceEdges.size());
+	auto edgeVertex = [&](i32 edge, i32 i) {
+		return p.edgesVertices[2 * edge + i];
+	};
+
+	i32 currentEdge = faceEdges[0];
+	result.push_back(edgeVertex(currentEdge, 0));
+	result.push_back(edgeVertex(currentEdge, 1));
+	// The last edge connects back to the first vertex.
+	for (i32 i = 1; i < edgeCount - 1; i++) {
+		const auto vertex = result.back();
+		bool foundNextEdge = false;
+		for (const auto& edge : faceEdges) {
+			if (edge == currentEdge) {
+				continue;
+			}
+			if (edgeVertex(edge, 0) == vertex || edgeVertex(edge, 1) == vertex) {
+				result.push_back(edgeVertex(edge, 0) == vertex ? edgeVertex(edge, 1) : edgeVertex(edge, 0));
+				currentEdge = edge;
+				foundNextEdge = true;
+				break;
+			}
+		}
+		if (!foundNextEdge) {
+			CHECK_NOT_REACHED();
+			return;
+		}
+	}
+}
+
 Polytope::CellsN& Polytope::cellsOfDimension(i32 n) {
 	return cells[n - 1];
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <engine/Math/Vec4.hpp>
+#include <View.hpp>
 #include <vector>
 
 /*
@@ -34,6 +35,31 @@ struct Polytope {
 	const CellsN& cellsOfDimension(i32 n) const;
 };
 
+/*
+Compact representation of a 4 dimensional polytope. Polytope stores a separate vector for each vertex and each cell so creating one makes an allocation for each of them. Here each dimension is stored in compressed sparse row format, that is an array of the indices of the lower dimensional cells of all the cells one after another and an array of offsets into it. The sub cells of cell i are subCells[offsets[i]] to subCells[offsets[i + 1] - 1].
+*/
+struct FlatPolytope4 {
+	std::vector<Vec4> vertices;
+	// 2 vertex indices for each edge.
+	std::vector<i32> edgesVertices;
+	std::vector<i32> facesEdgesOffsets{ 0 };
+	std::vector<i32> facesEdges;
+	std::vector<i32> cellsFacesOffsets{ 0 };
+	std::vector<i32> cellsFaces;
+
+	i32 edgeCount() const;
+	i32 faceCount() const;
+	i32 cellCount() const;
+	View<const i32> edgesOfFace(i32 face) const;
+	View<const i32> facesOfCell(i32 cell) const;
+};
+
+// Adapters between the representations. The polytope has to be 4 dimensional.
+FlatPolytope4 toFlatPolytope4(const Polytope& p);
+Polytope toPolytope(const FlatPolytope4& p);
+// The vertices of the face in cyclic order. Produces the same order as verticesOfFaceWithSortedEdges(p, faceEdgesSorted(p, faceIndex)).
+void verticesOfFaceInOrder(const FlatPolytope4& p, i32 faceIndex, std::vector<i32>& result);
+
 Polytope crossPolytope(i32 dimension);
 i32 crossPolytopeSimplexCount(i32 dimensionOfCrossPolytope, i32 dimensionOfSimplex);
 
@@ -41,6 +67,13 @@ Polytope hypercube(i32 dimension);
 i32 hypercubeCellCount(i32 dimensionOfHypercube, i32 dimensionOfCells);
 
 Polytope subdiviedHypercube4(i32 divisionCount);
+// The cubes of the subdivision are generated separately so the vertices and cells on their boundaries are duplicated.
+Polytope subdiviedHypercube4WithDuplicates(i32 divisionCount);
+
+// Merges each vertex into the first vertex before it that has squared distance less than maxSquaredDistance and isn't merged itself. Returns the index of the merged vertex for each vertex. The merged vertices are numbered in the order of their first occurrence. Works in any dimension and takes expected linear time.
+std::vector<i32> weldedVertexIndices(const std::vector<Polytope::PointN>& vertices, f32 maxSquaredDistance);
+// Welds the vertices closer than weldDistance and then removes the cells that became equal.
+Polytope removedDuplicates(Polytope&& p, f32 weldDistance = 0.1f);
 
 std::vector<i32> verticesOfFaceWithSortedEdges(const Polytope& p, i32 faceIndex);
 std::vector<i32> verticesOfFaceWithSortedEdges(const Polytope& p, const Polytope::CellN& face);
@@ -49,6 +82,13 @@ std::vector<i32> verticesOfFaceWithSortedEdges(const Polytope& p, const Polytope
 Polytope::CellN faceEdgesSorted(const Polytope& p, i32 faceIndex);
 
 
+// The make functions load the precomputed data. The flat versions don't go through the Polytope representation. They are defined in PolytopeData.cpp, which is only compiled into the tools.
+FlatPolytope4 makeFlat600cell();
+FlatPolytope4 makeFlat120cell();
+FlatPolytope4 makeFlatRectified600cell();
+FlatPolytope4 makeFlatSnub24cell();
+FlatPolytope4 makeFlatSubdiviedHypercube2();
+
 // regular
 Polytope generate600cell();
 Polytope make600cell();
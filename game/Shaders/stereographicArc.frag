@@ -0,0 +1,23 @@
+#version 430 core
+
+in vec3 interpolatedNormal; 
+in vec3 worldPos; 
+
+in vec3 color; 
+out vec4 fragColor;
+
+/*generated end*/
+
+// The same shading as colored.frag so that the instanced arcs look the same as the ones generated on the CPU.
+void main() {
+	vec3 normal = normalize(interpolatedNormal);
+	float diffuse = dot(-vec3(0, 1, 0), normal);
+	diffuse = max(0.0, diffuse);
+	diffuse += 0.5;
+	diffuse = clamp(diffuse, 0.0, 1.0);
+	float d = length(worldPos);
+	float fadeDistanceStart = 10.0;
+	float fadeDistanceEnd = 30.0;
+	d = smoothstep(fadeDistanceEnd, fadeDistanceStart, d);
+	fragColor = vec4(color * diffuse * d, 1.0);
+}
@@ -0,0 +1,71 @@
+#version 430 core
+
+layout(location = 0) in vec2 vertexCrossSection; 
+layout(location = 1) in float vertexT; 
+layout(location = 2) in vec4 instanceE0; 
+layout(location = 3) in vec4 instanceE1; 
+layout(location = 4) in float instanceWidth; 
+layout(location = 5) in vec3 instanceColor; 
+
+uniform mat4 transform; 
+uniform mat4 view4; 
+
+out vec3 interpolatedNormal; 
+out vec3 worldPos; 
+
+out vec3 color; 
+
+void passToFragment() {
+    color = instanceColor; 
+}
+
+/*generated end*/
+
+// Has to be kept the same as stereographicArcVertex in StereographicArc.cpp.
+
+vec3 stereographicProjection(vec4 p) {
+	return p.xyz / (1.0 - p.w);
+}
+
+vec3 perpendicularTo(vec3 v) {
+	vec3 axis = abs(v.x) < 0.9 ? vec3(1.0, 0.0, 0.0) : vec3(0.0, 1.0, 0.0);
+	return normalize(cross(v, axis));
+}
+
+void main() {
+	passToFragment();
+	vec4 e0 = view4 * instanceE0;
+	vec4 e1 = view4 * instanceE1;
+	vec3 p0 = stereographicProjection(e0);
+	vec3 p1 = stereographicProjection(e1);
+
+	vec3 chord = p1 - p0;
+	float chordLengthSquared = dot(chord, chord);
+	vec3 tangent = normalize(chord + (chordLengthSquared / (1.0 + dot(p0, p0))) * p0);
+	float along = dot(chord, tangent);
+	vec3 perpendicular = chord - along * tangent;
+	float perpendicularLength = sqrt(dot(perpendicular, perpendicular));
+	float angle = 2.0 * atan(perpendicularLength, along);
+
+	vec3 curvePosition;
+	vec3 curveNormal;
+	vec3 curveBinormal;
+	if (angle < 0.01) {
+		vec3 direction = normalize(chord);
+		curvePosition = mix(p0, p1, vertexT);
+		curveNormal = perpendicularTo(direction);
+		curveBinormal = cross(direction, curveNormal);
+	} else {
+		vec3 normal = perpendicular / perpendicularLength;
+		float radius = 0.5 * chordLengthSquared / perpendicularLength;
+		vec3 center = p0 + radius * normal;
+		float curveAngle = vertexT * angle;
+		curveNormal = cos(curveAngle) * -normal + sin(curveAngle) * tangent;
+		curvePosition = center + radius * curveNormal;
+		curveBinormal = cross(-normal, tangent);
+	}
+	vec3 surfaceNormal = instanceWidth * (vertexCrossSection.x * curveNormal + vertexCrossSection.y * curveBinormal);
+	interpolatedNormal = surfaceNormal;
+	worldPos = curvePosition + surfaceNormal;
+	gl_Position = transform * vec4(worldPos, 1.0);
+}
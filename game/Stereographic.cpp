@@ -308,6 +308,57 @@ StereographicSegment StereographicSegment::fromEndpoints(Vec4 e0, Vec4 e1) {
 	}
 }
 
+/*
+The projection is conformal and maps great circles to circles or lines, so the projected arc is the arc of the circle going though p0 and p1 that is tangent at p0 to the projection of the tangent of the great circle at e0. The center is then on the line though p0 perpendicular to the tangent, equally far from p0 and p1, and the angle of the arc is twice the angle between the tangent and the chord from p0 to p1.
+
+fromEndpoints instead fits a circle though p0, p1 and the projection of the antipode of e0, which needs another 2 projections, a change of basis and a few more trigonometric functions to choose the direction of the arc. Computing the center from the 4D great circle directly would be cheaper still, but near the pole the projected points are sensitive to the last bits of w, and a circle that doesn't go exactly though the projected endpoints leaves visible gaps at the vertices.
+*/
+StereographicSegment StereographicSegment::fromProjectedEndpoints(Vec4 e0, Vec4 e1, Vec3 p0, Vec3 p1) {
+	const auto p0AtInfinity = isPointAtInfinity(p0);
+	const auto p1AtInfinity = isPointAtInfinity(p1);
+	if (p0AtInfinity && p1AtInfinity) {
+		// Can't tell if they are connected by a line going though infinity or going though the origin. It's probably though infinity, but then there is nothing to draw.
+		return StereographicSegment::fromLine(p0, p1);
+	}
+
+	if (p0AtInfinity || p1AtInfinity) {
+		auto finite = p1;
+		auto atInfinity4 = e0;
+		auto finite4 = e1;
+		if (p1AtInfinity) {
+			finite = p0;
+			std::swap(atInfinity4, finite4);
+		}
+		// The line goes though the finite point in the direction of the projected velocity out of the finite point towards the point at infinity.
+		const auto velocity4 = (atInfinity4 - dot(atInfinity4, finite4) * finite4).normalized();
+		const auto direction = stereographicProjectionJacobian(finite4, velocity4).normalized();
+		return StereographicSegment::fromLine(finite, finite + direction * 1000.0f);
+	}
+
+	const auto chord = p1 - p0;
+	const auto chordLengthSquared = dot(chord, chord);
+	/*
+	The tangent at p0 pointing towards p1. The projected circle also goes though the projection of the antipode of e0, which is a = -p0 / |p0|^2. Inverting around p0 maps the circle to a line though the images of p1 and a and the tangent is parallel to that line, so it's chord / |chord|^2 - (a - p0) / |a - p0|^2 = chord / |chord|^2 + p0 / (1 + |p0|^2).
+	Using only the projected points keeps the precision of fitting the circle though the 3 points. The tangent of the great circle at e0 projected using the jacobian loses precision when p0 is far from the origin.
+	*/
+	const auto tangent = (chord + (chordLengthSquared / (1.0f + dot(p0, p0))) * p0).normalized();
+	const auto along = dot(chord, tangent);
+	const auto perpendicular = chord - along * tangent;
+	const auto perpendicularLengthSquared = dot(perpendicular, perpendicular);
+	if (!(perpendicularLengthSquared > 0.000000000001f * chordLengthSquared)) {
+		// The chord is along the tangent so the arc is straight. Also happens when the points are equal.
+		return StereographicSegment::fromLine(p0, p1);
+	}
+	const auto perpendicularLength = sqrt(perpendicularLengthSquared);
+	const auto inversePerpendicularLength = 1.0f / perpendicularLength;
+	const auto normal = perpendicular * inversePerpendicularLength;
+	// |p0 + radius * normal - p1| = radius gives radius = |chord|^2 / (2 dot(chord, normal)).
+	const auto radius = 0.5f * chordLengthSquared * inversePerpendicularLength;
+	const auto center = p0 + radius * normal;
+	const auto angle = 2.0f * atan2(perpendicularLength, along);
+	return StereographicSegment::fromCircular(-radius * normal, radius * tangent, center, angle);
+}
+
 StereographicPlane StereographicPlane::fromVertices(Vec4 v0, Vec4 v1, Vec4 v2) {
 	const auto p4 = -v0;
 	const auto sp0 = stereographicProjection(v0);
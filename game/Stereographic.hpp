@@ -41,6 +41,11 @@ public:
 	static StereographicSegment fromLine(Vec3 e0, Vec3 e1);
 
 	static StereographicSegment fromEndpoints(Vec4 e0, Vec4 e1);
+	/*
+	The projection of the shorter great circle arc from e0 to e1, where p0 and p1 are the already computed projections of the endpoints, for example by the batch stereographic projection.
+	If both endpoints are at infinity there is nothing to draw and the line between them is returned like in fromEndpoints. If one of them is at infinity the line goes from the finite endpoint 1000 units in the direction from which the arc approaches infinity. The circular segments start at p0 and have the velocity of the same length as the start vector, like LineGenerator::addCircularArc expects. Their angle is in [0, 2 pi].
+	*/
+	static StereographicSegment fromProjectedEndpoints(Vec4 e0, Vec4 e1, Vec3 p0, Vec3 p1);
 
 	enum class Type {
 		LINE, CIRCULAR
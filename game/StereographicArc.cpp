@@ -0,0 +1,76 @@
+#include "StereographicArc.hpp"
+#include <game/Stereographic.hpp>
+#include <engine/Math/Interpolation.hpp>
+
+// Not the same as anyPerpendicularVector, because this one has to be easy to write in GLSL.
+static Vec3 perpendicularTo(Vec3 v) {
+	const auto axis = abs(v.x) < 0.9f ? Vec3(1.0f, 0.0f, 0.0f) : Vec3(0.0f, 1.0f, 0.0f);
+	return cross(v, axis).normalized();
+}
+
+StereographicArcVertex stereographicArcVertex(const Mat4& view4, Vec4 e0, Vec4 e1, f32 width, f32 t, Vec2 crossSection) {
+	e0 = view4 * e0;
+	e1 = view4 * e1;
+	const auto p0 = stereographicProjection(e0);
+	const auto p1 = stereographicProjection(e1);
+
+	// The same as StereographicSegment::fromProjectedEndpoints without the cases with points at infinity, because they aren't instanced.
+	const auto chord = p1 - p0;
+	const auto chordLengthSquared = dot(chord, chord);
+	const auto tangent = (chord + (chordLengthSquared / (1.0f + dot(p0, p0))) * p0).normalized();
+	const auto along = dot(chord, tangent);
+	const auto perpendicular = chord - along * tangent;
+	const auto perpendicularLength = sqrt(dot(perpendicular, perpendicular));
+	const auto angle = 2.0f * atan2(perpendicularLength, along);
+
+	Vec3 curvePosition;
+	Vec3 curveNormal;
+	Vec3 curveBinormal;
+	if (angle < 0.01f) {
+		// Minesweeper draws these as lines. This also avoids dividing by a perpendicular length of zero.
+		const auto direction = chord.normalized();
+		curvePosition = lerp(p0, p1, t);
+		curveNormal = perpendicularTo(direction);
+		curveBinormal = cross(direction, curveNormal);
+	} else {
+		const auto normal = perpendicular / perpendicularLength;
+		const auto radius = 0.5f * chordLengthSquared / perpendicularLength;
+		const auto center = p0 + radius * normal;
+		// The same as LineGenerator::addCircularArc with start = -radius * normal and initialVelocity = radius * tangent.
+		const auto curveAngle = t * angle;
+		curveNormal = cos(curveAngle) * -normal + sin(curveAngle) * tangent;
+		curvePosition = center + radius * curveNormal;
+		curveBinormal = cross(-normal, tangent);
+	}
+	const auto surfaceNormal = width * (crossSection.x * curveNormal + crossSection.y * curveBinormal);
+	return StereographicArcVertex{
+		.position = curvePosition + surfaceNormal,
+		.normal = surfaceNormal
+	};
+}
+
+bool isStereographicArcInstanceable(Vec4 e0, Vec4 e1, Vec4 pointAtInfinity) {
+	// After transforming by view4 the w coordinate of a point is its dot product with the point at infinity. A point with w = 0.995 is projected to distance sqrt((1 + w) / (1 - w)) = 20, where the fog is already halfway.
+	const auto maxW = 0.995f;
+	const auto w0 = dot(e0, pointAtInfinity);
+	const auto w1 = dot(e1, pointAtInfinity);
+	if (w0 > maxW || w1 > maxW) {
+		return false;
+	}
+
+	// The arc is cos(a) e0 + sin(a) u for a in [0, angle], where u is the unit tangent at e0 and (cos(angle), sin(angle)) = (c, s).
+	const auto c = dot(e0, e1);
+	auto u = e1 - c * e0;
+	const auto s = u.length();
+	if (s == 0.0f) {
+		return true;
+	}
+	u /= s;
+	// Along the arc w = w0 cos(a) + wu sin(a). Its maximum over the whole circle is length((w0, wu)) at the angle of (w0, wu). If the angle isn't inside [0, angle] then the maximum over the arc is at one of the endpoints, which were already checked.
+	const auto wu = dot(u, pointAtInfinity);
+	const auto maximumInsideArc = wu > 0.0f && c * wu - s * w0 <= 0.0f;
+	if (maximumInsideArc && w0 * w0 + wu * wu > maxW * maxW) {
+		return false;
+	}
+	return true;
+}
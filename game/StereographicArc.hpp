@@ -0,0 +1,28 @@
+#pragma once
+
+#include <engine/Math/Mat4.hpp>
+#include <engine/Math/Vec2.hpp>
+
+/*
+The curved edges can be drawn by instancing a single tube mesh. The instance stores the endpoints of the edge on the sphere and the width of the tube and the vertex shader (Shaders/stereographicArc.vert) transforms them by view4, computes the projected arc the same way as StereographicSegment::fromProjectedEndpoints and places the vertex on it the same way as LineGenerator::addCircularArc. This way the instance data doesn't depend on the camera.
+
+stereographicArcVertex is a copy of the vertex shader so that it can be checked without a graphics context (see edgeArcsInstancingBenchmark). Changes to one have to be made in the other too.
+*/
+
+// The tube mesh has ring count circles of cross section point count vertices each. The ring i is at i / (ring count - 1) of the arc angle.
+constexpr i32 STEREOGRAPHIC_ARC_RING_COUNT = 8;
+constexpr i32 STEREOGRAPHIC_ARC_CROSS_SECTION_POINT_COUNT = 10;
+
+struct StereographicArcVertex {
+	Vec3 position;
+	// Not normalized.
+	Vec3 normal;
+};
+
+// t is in [0, 1] and crossSection is the point on the unit circle around the tube.
+StereographicArcVertex stereographicArcVertex(const Mat4& view4, Vec4 e0, Vec4 e1, f32 width, f32 t, Vec2 crossSection);
+
+/*
+The shader can't represent lines going to infinity and the arcs passing close to the point projected to infinity would get too long and lose precision, so these have to be drawn on the CPU. pointAtInfinity is the point projected to infinity, that is StereographicCamera::pos4().
+*/
+bool isStereographicArcInstanceable(Vec4 e0, Vec4 e1, Vec4 pointAtInfinity);
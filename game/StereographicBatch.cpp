@@ -0,0 +1,271 @@
+#include "StereographicBatch.hpp"
+#include <game/Stereographic.hpp>
+#include <Assertions.hpp>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STEREOGRAPHIC_BATCH_SSE
+#include <emmintrin.h>
+#endif
+
+#if defined(STEREOGRAPHIC_BATCH_SSE) && defined(__AVX__)
+#define STEREOGRAPHIC_BATCH_AVX
+#include <immintrin.h>
+#endif
+
+// The kernels write the points as arrays of floats.
+static_assert(sizeof(Vec3) == 3 * sizeof(f32));
+static_assert(sizeof(Vec4) == 4 * sizeof(f32));
+
+i64 stereographicInfinityMaskWordCount(i64 pointCount) {
+	return (pointCount + 63) / 64;
+}
+
+bool isPointAtInfinity(View<const u64> atInfinity, i64 i) {
+	return (atInfinity[i / 64] >> (i % 64)) & 1;
+}
+
+#ifdef STEREOGRAPHIC_BATCH_SSE
+// Element [column][row] of the matrix in every lane.
+struct BroadcastMat4x4 {
+	BroadcastMat4x4(const Mat4& m) {
+		for (i32 column = 0; column < 4; column++) {
+			for (i32 row = 0; row < 4; row++) {
+				e[column][row] = _mm_set1_ps(m.basis[column].data()[row]);
+			}
+		}
+	}
+	__m128 e[4][4];
+};
+
+static void transform4(const BroadcastMat4x4& m, __m128 x, __m128 y, __m128 z, __m128 w, __m128 (&result)[4]) {
+	for (i32 row = 0; row < 4; row++) {
+		result[row] = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+			_mm_mul_ps(m.e[0][row], x),
+			_mm_mul_ps(m.e[1][row], y)),
+			_mm_mul_ps(m.e[2][row], z)),
+			_mm_mul_ps(m.e[3][row], w));
+	}
+}
+
+// Returns the mask of the points at infinity and replaces their coordinates with infinity.
+static __m128 project4(__m128& x, __m128& y, __m128& z, __m128 w) {
+	const auto one = _mm_set1_ps(1.0f);
+	const auto infinity = _mm_set1_ps(INFINITY);
+	const auto signBit = _mm_set1_ps(-0.0f);
+	const auto a = _mm_div_ps(one, _mm_sub_ps(one, w));
+	// Not less than infinity is true for infinity and NaN.
+	const auto atInfinity = _mm_cmpnlt_ps(_mm_andnot_ps(signBit, a), infinity);
+	auto project = [&](__m128 v) {
+		return _mm_or_ps(_mm_andnot_ps(atInfinity, _mm_mul_ps(v, a)), _mm_and_ps(atInfinity, infinity));
+	};
+	x = project(x);
+	y = project(y);
+	z = project(z);
+	return atInfinity;
+}
+#endif
+
+#ifdef STEREOGRAPHIC_BATCH_AVX
+struct BroadcastMat8x4 {
+	BroadcastMat8x4(const Mat4& m) {
+		for (i32 column = 0; column < 4; column++) {
+			for (i32 row = 0; row < 4; row++) {
+				e[column][row] = _mm256_set1_ps(m.basis[column].data()[row]);
+			}
+		}
+	}
+	__m256 e[4][4];
+};
+
+// _MM_TRANSPOSE4_PS applied to both 128 bit lanes.
+static void transposeLanes(__m256& a, __m256& b, __m256& c, __m256& d) {
+	const auto t0 = _mm256_unpacklo_ps(a, b);
+	const auto t1 = _mm256_unpacklo_ps(c, d);
+	const auto t2 = _mm256_unpackhi_ps(a, b);
+	const auto t3 = _mm256_unpackhi_ps(c, d);
+	a = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0));
+	b = _mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2));
+	c = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	d = _mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+static __m256 loadLanes(const f32* low, const f32* high) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(low)), _mm_loadu_ps(high), 1);
+}
+#endif
+
+template<bool storeTransformed>
+static void transformAndProject(const Mat4& transform, View<const Vec4> points, Vec4* transformed, View<Vec3> projected, View<u64> atInfinity) {
+	const auto count = i64(points.size());
+	CHECK(i64(projected.size()) >= count);
+	CHECK(i64(atInfinity.size()) >= stereographicInfinityMaskWordCount(count));
+	for (i64 i = 0; i < stereographicInfinityMaskWordCount(count); i++) {
+		atInfinity[i] = 0;
+	}
+
+	i64 i = 0;
+	#ifdef STEREOGRAPHIC_BATCH_SSE
+	auto in = reinterpret_cast<const f32*>(points.data());
+	auto out = reinterpret_cast<f32*>(projected.data());
+	auto outTransformed = reinterpret_cast<f32*>(transformed);
+	#endif
+
+	#ifdef STEREOGRAPHIC_BATCH_AVX
+	{
+		const BroadcastMat8x4 m(transform);
+		for (; i + 8 <= count; i += 8) {
+			// The low lanes have the points i to i + 3 and the high lanes i + 4 to i + 7, so after transposing the lanes of x are the points in order.
+			auto x = loadLanes(in + 4 * i, in + 4 * (i + 4));
+			auto y = loadLanes(in + 4 * (i + 1), in + 4 * (i + 5));
+			auto z = loadLanes(in + 4 * (i + 2), in + 4 * (i + 6));
+			auto w = loadLanes(in + 4 * (i + 3), in + 4 * (i + 7));
+			transposeLanes(x, y, z, w);
+
+			__m256 r[4];
+			for (i32 row = 0; row < 4; row++) {
+				r[row] = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+					_mm256_mul_ps(m.e[0][row], x),
+					_mm256_mul_ps(m.e[1][row], y)),
+					_mm256_mul_ps(m.e[2][row], z)),
+					_mm256_mul_ps(m.e[3][row], w));
+			}
+			if constexpr (storeTransformed) {
+				auto t0 = r[0], t1 = r[1], t2 = r[2], t3 = r[3];
+				transposeLanes(t0, t1, t2, t3);
+				const __m256 rows[]{ t0, t1, t2, t3 };
+				for (i32 j = 0; j < 4; j++) {
+					_mm_storeu_ps(outTransformed + 4 * (i + j), _mm256_castps256_ps128(rows[j]));
+					_mm_storeu_ps(outTransformed + 4 * (i + 4 + j), _mm256_extractf128_ps(rows[j], 1));
+				}
+			}
+
+			const auto one = _mm256_set1_ps(1.0f);
+			const auto infinity = _mm256_set1_ps(INFINITY);
+			const auto a = _mm256_div_ps(one, _mm256_sub_ps(one, r[3]));
+			const auto isAtInfinity = _mm256_cmp_ps(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), a), infinity, _CMP_NLT_UQ);
+			auto project = [&](__m256 v) {
+				return _mm256_or_ps(_mm256_andnot_ps(isAtInfinity, _mm256_mul_ps(v, a)), _mm256_and_ps(isAtInfinity, infinity));
+			};
+			auto px = project(r[0]);
+			auto py = project(r[1]);
+			auto pz = project(r[2]);
+			auto unused = _mm256_setzero_ps();
+			transposeLanes(px, py, pz, unused);
+			// Each 16 byte store also writes the x of the next point, which is overwritten by the next store. The last point is copied separately so nothing is written past the end.
+			const __m256 rows[]{ px, py, pz, unused };
+			for (i32 j = 0; j < 4; j++) {
+				_mm_storeu_ps(out + 3 * (i + j), _mm256_castps256_ps128(rows[j]));
+			}
+			for (i32 j = 0; j < 3; j++) {
+				_mm_storeu_ps(out + 3 * (i + 4 + j), _mm256_extractf128_ps(rows[j], 1));
+			}
+			alignas(16) f32 last[4];
+			_mm_store_ps(last, _mm256_extractf128_ps(rows[3], 1));
+			for (i32 j = 0; j < 3; j++) {
+				out[3 * (i + 7) + j] = last[j];
+			}
+			atInfinity[i / 64] |= u64(_mm256_movemask_ps(isAtInfinity)) << (i % 64);
+		}
+	}
+	#endif
+
+	#ifdef STEREOGRAPHIC_BATCH_SSE
+	{
+		const BroadcastMat4x4 m(transform);
+		for (; i + 4 <= count; i += 4) {
+			auto x = _mm_loadu_ps(in + 4 * i);
+			auto y = _mm_loadu_ps(in + 4 * (i + 1));
+			auto z = _mm_loadu_ps(in + 4 * (i + 2));
+			auto w = _mm_loadu_ps(in + 4 * (i + 3));
+			_MM_TRANSPOSE4_PS(x, y, z, w);
+
+			__m128 r[4];
+			transform4(m, x, y, z, w, r);
+			if constexpr (storeTransformed) {
+				auto t0 = r[0], t1 = r[1], t2 = r[2], t3 = r[3];
+				_MM_TRANSPOSE4_PS(t0, t1, t2, t3);
+				_mm_storeu_ps(outTransformed + 4 * i, t0);
+				_mm_storeu_ps(outTransformed + 4 * (i + 1), t1);
+				_mm_storeu_ps(outTransformed + 4 * (i + 2), t2);
+				_mm_storeu_ps(outTransformed + 4 * (i + 3), t3);
+			}
+
+			const auto isAtInfinity = project4(r[0], r[1], r[2], r[3]);
+			auto unused = _mm_setzero_ps();
+			_MM_TRANSPOSE4_PS(r[0], r[1], r[2], unused);
+			// Same as in the AVX loop.
+			_mm_storeu_ps(out + 3 * i, r[0]);
+			_mm_storeu_ps(out + 3 * (i + 1), r[1]);
+			_mm_storeu_ps(out + 3 * (i + 2), r[2]);
+			alignas(16) f32 last[4];
+			_mm_store_ps(last, unused);
+			for (i32 j = 0; j < 3; j++) {
+				out[3 * (i + 3) + j] = last[j];
+			}
+			atInfinity[i / 64] |= u64(_mm_movemask_ps(isAtInfinity)) << (i % 64);
+		}
+	}
+	#endif
+
+	for (; i < count; i++) {
+		const auto p = transform * points[i];
+		if constexpr (storeTransformed) {
+			transformed[i] = p;
+		}
+		projected[i] = stereographicProjection(p);
+		if (isPointAtInfinity(projected[i])) {
+			atInfinity[i / 64] |= u64(1) << (i % 64);
+		}
+	}
+}
+
+void stereographicProjection(const Mat4& transform, View<const Vec4> points, View<Vec3> projected, View<u64> atInfinity) {
+	transformAndProject<false>(transform, points, nullptr, projected, atInfinity);
+}
+
+void stereographicProjection(const Mat4& transform, View<const Vec4> points, View<Vec4> transformed, View<Vec3> projected, View<u64> atInfinity) {
+	CHECK(i64(transformed.size()) >= i64(points.size()));
+	transformAndProject<true>(transform, points, transformed.data(), projected, atInfinity);
+}
+
+void inverseStereographicProjection(View<const Vec3> points, View<Vec4> result) {
+	const auto count = i64(points.size());
+	CHECK(i64(result.size()) >= count);
+
+	i64 i = 0;
+	#ifdef STEREOGRAPHIC_BATCH_SSE
+	auto out = reinterpret_cast<f32*>(result.data());
+	const auto one = _mm_set1_ps(1.0f);
+	const auto two = _mm_set1_ps(2.0f);
+	const auto infinity = _mm_set1_ps(INFINITY);
+	const auto signBit = _mm_set1_ps(-0.0f);
+	for (; i + 4 <= count; i += 4) {
+		// Loading 16 bytes at once would read past the end of the last point.
+		const auto* p = &points[i];
+		const auto x = _mm_set_ps(p[3].x, p[2].x, p[1].x, p[0].x);
+		const auto y = _mm_set_ps(p[3].y, p[2].y, p[1].y, p[0].y);
+		const auto z = _mm_set_ps(p[3].z, p[2].z, p[1].z, p[0].z);
+
+		const auto s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		const auto sPlusOne = _mm_add_ps(s, one);
+		const auto a = _mm_div_ps(two, sPlusOne);
+		// Same as isPointAtInfinity, which only checks x. These points are mapped to (0, 0, 0, 1).
+		const auto isAtInfinity = _mm_cmpeq_ps(_mm_andnot_ps(signBit, x), infinity);
+		auto rx = _mm_andnot_ps(isAtInfinity, _mm_mul_ps(x, a));
+		auto ry = _mm_andnot_ps(isAtInfinity, _mm_mul_ps(y, a));
+		auto rz = _mm_andnot_ps(isAtInfinity, _mm_mul_ps(z, a));
+		auto rw = _mm_or_ps(_mm_andnot_ps(isAtInfinity, _mm_div_ps(_mm_sub_ps(s, one), sPlusOne)), _mm_and_ps(isAtInfinity, one));
+
+		_MM_TRANSPOSE4_PS(rx, ry, rz, rw);
+		_mm_storeu_ps(out + 4 * i, rx);
+		_mm_storeu_ps(out + 4 * (i + 1), ry);
+		_mm_storeu_ps(out + 4 * (i + 2), rz);
+		_mm_storeu_ps(out + 4 * (i + 3), rw);
+	}
+	#endif
+
+	for (; i < count; i++) {
+		result[i] = inverseStereographicProjection(points[i]);
+	}
+}
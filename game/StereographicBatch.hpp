@@ -0,0 +1,26 @@
+#pragma once
+
+#include <engine/Math/Mat4.hpp>
+#include <View.hpp>
+
+/*
+Array versions of the functions from Stereographic.hpp used in the per cell and per edge loops.
+
+The points are read and written in the same layout as Vec4 and Vec3 so the callers don't need separate buffers, but the kernels transpose each group of points into one register per component and process 4 points at once with SSE or 8 at once with AVX. AVX is only used when the compiler targets it (for example with /arch:AVX or -mavx). Without SSE (for example on the web build) the kernels fall back to calling the scalar functions. The results match the scalar functions up to the order in which the matrix multiplication adds the terms, so the projected points can differ in the last few bits. The points at infinity and the infinity mask match exactly.
+*/
+
+// The number of u64 words in the infinity mask for pointCount points.
+i64 stereographicInfinityMaskWordCount(i64 pointCount);
+
+/*
+projected[i] = stereographicProjection(transform * points[i])
+Bit i % 64 of atInfinity[i / 64] is set if isPointAtInfinity(projected[i]). The mask has to have stereographicInfinityMaskWordCount(points.size()) words.
+*/
+void stereographicProjection(const Mat4& transform, View<const Vec4> points, View<Vec3> projected, View<u64> atInfinity);
+// Same as above, but also stores transform * points[i] into transformed.
+void stereographicProjection(const Mat4& transform, View<const Vec4> points, View<Vec4> transformed, View<Vec3> projected, View<u64> atInfinity);
+// result[i] = inverseStereographicProjection(points[i])
+void inverseStereographicProjection(View<const Vec3> points, View<Vec4> result);
+
+// Reads the mask written by stereographicProjection.
+bool isPointAtInfinity(View<const u64> atInfinity, i64 i);
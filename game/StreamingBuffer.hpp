@@ -0,0 +1,52 @@
+#pragma once
+
+#include <Types.hpp>
+#include <bit>
+
+/*
+A buffer object whose whole contents are replaced every time it's used, like the instances and the generated triangles that GameRenderer draws each frame.
+
+Writing into a buffer with glBufferSubData while a draw call issued before still reads from it makes the driver either wait for the draw to finish or make a copy. Before each write the buffer is orphaned by calling glBufferData with nullptr. The driver gives the buffer new storage and frees the old one once the draws using it finish. The storage always has the same size, so the driver can reuse the storage it freed. It only grows when the data doesn't fit, and then to the next power of two, so calling allocateData with the exact size every frame no longer reallocates storage of a different size each time.
+
+A persistently mapped ring buffer with fences would also avoid the copy from the caller's memory, but it needs GL_ARB_buffer_storage (GL 4.4). Drawing the instances from an offset in the ring needs base instance (GL 4.2). Neither is available in WebGL 2, which the web build uses, and the instancing VAOs read the instances from offset 0.
+
+Buffer is Vbo or Ibo. Any type with the same allocateData and setData works, so the uploads can be counted without a graphics context.
+*/
+template<typename Buffer>
+struct StreamingBuffer {
+	Buffer buffer;
+	// The size of the storage allocated by the last allocateData call.
+	usize capacity = 0;
+
+	// Replaces the contents with byteSize bytes of data.
+	void write(const void* data, usize byteSize);
+
+	// The writes since the last resetCounters().
+	usize bytesUploaded = 0;
+	i32 writeCount = 0;
+	// The writes that didn't fit and had to grow the storage.
+	i32 growCount = 0;
+	void resetCounters();
+};
+
+template<typename Buffer>
+void StreamingBuffer<Buffer>::write(const void* data, usize byteSize) {
+	if (byteSize == 0) {
+		return;
+	}
+	if (byteSize > capacity) {
+		capacity = std::bit_ceil(byteSize);
+		growCount++;
+	}
+	buffer.allocateData(nullptr, capacity);
+	buffer.setData(0, data, byteSize);
+	bytesUploaded += byteSize;
+	writeCount++;
+}
+
+template<typename Buffer>
+void StreamingBuffer<Buffer>::resetCounters() {
+	bytesUploaded = 0;
+	writeCount = 0;
+	growCount = 0;
+}
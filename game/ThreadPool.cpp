@@ -0,0 +1,92 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(i32 threadCount) {
+	for (i32 i = 1; i < threadCount; i++) {
+		workers.emplace_back([this, i] { workerLoop(i); });
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard lock(mutex);
+		stopping = true;
+	}
+	workAvailable.notify_all();
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+i32 ThreadPool::threadCount() const {
+	return i32(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(i32 count, const Task& taskToRun) {
+	if (count <= 0) {
+		return;
+	}
+	if (workers.empty() || count == 1) {
+		for (i32 i = 0; i < count; i++) {
+			taskToRun(i, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard lock(mutex);
+		task = &taskToRun;
+		taskCount = count;
+		// Splitting into more chunks than threads so the threads that finish early can take work from the ones that got bigger tasks.
+		chunkSize = std::max(1, count / (threadCount() * 8));
+		nextIndex = 0;
+		busyWorkers = i32(workers.size());
+		generation++;
+	}
+	workAvailable.notify_all();
+
+	runTasks(0);
+
+	std::unique_lock lock(mutex);
+	workFinished.wait(lock, [this] { return busyWorkers == 0; });
+	task = nullptr;
+}
+
+void ThreadPool::workerLoop(i32 threadIndex) {
+	u64 finishedGeneration = 0;
+	for (;;) {
+		{
+			std::unique_lock lock(mutex);
+			workAvailable.wait(lock, [&] { return stopping || generation != finishedGeneration; });
+			if (stopping) {
+				return;
+			}
+			finishedGeneration = generation;
+		}
+
+		runTasks(threadIndex);
+
+		bool allFinished;
+		{
+			std::lock_guard lock(mutex);
+			busyWorkers--;
+			allFinished = busyWorkers == 0;
+		}
+		if (allFinished) {
+			workFinished.notify_one();
+		}
+	}
+}
+
+void ThreadPool::runTasks(i32 threadIndex) {
+	for (;;) {
+		const auto start = nextIndex.fetch_add(chunkSize);
+		if (start >= taskCount) {
+			return;
+		}
+		const auto end = std::min(start + chunkSize, taskCount);
+		for (i32 i = start; i < end; i++) {
+			(*task)(i, threadIndex);
+		}
+	}
+}
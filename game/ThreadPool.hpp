@@ -0,0 +1,47 @@
+#pragma once
+
+#include <Types.hpp>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/*
+Fixed number of worker threads that execute parallel for loops.
+
+The thread calling parallelFor also executes tasks so a pool with threadCount = 1 doesn't create any threads and just runs the loop inline. The web build is compiled without thread support, so World always uses a single thread there.
+
+The indices are distributed dynamically so which thread executes which index isn't deterministic. The callers have to make sure the tasks don't depend on each other if they want deterministic results.
+*/
+struct ThreadPool {
+	// The task receives the index of the iteration and the index of the thread in [0, threadCount). The calling thread has index 0.
+	using Task = std::function<void(i32 index, i32 threadIndex)>;
+
+	explicit ThreadPool(i32 threadCount);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	i32 threadCount() const;
+	// Calls task(i, threadIndex) for each i in [0, count) and waits until all of them finish.
+	void parallelFor(i32 count, const Task& task);
+
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable workAvailable;
+	std::condition_variable workFinished;
+	// Incremented each time new work is started so the workers know if they were woken up spuriously.
+	u64 generation = 0;
+	i32 busyWorkers = 0;
+	bool stopping = false;
+
+	const Task* task = nullptr;
+	i32 taskCount = 0;
+	i32 chunkSize = 1;
+	std::atomic<i32> nextIndex = 0;
+
+	void workerLoop(i32 threadIndex);
+	void runTasks(i32 threadIndex);
+};
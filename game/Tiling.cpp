@@ -1,43 +1,52 @@
 #include "Tiling.hpp"
-#include <engine/Math/GramSchmidt.hpp>
 #include <game/Math.hpp>
+#include <algorithm>
 
-// https://stackoverflow.com/questions/46770028/is-it-possible-to-use-stdset-intersection-to-check-if-two-sets-have-any-elem
-template <class I1, class I2>
-bool haveCommonElement(I1 first1, I1 last1, I2 first2, I2 last2) {
-	while (first1 != last1 && first2 != last2) {
-		if (*first1 < *first2)
-			++first1;
-		else if (*first2 < *first1)
-			++first2;
-		else
-			return true;
-	}
-	return false;
-}
+Tiling::Tiling() {}
 
-Tiling::Tiling(const Polytope& c) {
-	if (c.cells.size() == 0) {
+Tiling::Tiling(const Polytope& polytope)
+	: Tiling(toFlatPolytope4(polytope)) {}
+
+Tiling::Tiling(const FlatPolytope4& c) {
+	if (c.cellCount() == 0) {
 		return;
 	}
 
-	auto outwardPointingFaceNormal = [&](const std::vector<Vec4>& vertices, const std::vector<Face>& faces, const std::vector<i32>& cellFaces, i32 faceI) {
-		const auto& face = faces[faceI];
+	vertices.reserve(c.vertices.size());
+	for (const auto& vertex : c.vertices) {
+		vertices.push_back(vertex.normalized());
+	}
+	edges.reserve(c.edgeCount());
+	for (i32 i = 0; i < c.edgeCount(); i++) {
+		edges.push_back(Edge{ c.edgesVertices[2 * i], c.edgesVertices[2 * i + 1] });
+	}
+
+	faceVerticesOffsets.reserve(c.faceCount() + 1);
+	// Each face has as many vertices as edges.
+	faceVertices.reserve(c.facesEdges.size());
+	std::vector<i32> faceVerticesScratch;
+	for (i32 faceI = 0; faceI < c.faceCount(); faceI++) {
+		verticesOfFaceInOrder(c, faceI, faceVerticesScratch);
+		faceVertices.insert(faceVertices.end(), faceVerticesScratch.begin(), faceVerticesScratch.end());
+		faceVerticesOffsets.push_back(i32(faceVertices.size()));
+	}
+
+	auto outwardPointingFaceNormal = [&](View<const i32> cellFaces, i32 faceI) {
+		const auto face = verticesOfFace(faceI);
 
 		auto normal = crossProduct(
-			vertices[face.vertices[0]],
-			vertices[face.vertices[1]],
-			vertices[face.vertices[2]]
+			vertices[face[0]],
+			vertices[face[1]],
+			vertices[face[2]]
 		).normalized();
 		// The normal should point outward of the cell, that is every vertex of the cell not belonging to the face shuld have a negative dot product with the normal, the code below negates the normal if that is not the case. This is analogous to the case of a sphere. If we have 2 vertices on the sphere we can take their cross product to get the normal of the plane that intersects those 2 vertices. 
 		for (const auto& someOtherFaceI : cellFaces) {
 			if (someOtherFaceI == faceI) {
 				continue;
 			}
-			const auto& someOtherFace = faces[someOtherFaceI];
-			for (const auto& someOtherFaceVertexI : someOtherFace.vertices) {
+			for (const auto& someOtherFaceVertexI : verticesOfFace(someOtherFaceI)) {
 				bool foundVertexNotBelongingToFace = true;
-				for (const auto& faceVertexI : face.vertices) {
+				for (const auto& faceVertexI : face) {
 					if (someOtherFaceVertexI == faceVertexI) {
 						foundVertexNotBelongingToFace = false;
 						break;
@@ -55,158 +64,156 @@ Tiling::Tiling(const Polytope& c) {
 		return normal;
 	};
 
-	for (i32 i = 0; i < c.vertices.size(); i++) {
-		const auto& vertex = c.vertices[i];
-		vertices.push_back(Vec4(vertex[0], vertex[1], vertex[2], vertex[3]).normalized());
-	}
-	for (const auto& edge : c.cellsOfDimension(1)) {
-		edges.push_back(Edge{ edge[0], edge[1] });
+	cellFacesOffsets = c.cellsFacesOffsets;
+	cellFaces = c.cellsFaces;
+	cellFaceNormals.reserve(cellFaces.size());
+	for (CellIndex cellI = 0; cellI < c.cellCount(); cellI++) {
+		const auto cellFacesView = facesOfCell(cellI);
+		for (const auto& faceI : cellFacesView) {
+			cellFaceNormals.push_back(outwardPointingFaceNormal(cellFacesView, faceI));
+		}
 	}
-	for (const auto& face : c.cellsOfDimension(2)) {
-		auto sortedEdges = faceEdgesSorted(c, i32(&face - c.cellsOfDimension(2).data()));
-
-		Face f{ 
-			.vertices = verticesOfFaceWithSortedEdges(c, sortedEdges)
-		};
-
-		Vec4 orthonormalBasisFor3SpaceContainingPolygon[]{
-			vertices[f.vertices[0]], 
-			vertices[f.vertices[1]], 
-			vertices[f.vertices[2]]
-		};
-		gramSchmidtOrthonormalize(::view(orthonormalBasisFor3SpaceContainingPolygon));
-
-		auto planeThoughPoints = [&](Vec4 p0, Vec4 p1) {
-			/*
-			If you have a 2-sphere then you can represent lines on it by spheres that intersect the sphere in them. This is the same idea, but we first intersect the 3-sphere with a 3-space to get a sphere and then do the same thing. Then you can check if a point lies on an face using dot products with edges.
-			*/
-			/*
-			Could maybe do this by just using the cross product of e0, e1, and the 3d plane normal, but then I would need to figure out the correct orientation some other way. Thinking about it now I don't really know why it works. That is why the edge normals point in the right direction. It might be accidiental, because the orthonormal basis might not be correctly oriented always.
-			*/
-			const auto e0 = coordinatesInOrthonormal3Basis(orthonormalBasisFor3SpaceContainingPolygon, p0);
-			const auto e1 = coordinatesInOrthonormal3Basis(orthonormalBasisFor3SpaceContainingPolygon, p1);
-			const auto plane2Normal = cross(e0, e1);
-			const auto normalIn4Space = linearCombination(orthonormalBasisFor3SpaceContainingPolygon, plane2Normal);
-			return normalIn4Space;
-			};
-
-		/*i32 previousI = i32(f.vertices.size()) - 1;
-		for (i32 i = 0; i < f.vertices.size(); i++) {
-			f.edgeNormals.push_back(planeThoughPoints(
-				vertices[f.vertices[previousI]],
-				vertices[f.vertices[i]])
-			);
-			previousI = i;
-		}*/
-
-		/*const auto fanBaseVertexI = f.vertices[0];
-		const auto& fanBaseVertex = vertices[fanBaseVertexI];
-		for (i32 i = 1; i < i32(f.vertices.size()) - 1; i++) {
-			const auto i0 = f.vertices[i];
-			const auto i1 = f.vertices[i + 1];
-			Vec4 v0 = vertices[i0];
-			Vec4 v1 = vertices[i1];
-			Triangle triangle{
-				.vertices = { fanBaseVertexI, i0, i1 },
-				.edgeNormals = {
-					planeThoughPoints(fanBaseVertex, v0),
-					planeThoughPoints(v0, v1),
-					planeThoughPoints(v1, fanBaseVertex),
-				}
-			};
-			f.triangulation.push_back(std::move(triangle));
-		}*/
 
-		faces.push_back(f);
+	faceCells.resize(faceCount());
+	for (CellIndex cellI = 0; cellI < cellCount(); cellI++) {
+		for (const auto& faceI : facesOfCell(cellI)) {
+			auto& cellsOfFace = faceCells[faceI];
+			if (cellsOfFace.size() >= 2) {
+				ASSERT_NOT_REACHED();
+				break;
+			}
+			cellsOfFace.add(cellI);
+		}
 	}
-	for (const auto& cell : c.cellsOfDimension(3)) {
-		const auto currentCellI = i32(cells.size());
 
-		std::vector<Vec4> faceNormals;
-		for (i32 faceI : cell) {
-			const auto normal = outwardPointingFaceNormal(vertices, faces, cell, faceI);
-			faceNormals.push_back(normal);
+	cellVerticesOffsets.reserve(cellCount() + 1);
+	cellCentroids.reserve(cellCount());
+	for (CellIndex cellI = 0; cellI < cellCount(); cellI++) {
+		const auto start = cellVertices.size();
+		for (const auto& faceI : facesOfCell(cellI)) {
+			for (const auto& vertex : verticesOfFace(faceI)) {
+				cellVertices.push_back(vertex);
+			}
 		}
+		std::sort(cellVertices.begin() + start, cellVertices.end());
+		cellVertices.erase(std::unique(cellVertices.begin() + start, cellVertices.end()), cellVertices.end());
+		cellVerticesOffsets.push_back(i32(cellVertices.size()));
 
-		cells.push_back(Cell{
-			.faces = cell,
-			.faceNormals = std::move(faceNormals),
-			.centroid = Vec4(0.0f)
-		});
-	}
-	{
-		std::vector<StaticList<i32, 2>> faceToCells;
-		faceToCells.resize(faces.size());
-
-		for (i32 cellI = 0; cellI < cells.size(); cellI++) {
-			auto& cell = cells[cellI];
-			for (const auto& faceI : cell.faces) {
-				auto& faceCells = faceToCells[faceI];
-				if (faceCells.size() >= 2) {
-					ASSERT_NOT_REACHED();
-					break;
-				}
-				faceCells.add(cellI);
-			}
+		Vec4 centroid(0.0f);
+		const auto cellVerticesView = verticesOfCell(cellI);
+		for (const auto& vertex : cellVerticesView) {
+			centroid += vertices[vertex];
 		}
+		centroid /= f32(cellVerticesView.size());
+		cellCentroids.push_back(centroid.normalized());
+	}
 
-		//for (i32 faceI = 0; faceI < faces.size(); faceI++) {
-		//	auto& cells = faceToCells[faceI];
-		//	ASSERT(cells.size() <= 2);
-		//	for (i32 i = 0; i < 2; i++) {
-		//		faces[faceI].cells.add(cells[i]);
-		//		//r.faces[faceI].cells[i] = cells[i];
-		//	}
-		//}
+	// Counting sort of the (vertex, cell) pairs by vertex.
+	vertexCellsOffsets.clear();
+	vertexCellsOffsets.resize(vertices.size() + 1, 0);
+	for (const auto& vertex : cellVertices) {
+		vertexCellsOffsets[vertex + 1]++;
 	}
+	for (i32 i = 0; i < i32(vertices.size()); i++) {
+		vertexCellsOffsets[i + 1] += vertexCellsOffsets[i];
+	}
+	vertexCells.resize(vertexCellsOffsets.back());
+	std::vector<i32> insertPosition(vertexCellsOffsets.begin(), vertexCellsOffsets.end() - 1);
+	// Iterating the cells in order so the cells of each vertex are sorted.
+	for (CellIndex cellI = 0; cellI < cellCount(); cellI++) {
+		for (const auto& vertex : verticesOfCell(cellI)) {
+			vertexCells[insertPosition[vertex]++] = cellI;
+		}
+	}
+}
 
-	for (i32 cellI = 0; cellI < cells.size(); cellI++) {
-		auto& cell = cells[cellI];
-		/*for (const auto& faceI : cell.faces) {
-			auto& face = r.faces[faceI];
-			if (face.cells[0] == cellI) {
-				cell.neighbouringCells.push_back(face.cells[1]);
-			} else {
-				cell.neighbouringCells.push_back(face.cells[0]);
-			}
-		}*/
+i32 Tiling::faceCount() const {
+	return i32(faceVerticesOffsets.size()) - 1;
+}
 
-		std::set<i32> cellVertices;
-		for (const auto& faceI : cell.faces) {
-			for (const auto& vertex : faces[faceI].vertices) {
-				cellVertices.insert(vertex);
+i32 Tiling::cellCount() const {
+	return i32(cellFacesOffsets.size()) - 1;
+}
+
+View<const i32> Tiling::verticesOfFace(i32 face) const {
+	return View<const i32>(faceVertices.data() + faceVerticesOffsets[face], faceVerticesOffsets[face + 1] - faceVerticesOffsets[face]);
+}
+
+View<const i32> Tiling::facesOfCell(CellIndex cell) const {
+	return View<const i32>(cellFaces.data() + cellFacesOffsets[cell], cellFacesOffsets[cell + 1] - cellFacesOffsets[cell]);
+}
+
+View<const Vec4> Tiling::faceNormalsOfCell(CellIndex cell) const {
+	return View<const Vec4>(cellFaceNormals.data() + cellFacesOffsets[cell], cellFacesOffsets[cell + 1] - cellFacesOffsets[cell]);
+}
+
+View<const i32> Tiling::verticesOfCell(CellIndex cell) const {
+	return View<const i32>(cellVertices.data() + cellVerticesOffsets[cell], cellVerticesOffsets[cell + 1] - cellVerticesOffsets[cell]);
+}
+
+View<const CellIndex> CellAdjacency::operator[](CellIndex cell) const {
+	return View<const CellIndex>(neighbours.data() + offsets[cell], offsets[cell + 1] - offsets[cell]);
+}
+
+i32 CellAdjacency::cellCount() const {
+	return i32(offsets.size()) - 1;
+}
+
+/*
+The cells sharing a vertex with a cell are found by going over the cells of each of its vertices in the inverted index, so the cost is proportional to the size of the output instead of the square of the cell count. The same cell is found through multiple vertices so the last cell that found each cell is stored to remove the duplicates without clearing anything.
+*/
+CellAdjacency Tiling::cellsSharingVertex() const {
+	CellAdjacency r;
+	r.offsets.reserve(cellCount() + 1);
+	r.offsets.push_back(0);
+	std::vector<CellIndex> lastFoundBy(cellCount(), -1);
+	for (CellIndex cellI = 0; cellI < cellCount(); cellI++) {
+		lastFoundBy[cellI] = cellI;
+		const auto start = r.neighbours.size();
+		for (const auto& vertex : verticesOfCell(cellI)) {
+			for (i32 i = vertexCellsOffsets[vertex]; i < vertexCellsOffsets[vertex + 1]; i++) {
+				const auto other = vertexCells[i];
+				if (lastFoundBy[other] == cellI) {
+					continue;
+				}
+				lastFoundBy[other] = cellI;
+				r.neighbours.push_back(other);
 			}
 		}
-		//cell.vertices = std::vector(cellVertices.begin(), cellVertices.end());
-		cell.vertices = std::move(cellVertices);
-		//r.cellsVertices.push_back(std::move(vertices));
+		std::sort(r.neighbours.begin() + start, r.neighbours.end());
+		r.offsets.push_back(i32(r.neighbours.size()));
+	}
+	return r;
+}
 
-		Vec4 centroid(0.0f);
-		for (const auto& vertex : cell.vertices) {
-			centroid += vertices[vertex];
+CellAdjacency Tiling::cellsSharingFace() const {
+	CellAdjacency r;
+	r.offsets.reserve(cellCount() + 1);
+	r.offsets.push_back(0);
+	for (CellIndex cellI = 0; cellI < cellCount(); cellI++) {
+		const auto start = r.neighbours.size();
+		for (const auto& faceI : facesOfCell(cellI)) {
+			const auto& cellsOfFace = faceCells[faceI];
+			for (i32 i = 0; i < cellsOfFace.size(); i++) {
+				const auto other = cellsOfFace[i];
+				if (other != cellI) {
+					r.neighbours.push_back(other);
+				}
+			}
 		}
-		centroid /= cell.vertices.size();
-		cell.centroid = centroid.normalized();
+		std::sort(r.neighbours.begin() + start, r.neighbours.end());
+		r.offsets.push_back(i32(r.neighbours.size()));
 	}
-
-	
+	return r;
 }
 
-#include <Timer.hpp>
-std::vector<std::vector<i32>> Tiling::cellsNeighbouringToCell() {
-	Timer t;
+std::vector<std::vector<i32>> Tiling::cellsNeighbouringToCell() const {
+	const auto adjacency = cellsSharingVertex();
 	std::vector<std::vector<i32>> r;
-	r.resize(cells.size());
-	for (i32 cellI = 0; cellI < cells.size(); cellI++) {
-		for (i32 cellJ = cellI + 1; cellJ < cells.size(); cellJ++) {
-			auto& vI = cells[cellI].vertices;
-			auto& vJ = cells[cellJ].vertices;
-			if (haveCommonElement(vI.begin(), vI.end(), vJ.begin(), vJ.end())) {
-				r[cellI].push_back(cellJ);
-				r[cellJ].push_back(cellI);
-			}
-		}
+	r.resize(cellCount());
+	for (CellIndex cellI = 0; cellI < cellCount(); cellI++) {
+		const auto neighbours = adjacency[cellI];
+		r[cellI].assign(neighbours.begin(), neighbours.end());
 	}
-	t.tookSeconds("test");
 	return r;
 }
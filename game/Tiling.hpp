@@ -1,39 +1,68 @@
 #pragma once
 
 #include <game/Polytopes.hpp>
-#include <set>
 #include <StaticList.hpp>
+#include <View.hpp>
 
 using CellIndex = i32;
 
+// Compressed sparse row adjacency lists. The neighbours of cell i are neighbours[offsets[i]] to neighbours[offsets[i + 1] - 1] sorted in increasing order.
+struct CellAdjacency {
+	std::vector<i32> offsets;
+	std::vector<CellIndex> neighbours;
+
+	View<const CellIndex> operator[](CellIndex cell) const;
+	i32 cellCount() const;
+};
+
+/*
+The cells of a polytope projected onto the 3-sphere.
+
+All the data is stored in flat arrays. The variable length lists are stored in compressed sparse row format, that is the lists of all the faces or cells one after another and an array of offsets. The list of element i is in the range [offsets[i], offsets[i + 1]). This makes constructing a tiling only do a few allocations instead of a few for every face and cell.
+*/
 struct Tiling {
+	Tiling();
+	Tiling(const FlatPolytope4& polytope);
+	// Converts the polytope to FlatPolytope4 first.
 	Tiling(const Polytope& polytope);
 
-	struct Triangle {
-		i32 vertices[3];
-		Vec4 edgeNormals[3];
-	};
 	struct Edge {
 		i32 vertices[2];
 	};
-	struct Face {
-		std::vector<i32> vertices;
-		//std::vector<Vec4> edgeNormals;
-		//StaticList<i32, 2> cells;
-		//std::vector<Triangle> triangulation;
-	};
-	struct Cell {
-		std::vector<i32> faces;
-		std::vector<Vec4> faceNormals;
-		Vec4 centroid;
-		std::set<i32> vertices;
-		//std::vector<i32> vertices;
-	};
 
 	std::vector<Vec4> vertices;
 	std::vector<Edge> edges;
-	std::vector<Face> faces;
-	std::vector<Cell> cells;
 
-	std::vector<std::vector<i32>> cellsNeighbouringToCell();
+	// The vertices of each face in cyclic order.
+	std::vector<i32> faceVerticesOffsets{ 0 };
+	std::vector<i32> faceVertices;
+	// The faces of each cell and the outward pointing normals of the hyperplanes containing them. Both use cellFacesOffsets.
+	std::vector<i32> cellFacesOffsets{ 0 };
+	std::vector<i32> cellFaces;
+	std::vector<Vec4> cellFaceNormals;
+	// The vertices of each cell sorted in increasing order.
+	std::vector<i32> cellVerticesOffsets{ 0 };
+	std::vector<i32> cellVertices;
+	// The normalized averages of the vertices of the cells.
+	std::vector<Vec4> cellCentroids;
+
+	i32 faceCount() const;
+	i32 cellCount() const;
+	View<const i32> verticesOfFace(i32 face) const;
+	View<const i32> facesOfCell(CellIndex cell) const;
+	View<const Vec4> faceNormalsOfCell(CellIndex cell) const;
+	View<const i32> verticesOfCell(CellIndex cell) const;
+
+	// Inverted index from the vertices to the cells containing them in the same format as CellAdjacency. The cells of vertex i are vertexCells[vertexCellsOffsets[i]] to vertexCells[vertexCellsOffsets[i + 1] - 1].
+	std::vector<i32> vertexCellsOffsets{ 0 };
+	std::vector<CellIndex> vertexCells;
+	// Every face of a closed tiling is shared by 2 cells.
+	std::vector<StaticList<CellIndex, 2>> faceCells;
+
+	// Cells sharing at least one vertex.
+	CellAdjacency cellsSharingVertex() const;
+	// Cells sharing a face.
+	CellAdjacency cellsSharingFace() const;
+	// The same as cellsSharingVertex.
+	std::vector<std::vector<i32>> cellsNeighbouringToCell() const;
 };
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "TilingCache.hpp"
+#include <filesystem>
+#include <system_error>
+
+TilingCache::TilingCache(std::string directory)
+	: directory(std::move(directory)) {}
+
+std::optional<LoadedTiling> TilingCache::load(u64 key) {
+	auto loaded = loadTilingFile(path(key).c_str());
+	if (!loaded.has_value() || loaded->key != key) {
+		return std::nullopt;
+	}
+	return loaded;
+}
+
+bool TilingCache::store(u64 key, const Tiling& tiling) {
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (error) {
+		return false;
+	}
+	// Writing into a temporary file and renaming it so a file that is only partially written is never loaded.
+	const auto finalPath = path(key);
+	const auto temporaryPath = finalPath + ".tmp";
+	if (!saveTilingFile(temporaryPath.c_str(), tiling, key)) {
+		std::filesystem::remove(temporaryPath, error);
+		return false;
+	}
+	std::filesystem::rename(temporaryPath, finalPath, error);
+	return !error;
+}
+
+std::string TilingCache::path(u64 key) const {
+	static const char digits[] = "0123456789abcdef";
+	std::string name(16, '0');
+	for (i32 i = 15; i >= 0; i--) {
+		name[i] = digits[key & 0xF];
+		key >>= 4;
+	}
+	return directory + name + ".tiling";
+}
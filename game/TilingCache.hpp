@@ -0,0 +1,55 @@
+#pragma once
+
+#include <game/TilingFile.hpp>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+On disk cache of processed tilings. Generating some of the polytopes requires computing the convex hull and processing the result, which is slow, and the result only depends on the generator and its parameters. 
+
+Each tiling is stored in a tiling file named after the hash of the generator name and its parameters. Files created by a different version of the format are rejected when loading. The key is also stored inside of the file so a file with a colliding name or a file copied from somewhere else isn't used. Corrupted files are detected by the checksum of the tiling file. In both cases the tiling is generated again and the file is overwritten.
+*/
+struct TilingCache {
+	TilingCache(std::string directory = "./cache/tilings/");
+
+	template<typename ...Parameters>
+	static u64 key(std::string_view generatorName, const Parameters&... parameters);
+
+	// Returns the cached tiling or generates it using generate(), which should return a Polytope or a FlatPolytope4, and stores it.
+	template<typename Generate>
+	LoadedTiling get(u64 key, Generate generate);
+
+	std::optional<LoadedTiling> load(u64 key);
+	// Returns false if the file couldn't be written. The tiling is still usable in that case.
+	bool store(u64 key, const Tiling& tiling);
+	std::string path(u64 key) const;
+
+	std::string directory;
+	i32 hitCount = 0;
+	i32 missCount = 0;
+};
+
+template<typename ...Parameters>
+u64 TilingCache::key(std::string_view generatorName, const Parameters&... parameters) {
+	static_assert((std::is_trivially_copyable_v<Parameters> && ...));
+	auto hash = fnv1a(View<const u8>(reinterpret_cast<const u8*>(generatorName.data()), generatorName.size()));
+	auto addParameter = [&](const auto& parameter) {
+		hash = fnv1a(View<const u8>(reinterpret_cast<const u8*>(&parameter), sizeof(parameter)), hash);
+	};
+	(addParameter(parameters), ...);
+	return hash;
+}
+
+template<typename Generate>
+LoadedTiling TilingCache::get(u64 key, Generate generate) {
+	if (auto cached = load(key)) {
+		hitCount++;
+		return std::move(*cached);
+	}
+	missCount++;
+	LoadedTiling result{ .tiling = Tiling(generate()), .key = key };
+	result.cellsSharingVertex = result.tiling.cellsSharingVertex();
+	store(key, result.tiling);
+	return result;
+}
@@ -0,0 +1,208 @@
+#include "TilingFile.hpp"
+#include <game/MappedFile.hpp>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+enum class Section : u32 {
+	VERTICES,
+	EDGES,
+	FACE_VERTICES_OFFSETS,
+	FACE_VERTICES,
+	CELL_FACES_OFFSETS,
+	CELL_FACES,
+	CELL_FACE_NORMALS,
+	CELL_VERTICES_OFFSETS,
+	CELL_VERTICES,
+	CELL_CENTROIDS,
+	VERTEX_CELLS_OFFSETS,
+	VERTEX_CELLS,
+	// 2 cells for each face. -1 if the face has only one cell.
+	FACE_CELLS,
+	CELLS_SHARING_VERTEX_OFFSETS,
+	CELLS_SHARING_VERTEX,
+	COUNT
+};
+
+struct SectionLocation {
+	// In bytes from the start of the file.
+	u64 offset;
+	u64 size;
+};
+
+struct Header {
+	char magic[4];
+	u32 version;
+	// FNV-1a of everything after the header.
+	u64 checksum;
+	u64 key;
+	u64 padding;
+	SectionLocation sections[i32(Section::COUNT)];
+};
+
+const char MAGIC[4]{ 'T', 'L', 'N', 'G' };
+// Has to be incremented when the format or the way the tiling is computed changes.
+const u32 VERSION = 2;
+const usize SECTION_ALIGNMENT = 16;
+
+static_assert(sizeof(Vec4) == 4 * sizeof(f32));
+static_assert(sizeof(Tiling::Edge) == 2 * sizeof(i32));
+static_assert(sizeof(Header) % SECTION_ALIGNMENT == 0);
+
+}
+
+u64 fnv1a(View<const u8> data, u64 hash) {
+	for (const auto& byte : data) {
+		hash ^= byte;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+std::vector<u8> serializeTiling(const Tiling& tiling, u64 key) {
+	std::vector<i32> faceCells;
+	faceCells.reserve(tiling.faceCells.size() * 2);
+	for (const auto& cells : tiling.faceCells) {
+		for (i32 i = 0; i < 2; i++) {
+			faceCells.push_back(i < cells.size() ? cells[i] : -1);
+		}
+	}
+	const auto adjacency = tiling.cellsSharingVertex();
+
+	Header header{};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version = VERSION;
+	header.key = key;
+
+	std::vector<u8> result(sizeof(Header));
+	auto addSection = [&](Section section, const auto& array) {
+		while (result.size() % SECTION_ALIGNMENT != 0) {
+			result.push_back(0);
+		}
+		const auto size = array.size() * sizeof(array[0]);
+		header.sections[i32(section)] = SectionLocation{ .offset = result.size(), .size = size };
+		const auto bytes = reinterpret_cast<const u8*>(array.data());
+		result.insert(result.end(), bytes, bytes + size);
+	};
+	using enum Section;
+	addSection(VERTICES, tiling.vertices);
+	addSection(EDGES, tiling.edges);
+	addSection(FACE_VERTICES_OFFSETS, tiling.faceVerticesOffsets);
+	addSection(FACE_VERTICES, tiling.faceVertices);
+	addSection(CELL_FACES_OFFSETS, tiling.cellFacesOffsets);
+	addSection(CELL_FACES, tiling.cellFaces);
+	addSection(CELL_FACE_NORMALS, tiling.cellFaceNormals);
+	addSection(CELL_VERTICES_OFFSETS, tiling.cellVerticesOffsets);
+	addSection(CELL_VERTICES, tiling.cellVertices);
+	addSection(CELL_CENTROIDS, tiling.cellCentroids);
+	addSection(VERTEX_CELLS_OFFSETS, tiling.vertexCellsOffsets);
+	addSection(VERTEX_CELLS, tiling.vertexCells);
+	addSection(FACE_CELLS, faceCells);
+	addSection(CELLS_SHARING_VERTEX_OFFSETS, adjacency.offsets);
+	addSection(CELLS_SHARING_VERTEX, adjacency.neighbours);
+
+	header.checksum = fnv1a(View<const u8>(result.data() + sizeof(Header), result.size() - sizeof(Header)));
+	std::memcpy(result.data(), &header, sizeof(Header));
+	return result;
+}
+
+std::optional<LoadedTiling> deserializeTiling(View<const u8> data) {
+	const auto size = usize(data.size());
+	if (size < sizeof(Header)) {
+		return std::nullopt;
+	}
+	const auto bytes = &data[0];
+	Header header;
+	std::memcpy(&header, bytes, sizeof(Header));
+	if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+		return std::nullopt;
+	}
+	if (header.checksum != fnv1a(View<const u8>(bytes + sizeof(Header), size - sizeof(Header)))) {
+		return std::nullopt;
+	}
+
+	bool isValid = true;
+	// Only the sizes are checked. The contents are covered by the checksum.
+	auto readSection = [&]<typename T>(Section section, std::vector<T>& result) {
+		const auto& location = header.sections[i32(section)];
+		if (location.offset > size || location.size > size - location.offset || location.size % sizeof(T) != 0) {
+			isValid = false;
+			return;
+		}
+		result.resize(location.size / sizeof(T));
+		if (location.size != 0) {
+			std::memcpy(result.data(), bytes + location.offset, location.size);
+		}
+	};
+
+	LoadedTiling r;
+	r.key = header.key;
+	auto& t = r.tiling;
+	std::vector<i32> faceCells;
+	using enum Section;
+	readSection(VERTICES, t.vertices);
+	readSection(EDGES, t.edges);
+	readSection(FACE_VERTICES_OFFSETS, t.faceVerticesOffsets);
+	readSection(FACE_VERTICES, t.faceVertices);
+	readSection(CELL_FACES_OFFSETS, t.cellFacesOffsets);
+	readSection(CELL_FACES, t.cellFaces);
+	readSection(CELL_FACE_NORMALS, t.cellFaceNormals);
+	readSection(CELL_VERTICES_OFFSETS, t.cellVerticesOffsets);
+	readSection(CELL_VERTICES, t.cellVertices);
+	readSection(CELL_CENTROIDS, t.cellCentroids);
+	readSection(VERTEX_CELLS_OFFSETS, t.vertexCellsOffsets);
+	readSection(VERTEX_CELLS, t.vertexCells);
+	readSection(FACE_CELLS, faceCells);
+	readSection(CELLS_SHARING_VERTEX_OFFSETS, r.cellsSharingVertex.offsets);
+	readSection(CELLS_SHARING_VERTEX, r.cellsSharingVertex.neighbours);
+	if (!isValid) {
+		return std::nullopt;
+	}
+
+	auto isValidOffsets = [](const std::vector<i32>& offsets, usize elementCount, usize arraySize) {
+		return offsets.size() == elementCount + 1 && offsets.front() == 0 && usize(offsets.back()) == arraySize;
+	};
+	if (t.faceVerticesOffsets.empty() || t.cellFacesOffsets.empty()) {
+		return std::nullopt;
+	}
+	const auto faceCount = usize(t.faceCount());
+	const auto cellCount = usize(t.cellCount());
+	isValid =
+		isValidOffsets(t.faceVerticesOffsets, faceCount, t.faceVertices.size()) &&
+		isValidOffsets(t.cellFacesOffsets, cellCount, t.cellFaces.size()) &&
+		t.cellFaceNormals.size() == t.cellFaces.size() &&
+		isValidOffsets(t.cellVerticesOffsets, cellCount, t.cellVertices.size()) &&
+		t.cellCentroids.size() == cellCount &&
+		isValidOffsets(t.vertexCellsOffsets, t.vertices.size(), t.vertexCells.size()) &&
+		faceCells.size() == 2 * faceCount &&
+		isValidOffsets(r.cellsSharingVertex.offsets, cellCount, r.cellsSharingVertex.neighbours.size());
+	if (!isValid) {
+		return std::nullopt;
+	}
+
+	t.faceCells.resize(faceCount);
+	for (usize i = 0; i < faceCount; i++) {
+		for (i32 j = 0; j < 2; j++) {
+			if (const auto cell = faceCells[2 * i + j]; cell != -1) {
+				t.faceCells[i].add(cell);
+			}
+		}
+	}
+	return r;
+}
+
+bool saveTilingFile(const char* path, const Tiling& tiling, u64 key) {
+	const auto data = serializeTiling(tiling, key);
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	return file.good();
+}
+
+std::optional<LoadedTiling> loadTilingFile(const char* path) {
+	const auto file = MappedFile::open(path);
+	if (!file.has_value()) {
+		return std::nullopt;
+	}
+	return deserializeTiling(file->data());
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <game/Tiling.hpp>
+#include <optional>
+
+/*
+Binary file containing a fully processed Tiling and the cells sharing a vertex with each cell, so loading a board doesn't need to generate the polytope or process it.
+
+The file starts with a header containing the locations of the sections followed by the sections. Each section is one of the arrays of the Tiling stored as is, so loading the file is mapping it, checking the header and copying each section into its array with a single memcpy. The sections are aligned to 16 bytes so they could also be used in place. The numbers are stored in the native byte order, which is little endian on all the supported platforms.
+*/
+struct LoadedTiling {
+	Tiling tiling;
+	CellAdjacency cellsSharingVertex;
+	// Identifies what the tiling was generated from. Used by TilingCache. Zero for the board files.
+	u64 key = 0;
+};
+
+std::vector<u8> serializeTiling(const Tiling& tiling, u64 key = 0);
+// Returns std::nullopt if the data isn't a valid tiling file or if it was created by a different version.
+std::optional<LoadedTiling> deserializeTiling(View<const u8> data);
+
+bool saveTilingFile(const char* path, const Tiling& tiling, u64 key = 0);
+std::optional<LoadedTiling> loadTilingFile(const char* path);
+
+u64 fnv1a(View<const u8> data, u64 hash = 14695981039346656037ull);
+
+// Relative to the working directory.
+#define TILING_FILES_DIRECTORY "./game/Boards/"
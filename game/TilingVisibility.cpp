@@ -0,0 +1,159 @@
+#include "TilingVisibility.hpp"
+#include <game/4d.hpp>
+#include <engine/Math/Angles.hpp>
+#include <algorithm>
+#include <numeric>
+#include <array>
+
+f32 capAngularRadiusWithVolumeFraction(f32 fraction) {
+	if (fraction >= 1.0f) {
+		return PI<f32>;
+	}
+	// The fraction (2r - sin(2r)) / (2 pi) is increasing in r so bisection works.
+	f32 min = 0.0f;
+	f32 max = PI<f32>;
+	for (i32 i = 0; i < 32; i++) {
+		const auto r = (min + max) / 2.0f;
+		if ((2.0f * r - sin(2.0f * r)) / TAU<f32> < fraction) {
+			min = r;
+		} else {
+			max = r;
+		}
+	}
+	return max;
+}
+
+std::vector<SphereCap> cellBoundingCaps(const Tiling& tiling) {
+	std::vector<SphereCap> caps;
+	caps.reserve(tiling.cellCount());
+	for (CellIndex cellI = 0; cellI < tiling.cellCount(); cellI++) {
+		const auto& center = tiling.cellCentroids[cellI];
+		f32 radius = 0.0f;
+		for (const auto& vertex : tiling.verticesOfCell(cellI)) {
+			radius = std::max(radius, sphereAngularDistance(center, tiling.vertices[vertex]));
+		}
+		caps.push_back(SphereCap{ .center = center, .angularRadius = radius });
+	}
+	return caps;
+}
+
+std::vector<SphereCap> edgeBoundingCaps(const Tiling& tiling) {
+	std::vector<SphereCap> caps;
+	caps.reserve(tiling.edges.size());
+	for (const auto& edge : tiling.edges) {
+		const auto& v0 = tiling.vertices[edge.vertices[0]];
+		const auto& v1 = tiling.vertices[edge.vertices[1]];
+		caps.push_back(SphereCap{
+			.center = (v0 + v1).normalized(),
+			.angularRadius = sphereAngularDistance(v0, v1) / 2.0f
+		});
+	}
+	return caps;
+}
+
+f32 minVisibleCosine(f32 drawDistance, f32 angularRadius) {
+	const auto maxDistance = drawDistance + angularRadius;
+	if (maxDistance >= PI<f32>) {
+		return -2.0f;
+	}
+	return cos(maxDistance);
+}
+
+void TilingVisibility::build(const Tiling& tiling, i32 maxVisibleCellCount) {
+	drawDistance = capAngularRadiusWithVolumeFraction(f32(maxVisibleCellCount) / f32(std::max(tiling.cellCount(), 1)));
+
+	if (everythingVisible()) {
+		cells = Clusters();
+		edges = Clusters();
+		visibleCells.resize(tiling.cellCount());
+		std::iota(visibleCells.begin(), visibleCells.end(), 0);
+		visibleEdges.resize(tiling.edges.size());
+		std::iota(visibleEdges.begin(), visibleEdges.end(), 0);
+		return;
+	}
+
+	const auto clusterSize = drawDistance / 2.0f;
+	cells.build(cellBoundingCaps(tiling), clusterSize, drawDistance);
+	edges.build(edgeBoundingCaps(tiling), clusterSize, drawDistance);
+	visibleCells.clear();
+	visibleEdges.clear();
+}
+
+void TilingVisibility::query(Vec4 cameraPosition) {
+	if (everythingVisible()) {
+		return;
+	}
+	visibleCells.clear();
+	cells.query(cameraPosition, visibleCells);
+	visibleEdges.clear();
+	edges.query(cameraPosition, visibleEdges);
+}
+
+bool TilingVisibility::everythingVisible() const {
+	return drawDistance >= PI<f32>;
+}
+
+void TilingVisibility::Clusters::build(const std::vector<SphereCap>& elementCaps, f32 clusterSize, f32 drawDistance) {
+	const auto elementCount = i32(elementCaps.size());
+	using GridCell = std::array<i32, 4>;
+	std::vector<GridCell> elementGridCells;
+	elementGridCells.reserve(elementCount);
+	for (const auto& cap : elementCaps) {
+		const auto& c = cap.center;
+		elementGridCells.push_back(GridCell{
+			i32(floor(c.x / clusterSize)),
+			i32(floor(c.y / clusterSize)),
+			i32(floor(c.z / clusterSize)),
+			i32(floor(c.w / clusterSize)),
+		});
+	}
+
+	clusterElements.resize(elementCount);
+	std::iota(clusterElements.begin(), clusterElements.end(), 0);
+	std::ranges::sort(clusterElements, [&](i32 a, i32 b) {
+		return elementGridCells[a] < elementGridCells[b];
+	});
+
+	clusterCenters.clear();
+	clusterMinCosines.clear();
+	clusterElementsOffsets.clear();
+	clusterElementsOffsets.push_back(0);
+	elementCenters.clear();
+	elementMinCosines.clear();
+	for (i32 start = 0; start < elementCount;) {
+		auto end = start + 1;
+		while (end < elementCount && elementGridCells[clusterElements[end]] == elementGridCells[clusterElements[start]]) {
+			end++;
+		}
+
+		Vec4 center(0.0f);
+		for (i32 i = start; i < end; i++) {
+			center += elementCaps[clusterElements[i]].center;
+		}
+		center = center.normalized();
+		f32 radius = 0.0f;
+		for (i32 i = start; i < end; i++) {
+			const auto& cap = elementCaps[clusterElements[i]];
+			radius = std::max(radius, sphereAngularDistance(center, cap.center) + cap.angularRadius);
+			elementCenters.push_back(cap.center);
+			elementMinCosines.push_back(minVisibleCosine(drawDistance, cap.angularRadius));
+		}
+		clusterCenters.push_back(center);
+		clusterMinCosines.push_back(minVisibleCosine(drawDistance, radius));
+		clusterElementsOffsets.push_back(end);
+		start = end;
+	}
+}
+
+void TilingVisibility::Clusters::query(Vec4 cameraPosition, std::vector<i32>& result) const {
+	for (i32 clusterI = 0; clusterI < i32(clusterCenters.size()); clusterI++) {
+		if (dot(cameraPosition, clusterCenters[clusterI]) < clusterMinCosines[clusterI]) {
+			continue;
+		}
+		for (i32 i = clusterElementsOffsets[clusterI]; i < clusterElementsOffsets[clusterI + 1]; i++) {
+			if (dot(cameraPosition, elementCenters[i]) >= elementMinCosines[i]) {
+				result.push_back(clusterElements[i]);
+			}
+		}
+	}
+}
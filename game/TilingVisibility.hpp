@@ -0,0 +1,56 @@
+#pragma once
+
+#include <game/Tiling.hpp>
+#include <game/Physics/SpatialHash4.hpp>
+
+// Used by Minesweeper. The largest precomputed board has 720 cells so they are always fully visible.
+constexpr i32 MAX_VISIBLE_CELL_COUNT = 2000;
+
+/*
+Finds the cells and the edges of a tiling that are near the camera.
+
+In the stereographic projection the whole sphere is visible from every point, but on boards with tens of thousands of cells the far away cells are only a few pixels large. Transforming, picking and drawing all of them every frame makes the frame time proportional to the size of the board. Instead only the cells and the edges within the draw distance, which is an angular distance from the camera, are used.
+
+The draw distance is chosen so that the cap around the camera contains around maxVisibleCellCount cells assuming that the cells have similar volumes. The volume of a cap with angular radius r is pi (2r - sin(2r)) and the volume of the whole sphere is 2 pi^2. If the board has fewer cells than that the draw distance is pi and everything is returned without testing anything, so the small boards look the same as before.
+
+The elements are grouped into clusters by the cell of a uniform grid in R^4 containing the center of their bounding cap. The grid cells are half of the draw distance large so each cluster contains a few dozen elements. A query tests the bounding caps of the clusters and then only the elements of the overlapping clusters. The draw distance doesn't change after building so the cosines of the largest visible angles are precomputed and each test is a single dot product.
+*/
+struct TilingVisibility {
+	void build(const Tiling& tiling, i32 maxVisibleCellCount);
+	// Fills visibleCells and visibleEdges with the cells and edges whose bounding caps overlap the cap with the draw distance radius around the camera position. The order is unspecified.
+	void query(Vec4 cameraPosition);
+
+	bool everythingVisible() const;
+
+	f32 drawDistance = 0.0f;
+
+	struct Clusters {
+		void build(const std::vector<SphereCap>& elementCaps, f32 clusterSize, f32 drawDistance);
+		void query(Vec4 cameraPosition, std::vector<i32>& result) const;
+
+		std::vector<Vec4> clusterCenters;
+		// The cosine of the largest angle from the center at which the camera can still see some element of the cluster.
+		std::vector<f32> clusterMinCosines;
+		// The elements of cluster i are in the range [clusterElementsOffsets[i], clusterElementsOffsets[i + 1]).
+		std::vector<i32> clusterElementsOffsets{ 0 };
+		std::vector<i32> clusterElements;
+		// Indexed the same way as clusterElements.
+		std::vector<Vec4> elementCenters;
+		std::vector<f32> elementMinCosines;
+	};
+	Clusters cells;
+	Clusters edges;
+
+	std::vector<CellIndex> visibleCells;
+	// Indices into Tiling::edges.
+	std::vector<i32> visibleEdges;
+};
+
+// The angular radius of the cap containing the fraction of the volume of the sphere.
+f32 capAngularRadiusWithVolumeFraction(f32 fraction);
+
+// The cosine of the largest angle between the camera and the center of a cap with the angular radius at which they still overlap. The same condition as capsOverlap with a cap of radius drawDistance, but with the cosine computed once.
+f32 minVisibleCosine(f32 drawDistance, f32 angularRadius);
+
+std::vector<SphereCap> cellBoundingCaps(const Tiling& tiling);
+std::vector<SphereCap> edgeBoundingCaps(const Tiling& tiling);
@@ -0,0 +1,34 @@
+#include <game/TilingFile.hpp>
+#include <Put.hpp>
+#include <string>
+#include <cstdlib>
+
+// Processes the boards generated by the functions in PolytopeData.cpp and writes them into the files loaded by Minesweeper::loadBoard. Has to be run from the repository root.
+int main() {
+	struct Board {
+		const char* fileName;
+		FlatPolytope4 (*make)();
+	};
+	const Board boards[]{
+		{ "snub24cell.tiling", makeFlatSnub24cell },
+		{ "120cell.tiling", makeFlat120cell },
+		{ "subdiviedHypercube.tiling", makeFlatSubdiviedHypercube2 },
+		{ "600cell.tiling", makeFlat600cell },
+		{ "rectified600cell.tiling", makeFlatRectified600cell },
+	};
+	for (const auto& board : boards) {
+		const auto path = std::string(TILING_FILES_DIRECTORY) + board.fileName;
+		const Tiling tiling(board.make());
+		if (!saveTilingFile(path.c_str(), tiling)) {
+			put("failed to write %", path);
+			return EXIT_FAILURE;
+		}
+		const auto loaded = loadTilingFile(path.c_str());
+		if (!loaded.has_value() || loaded->tiling.cellCount() != tiling.cellCount()) {
+			put("failed to read back %", path);
+			return EXIT_FAILURE;
+		}
+		put("wrote % (% vertices, % faces, % cells)", path, tiling.vertices.size(), tiling.faceCount(), tiling.cellCount());
+	}
+	return EXIT_SUCCESS;
+}
@@ -5,6 +5,7 @@
 //#include <engine/Graphics/Vbo.hpp>
 #include <gfx/Instancing.hpp>
 #include <game/MeshUtils.hpp>
+#include <game/StreamingBuffer.hpp>
 
 template<typename Vertex>
 struct TriangleRenderer {
@@ -14,8 +15,9 @@ struct TriangleRenderer {
 	i32 currentIndex() const;
 	std::vector<i32> indices;
 	std::vector<Vertex> vertices;
-	Vbo vbo;
-	Ibo ibo;
+	// The vertices and indices are uploaded every frame.
+	StreamingBuffer<Vbo> vbo;
+	StreamingBuffer<Ibo> ibo;
 	Vao vao;
 
 	i32 addVertex(const Vertex& vertex);
@@ -31,9 +33,9 @@ TriangleRenderer<Vertex> TriangleRenderer<Vertex>::make(Vbo& instancesVbo) {
 	auto ibo = Ibo::generate();
 	auto vao = createInstancingVao<Shader>(vbo, ibo, instancesVbo);
 	return TriangleRenderer<Vertex>{
-		.vbo = std::move(vbo),
-			.ibo = std::move(ibo),
-			.vao = std::move(vao),
+		.vbo = StreamingBuffer<Vbo>{ .buffer = std::move(vbo) },
+		.ibo = StreamingBuffer<Ibo>{ .buffer = std::move(ibo) },
+		.vao = std::move(vao),
 	};
 }
 